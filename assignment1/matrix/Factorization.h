@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Matrix.h"
+#include "../../common/BlockedFactorization.h"
+
+/* LU factorization with partial pivoting, P * A = L * U, of a square matrix.
+   The factorization is blocked (right-looking): a panel of columns is
+   factorized, the corresponding rows of U are computed, and the trailing
+   matrix is updated with a cache blocked product, which can be split among
+   threads. It costs O(N^3) once, after which every solve costs O(N^2) per
+   right-hand side */
+class LUFactorization {
+private:
+  /* Possible errors for the factorization */
+  enum FactorizationError {
+    ERR_SUCCESS, ERR_DIM, ERR_SINGULAR
+  };
+
+  /* Matrix dimension */
+  std::size_t n;
+  /* L (unit diagonal, below) and U (on and above the diagonal) */
+  Matrix lu;
+  /* Row i of the factors corresponds to row pivots[i] of the matrix */
+  std::vector<std::size_t> pivots;
+  /* Number of row exchanges, for the sign of the determinant */
+  std::size_t exchanges = 0;
+  /* Current error state */
+  FactorizationError error = FactorizationError::ERR_SUCCESS;
+public:
+  /* LUFactorization constructor, factorizing the given matrix using the
+     given number of threads for the trailing updates */
+  explicit LUFactorization(const Matrix& a, unsigned threads = 1) : n(a.rows()), lu(a), pivots(a.rows()) {
+    if(a.rows() != a.cols() || a.rows() == 0) {
+      error = FactorizationError::ERR_DIM;
+      return;
+    }
+
+    if(!factorize_lu(&lu(0, 0), n, pivots.data(), exchanges, threads)) {
+      error = FactorizationError::ERR_SINGULAR;
+    }
+  }
+
+  /* Solves A * X = B for the columns of B, returns an invalid matrix if the
+     dimensions do not fit or the factorization failed */
+  Matrix solve(const Matrix& b) const {
+    if(error != FactorizationError::ERR_SUCCESS || b.rows() != n) {
+      return Matrix(0, 0, 0.0);
+    }
+
+    const std::size_t m = b.cols();
+    Matrix x(n, m, 0.0);
+
+    /* Permute the rows of B */
+    for(std::size_t i = 0; i < n; ++i) {
+      for(std::size_t j = 0; j < m; ++j) {
+        x(i, j) = b(pivots[i], j);
+      }
+    }
+
+    /* Forward substitution with L, a whole row of right-hand sides at once */
+    for(std::size_t i = 0; i < n; ++i) {
+      for(std::size_t p = 0; p < i; ++p) {
+        const double factor = lu(i, p);
+
+        for(std::size_t j = 0; j < m; ++j) {
+          x(i, j) -= factor * x(p, j);
+        }
+      }
+    }
+
+    /* Backward substitution with U */
+    for(std::size_t i = n; i-- > 0;) {
+      for(std::size_t p = i + 1; p < n; ++p) {
+        const double factor = lu(i, p);
+
+        for(std::size_t j = 0; j < m; ++j) {
+          x(i, j) -= factor * x(p, j);
+        }
+      }
+
+      const double diagonal = lu(i, i);
+
+      for(std::size_t j = 0; j < m; ++j) {
+        x(i, j) /= diagonal;
+      }
+    }
+
+    return x;
+  }
+
+  /* Return the determinant of the factorized matrix */
+  double determinant() const {
+    if(error != FactorizationError::ERR_SUCCESS) {
+      return 0.0;
+    }
+
+    double det = (exchanges % 2 == 0) ? 1.0 : -1.0;
+
+    for(std::size_t i = 0; i < n; ++i) {
+      det *= lu(i, i);
+    }
+
+    return det;
+  }
+
+  /* Return the combined factors, L below and U on and above the diagonal */
+  const Matrix& factors() const {
+    return lu;
+  }
+
+  /* Return the row permutation, row i of L * U is row permutation()[i] of A */
+  const std::vector<std::size_t>& permutation() const {
+    return pivots;
+  }
+
+  /* Check if the factorization is in an error state */
+  bool has_error() const {
+    return (error != FactorizationError::ERR_SUCCESS);
+  }
+
+  /* Return the message for the factorization current error state */
+  std::string error_message() const {
+    switch(error) {
+      case FactorizationError::ERR_SUCCESS:
+        return "No error found!";
+      case FactorizationError::ERR_DIM:
+        return "Matrix is not square!";
+      case FactorizationError::ERR_SINGULAR:
+        return "Matrix is singular!";
+      default:
+        return "Some error occurred!";
+    }
+  }
+};
+
+/* Cholesky factorization A = L * L^T of a symmetric positive definite
+   matrix, of which only the lower triangle is read. Blocked like
+   LUFactorization, at half of its cost and without pivoting */
+class CholeskyFactorization {
+private:
+  /* Possible errors for the factorization */
+  enum FactorizationError {
+    ERR_SUCCESS, ERR_DIM, ERR_NOT_DEFINITE
+  };
+
+  /* Matrix dimension */
+  std::size_t n;
+  /* L in the lower triangle, the upper triangle is not used */
+  Matrix l;
+  /* Current error state */
+  FactorizationError error = FactorizationError::ERR_SUCCESS;
+public:
+  /* CholeskyFactorization constructor, factorizing the given matrix using the
+     given number of threads for the trailing updates */
+  explicit CholeskyFactorization(const Matrix& a, unsigned threads = 1) : n(a.rows()), l(a) {
+    if(a.rows() != a.cols() || a.rows() == 0) {
+      error = FactorizationError::ERR_DIM;
+      return;
+    }
+
+    if(!factorize_cholesky(&l(0, 0), n, threads)) {
+      error = FactorizationError::ERR_NOT_DEFINITE;
+    }
+  }
+
+  /* Solves A * X = B for the columns of B, returns an invalid matrix if the
+     dimensions do not fit or the factorization failed */
+  Matrix solve(const Matrix& b) const {
+    if(error != FactorizationError::ERR_SUCCESS || b.rows() != n) {
+      return Matrix(0, 0, 0.0);
+    }
+
+    const std::size_t m = b.cols();
+    Matrix x(b);
+
+    /* Forward substitution with L */
+    for(std::size_t i = 0; i < n; ++i) {
+      for(std::size_t p = 0; p < i; ++p) {
+        const double factor = l(i, p);
+
+        for(std::size_t j = 0; j < m; ++j) {
+          x(i, j) -= factor * x(p, j);
+        }
+      }
+
+      const double diagonal = l(i, i);
+
+      for(std::size_t j = 0; j < m; ++j) {
+        x(i, j) /= diagonal;
+      }
+    }
+
+    /* Backward substitution with L^T, column i of L^T is row i of L */
+    for(std::size_t i = n; i-- > 0;) {
+      const double diagonal = l(i, i);
+
+      for(std::size_t j = 0; j < m; ++j) {
+        x(i, j) /= diagonal;
+      }
+
+      for(std::size_t p = 0; p < i; ++p) {
+        const double factor = l(i, p);
+
+        for(std::size_t j = 0; j < m; ++j) {
+          x(p, j) -= factor * x(i, j);
+        }
+      }
+    }
+
+    return x;
+  }
+
+  /* Return the factor L, its upper triangle holds the input matrix */
+  const Matrix& factor() const {
+    return l;
+  }
+
+  /* Check if the factorization is in an error state */
+  bool has_error() const {
+    return (error != FactorizationError::ERR_SUCCESS);
+  }
+
+  /* Return the message for the factorization current error state */
+  std::string error_message() const {
+    switch(error) {
+      case FactorizationError::ERR_SUCCESS:
+        return "No error found!";
+      case FactorizationError::ERR_DIM:
+        return "Matrix is not square!";
+      case FactorizationError::ERR_NOT_DEFINITE:
+        return "Matrix is not positive definite!";
+      default:
+        return "Some error occurred!";
+    }
+  }
+};
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include "Matrix.h"
+#include "Factorization.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+bool almostEqual(double a, double b, double epsilon) {
+	return std::abs(a - b) <= epsilon * std::max(1.0, std::abs(b));
+}
+
+bool almostEqual(const Matrix& a, const Matrix& b, double epsilon) {
+	if (a.rows() != b.rows() || a.cols() != b.cols()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.rows(); ++i) {
+		for (size_t j = 0; j < a.cols(); ++j) {
+			if (!almostEqual(a(i, j), b(i, j), epsilon)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+Matrix filled(size_t rows, size_t cols, double offset) {
+	Matrix m(rows, cols, 0.0);
+	for (size_t i = 0; i < rows; ++i) {
+		for (size_t j = 0; j < cols; ++j) {
+			m(i, j) = std::sin(offset + 0.37 * i + 1.3 * j);
+		}
+	}
+	return m;
+}
+
+// entries are not a sum of a few separable terms, so the matrix is regular
+Matrix general(size_t n, double offset) {
+	Matrix m(n, n, 0.0);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			m(i, j) = std::sin(offset + 0.37 * i + 1.3 * j + 0.71 * i * j / n) + (i == j ? 0.5 : 0.0);
+		}
+	}
+	return m;
+}
+
+// B * B^T + n * I is symmetric positive definite
+Matrix spd(size_t n) {
+	Matrix b = filled(n, n, 0.3);
+	Matrix a(b.view().transpose());
+	a = b * a;
+	for (size_t i = 0; i < n; ++i) {
+		a(i, i) += n;
+	}
+	return a;
+}
+
+// sizes below, at and above the block size, with several right-hand sides
+void test_lu() {
+	TESTCASE("test_lu");
+	for (size_t n : { 1, 2, 7, 64, 65, 150, 300 }) {
+		Matrix a = general(n, 0.1);
+		Matrix x = filled(n, 3, 0.9);
+		Matrix b = a * x;
+
+		LUFactorization lu(a);
+		assert("factorization succeeded" && !lu.has_error());
+		assert("solve" && almostEqual(lu.solve(b), x, 1e-8));
+
+		// the factors reproduce the permuted matrix
+		Matrix l(n, n, 0.0), u(n, n, 0.0);
+		for (size_t i = 0; i < n; ++i) {
+			for (size_t j = 0; j < n; ++j) {
+				if (j < i) l(i, j) = lu.factors()(i, j);
+				else u(i, j) = lu.factors()(i, j);
+			}
+			l(i, i) = 1.0;
+		}
+		Matrix pa(n, n, 0.0);
+		for (size_t i = 0; i < n; ++i) {
+			for (size_t j = 0; j < n; ++j) {
+				pa(i, j) = a(lu.permutation()[i], j);
+			}
+		}
+		assert("P * A = L * U" && almostEqual(l * u, pa, 1e-10));
+
+		// the parallel update performs the same operations on every entry
+		LUFactorization parallel(a, 4);
+		assert("parallel factorization" && parallel.factors() == lu.factors());
+	}
+}
+
+void test_lu_errors() {
+	TESTCASE("test_lu_errors");
+	Matrix a(3, 3, 0.0);
+	a(0, 1) = 2.0; a(1, 0) = 3.0; a(2, 2) = 4.0;
+	LUFactorization lu(a);
+	assert("pivoting around a zero diagonal" && !lu.has_error());
+	assert("determinant" && almostEqual(lu.determinant(), -24.0, 1e-14));
+
+	Matrix singular(3, 3, 1.0);
+	LUFactorization slu(singular);
+	assert("singular matrix" && slu.has_error() && slu.error_message() == "Matrix is singular!");
+	assert("no solution for a singular matrix" && slu.solve(Matrix(3, 1, 1.0)).rows() == 0);
+
+	LUFactorization rect(Matrix(3, 2, 1.0));
+	assert("non-square matrix" && rect.has_error() && rect.error_message() == "Matrix is not square!");
+	assert("right-hand side dimension" && lu.solve(Matrix(2, 1, 1.0)).rows() == 0);
+}
+
+void test_cholesky() {
+	TESTCASE("test_cholesky");
+	for (size_t n : { 1, 3, 64, 100, 257 }) {
+		Matrix a = spd(n);
+		Matrix x = filled(n, 4, 0.5);
+		Matrix b = a * x;
+
+		CholeskyFactorization chol(a);
+		assert("factorization succeeded" && !chol.has_error());
+		assert("solve" && almostEqual(chol.solve(b), x, 1e-8));
+		assert("agrees with LU" && almostEqual(chol.solve(b), LUFactorization(a).solve(b), 1e-8));
+
+		CholeskyFactorization parallel(a, 3);
+		assert("parallel factorization" && parallel.factor() == chol.factor());
+	}
+
+	Matrix indefinite(2, 2, 1.0);
+	indefinite(1, 0) = 2.0;
+	CholeskyFactorization chol(indefinite);
+	assert("indefinite matrix" && chol.has_error() && chol.error_message() == "Matrix is not positive definite!");
+}
+
+int main() {
+	test_lu();
+	test_lu_errors();
+	test_cholesky();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include "../../common/CpuDispatch.h"
+
+/* Block sizes of the matrix product kernel: a block of rows of C, a block of
+   the summation index and a block of columns of C are processed together so
+   that the touched parts of A, B and C stay in cache */
+const std::size_t GEMM_BLOCK_ROWS = 64;
+const std::size_t GEMM_BLOCK_INNER = 256;
+const std::size_t GEMM_BLOCK_COLS = 512;
+
+/* Computes C = alpha * op(A) * op(B) + beta * C for row-major buffers, where
+   op(A) is m x k and op(B) is k x n. If a_trans is set, A is stored as its
+   transpose (k x m), and the same goes for b_trans and B (stored n x k), so
+   transposed operands are read in place instead of being copied. C must not
+   share memory with A or B. Unless B is transposed, the products for each
+   element of C are summed up in ascending order of the summation index, just
+   like the naive triple loop does. This is the body shared by the builds
+   for each instruction set level, see gemm_kernel */
+ISA_KERNEL void gemm_kernel_body(
+  std::size_t m, std::size_t n, std::size_t k,
+  double alpha, const double *a, bool a_trans, const double *b, bool b_trans,
+  double beta, double *c) {
+
+  /* Scale C first, overwriting it if beta is zero so previous contents (even
+     NaNs) do not leak into the result */
+  if(beta == 0.0) {
+    std::fill(c, c + m * n, 0.0);
+  } else if(beta != 1.0) {
+    for(std::size_t i = 0; i < m * n; ++i) {
+      c[i] *= beta;
+    }
+  }
+
+  if(alpha == 0.0 || k == 0) {
+    return;
+  }
+
+  /* Go through the blocks of C and of the summation index */
+  for(std::size_t ii = 0; ii < m; ii += GEMM_BLOCK_ROWS) {
+    std::size_t i_end = std::min(ii + GEMM_BLOCK_ROWS, m);
+
+    for(std::size_t kk = 0; kk < k; kk += GEMM_BLOCK_INNER) {
+      std::size_t k_end = std::min(kk + GEMM_BLOCK_INNER, k);
+
+      for(std::size_t jj = 0; jj < n; jj += GEMM_BLOCK_COLS) {
+        std::size_t j_end = std::min(jj + GEMM_BLOCK_COLS, n);
+
+        if(!b_trans) {
+          /* Rows of B are contiguous: broadcast one element of A and update
+             a row of C with a row of B */
+          for(std::size_t i = ii; i < i_end; ++i) {
+            double *c_row = c + i * n;
+
+            for(std::size_t p = kk; p < k_end; ++p) {
+              const double a_ip = alpha * (a_trans ? a[p * m + i] : a[i * k + p]);
+              const double *b_row = b + p * n;
+
+              for(std::size_t j = jj; j < j_end; ++j) {
+                c_row[j] += a_ip * b_row[j];
+              }
+            }
+          }
+        } else if(!a_trans) {
+          /* Rows of A and columns of op(B) are both contiguous: each element
+             of C is a dot product of two contiguous ranges */
+          for(std::size_t i = ii; i < i_end; ++i) {
+            const double *a_row = a + i * k;
+
+            for(std::size_t j = jj; j < j_end; ++j) {
+              const double *b_col = b + j * k;
+              double sum = 0.0;
+
+              for(std::size_t p = kk; p < k_end; ++p) {
+                sum += a_row[p] * b_col[p];
+              }
+
+              c[i * n + j] += alpha * sum;
+            }
+          }
+        } else {
+          /* Both operands transposed: columns of op(A) are contiguous, so
+             broadcast one element of B and update a column of C */
+          for(std::size_t j = jj; j < j_end; ++j) {
+            for(std::size_t p = kk; p < k_end; ++p) {
+              const double b_pj = alpha * b[j * k + p];
+              const double *a_col = a + p * m;
+
+              for(std::size_t i = ii; i < i_end; ++i) {
+                c[i * n + j] += a_col[i] * b_pj;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/* Builds of the kernel for each instruction set level */
+inline void gemm_kernel_sse2(
+  std::size_t m, std::size_t n, std::size_t k,
+  double alpha, const double *a, bool a_trans, const double *b, bool b_trans,
+  double beta, double *c) {
+
+  gemm_kernel_body(m, n, k, alpha, a, a_trans, b, b_trans, beta, c);
+}
+
+ISA_TARGET_AVX2 inline void gemm_kernel_avx2(
+  std::size_t m, std::size_t n, std::size_t k,
+  double alpha, const double *a, bool a_trans, const double *b, bool b_trans,
+  double beta, double *c) {
+
+  gemm_kernel_body(m, n, k, alpha, a, a_trans, b, b_trans, beta, c);
+}
+
+ISA_TARGET_AVX512 inline void gemm_kernel_avx512(
+  std::size_t m, std::size_t n, std::size_t k,
+  double alpha, const double *a, bool a_trans, const double *b, bool b_trans,
+  double beta, double *c) {
+
+  gemm_kernel_body(m, n, k, alpha, a, a_trans, b, b_trans, beta, c);
+}
+
+/* Computes C = alpha * op(A) * op(B) + beta * C with the build for the given
+   instruction set level, which the CPU must support. All builds perform the
+   same operations in the same order, so their results are identical */
+inline void gemm_kernel_for(
+  IsaLevel level, std::size_t m, std::size_t n, std::size_t k,
+  double alpha, const double *a, bool a_trans, const double *b, bool b_trans,
+  double beta, double *c) {
+
+  isa_dispatch(level, gemm_kernel_sse2, gemm_kernel_avx2, gemm_kernel_avx512, m, n, k, alpha, a, a_trans, b, b_trans, beta, c);
+}
+
+/* Computes C = alpha * op(A) * op(B) + beta * C, see gemm_kernel_body, with
+   the build for the instruction set level selected at startup */
+inline void gemm_kernel(
+  std::size_t m, std::size_t n, std::size_t k,
+  double alpha, const double *a, bool a_trans, const double *b, bool b_trans,
+  double beta, double *c) {
+
+  gemm_kernel_for(isa_level(), m, n, k, alpha, a, a_trans, b, b_trans, beta, c);
+}
@@ -0,0 +1,177 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include "Matrix.h"
+#include "Gemm.h"
+#include "../../common/CpuDispatch.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+bool almostEqual(double a, double b, double epsilon = 1e-10) {
+	return std::abs(a - b) <= epsilon;
+}
+
+bool almostEqual(const MatrixView& a, const MatrixView& b, double epsilon = 1e-10) {
+	if (a.rows() != b.rows() || a.cols() != b.cols()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.rows(); ++i) {
+		for (size_t j = 0; j < a.cols(); ++j) {
+			if (!almostEqual(a(i, j), b(i, j), epsilon)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+Matrix filled(size_t rows, size_t cols, double offset) {
+	Matrix m(rows, cols, 0.0);
+	for (size_t i = 0; i < rows; ++i) {
+		for (size_t j = 0; j < cols; ++j) {
+			m(i, j) = std::sin(offset + 0.37 * i + 1.3 * j);
+		}
+	}
+	return m;
+}
+
+// straightforward reference product
+Matrix reference(const MatrixView& a, const MatrixView& b) {
+	Matrix c(a.rows(), b.cols(), 0.0);
+	for (size_t i = 0; i < a.rows(); ++i) {
+		for (size_t j = 0; j < b.cols(); ++j) {
+			for (size_t k = 0; k < a.cols(); ++k) {
+				c(i, j) += a(i, k) * b(k, j);
+			}
+		}
+	}
+	return c;
+}
+
+void test_transpose_view(size_t rows = 3, size_t cols = 5) {
+	TESTCASE("test_transpose_view");
+	Matrix m = filled(rows, cols, 0.0);
+	MatrixView t = m.transpose();
+	assert("transposed dimensions" && t.rows() == cols && t.cols() == rows);
+	assert("no copy" && t.data() == &m(0, 0));
+	for (size_t i = 0; i < rows; ++i) {
+		for (size_t j = 0; j < cols; ++j) {
+			assert("transposed element" && t(j, i) == m(i, j));
+		}
+	}
+	assert("double transpose" && almostEqual(t.transpose(), m, 0));
+	Matrix copy(t);
+	assert("materialized view" && almostEqual(copy, t, 0));
+}
+
+// sizes cross the block boundaries of the kernel
+void test_gemm_variants(size_t m = 70, size_t n = 530, size_t k = 260) {
+	TESTCASE("test_gemm_variants");
+	Matrix a = filled(m, k, 0.1);
+	Matrix at = Matrix(a.transpose());
+	Matrix b = filled(k, n, 0.2);
+	Matrix bt = Matrix(b.transpose());
+	Matrix expected = reference(a, b);
+
+	Matrix c(m, n, 0.0);
+	c.gemm(1.0, a, b, 0.0);
+	assert("A * B" && almostEqual(c, expected));
+	c.gemm(1.0, at.transpose(), b, 0.0);
+	assert("A^T * B" && almostEqual(c, expected));
+	c.gemm(1.0, a, bt.transpose(), 0.0);
+	assert("A * B^T" && almostEqual(c, expected));
+	c.gemm(1.0, at.transpose(), bt.transpose(), 0.0);
+	assert("A^T * B^T" && almostEqual(c, expected));
+	assert("operator* uses the kernel" && almostEqual(a * b, expected, 0));
+
+	// alpha / beta update of existing storage
+	Matrix d = filled(m, n, 0.3);
+	Matrix dExpected = d;
+	dExpected.scale(0.5).axpy(2.0, expected);
+	const double* storage = &d(0, 0);
+	gemm(2.0, a, b, 0.5, d);
+	assert("gemm with alpha and beta" && almostEqual(d, dExpected));
+	assert("gemm writes into existing storage" && &d(0, 0) == storage);
+
+	Matrix wrong(m + 1, n, 0.0);
+	wrong.gemm(1.0, a, b, 0.0);
+	assert("gemm dimension check" && wrong.has_error());
+}
+
+void test_in_place(size_t rows = 4, size_t cols = 6) {
+	TESTCASE("test_in_place");
+	Matrix x = filled(rows, cols, 0.0);
+	Matrix y = filled(rows, cols, 1.0);
+	Matrix expected = y;
+	for (size_t i = 0; i < rows; ++i) {
+		for (size_t j = 0; j < cols; ++j) {
+			expected(i, j) = 3.0 * y(i, j) - 2.0 * x(i, j);
+		}
+	}
+	y.scale(3.0).axpy(-2.0, x);
+	assert("scale and axpy" && almostEqual(y, expected));
+
+	Matrix sq = filled(cols, cols, 0.5);
+	Matrix sqT(sq.transpose());
+	Matrix sum = sq;
+	sum.axpy(1.0, sq.transpose());
+	assert("axpy with a transposed view" && almostEqual(sum, sq + sqT));
+
+	Matrix p = sq;
+	p *= p;
+	assert("self product assignment" && almostEqual(p, reference(sq, sq)));
+
+	Matrix z = filled(rows, rows, 0.0);
+	z.axpy(1.0, x);
+	assert("axpy dimension check" && z.has_error());
+}
+
+// every build the CPU supports gives exactly the same result
+void test_isa_levels(size_t m = 37, size_t n = 70, size_t k = 45) {
+	TESTCASE("test_isa_levels");
+	std::cout << "\tdetected " << isa_name(detect_isa_level()) << ", using " << isa_name(isa_level()) << std::endl;
+	assert("override selects a lower level" && select_isa_level("sse2", IsaLevel::AVX512) == IsaLevel::SSE2);
+	assert("override can not exceed the CPU" && select_isa_level("avx512", IsaLevel::AVX2) == IsaLevel::AVX2);
+	assert("unknown override is ignored" && select_isa_level("neon", IsaLevel::AVX2) == IsaLevel::AVX2);
+	assert("no override" && select_isa_level(nullptr, IsaLevel::AVX512) == IsaLevel::AVX512);
+
+	Matrix a = filled(m, k, 0.1);
+	Matrix b = filled(k, n, 0.2);
+	for (bool aTrans : { false, true }) {
+		for (bool bTrans : { false, true }) {
+			Matrix expected(m, n, 0.0);
+			gemm_kernel_for(IsaLevel::SSE2, m, n, k, 1.5, &a(0, 0), aTrans, &b(0, 0), bTrans, 0.0, &expected(0, 0));
+			for (IsaLevel level : { IsaLevel::AVX2, IsaLevel::AVX512 }) {
+				if (level > detect_isa_level()) {
+					continue;
+				}
+				Matrix c(m, n, 0.0);
+				gemm_kernel_for(level, m, n, k, 1.5, &a(0, 0), aTrans, &b(0, 0), bTrans, 0.0, &c(0, 0));
+				assert("identical results on every level" && c == expected);
+			}
+		}
+	}
+}
+
+int main() {
+	test_transpose_view();
+	test_gemm_variants();
+	test_in_place();
+	test_isa_levels();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
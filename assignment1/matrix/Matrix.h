@@ -1,4 +1,56 @@
+#pragma once
+
 #include <iostream>
+#include <utility>
+#include "Gemm.h"
+#include "Workspace.h"
+
+/* Read-only view on the data of a matrix with the given (logical) dimensions.
+   A transposed view reads the same row-major data with the indices swapped,
+   so nothing is copied */
+class MatrixView {
+private:
+  /* Data pointer of the viewed matrix */
+  const double *data_;
+  /* Dimensions of the view */
+  std::size_t nrows, ncols;
+  /* Whether the data is stored as the transpose of the view */
+  bool transposed_;
+public:
+  /* MatrixView constructor */
+  MatrixView(const double *data, std::size_t rows, std::size_t cols, bool transposed) :
+    data_(data), nrows(rows), ncols(cols), transposed_(transposed) {}
+
+  /* Return element value from the specified index */
+  double operator()(std::size_t i, std::size_t j) const {
+    return transposed_ ? data_[j * nrows + i] : data_[i * ncols + j];
+  }
+
+  /* Return the transpose of this view */
+  MatrixView transpose() const {
+    return MatrixView(data_, ncols, nrows, !transposed_);
+  }
+
+  /* Return the number of rows */
+  std::size_t rows() const {
+    return nrows;
+  }
+
+  /* Return the number of columns */
+  std::size_t cols() const {
+    return ncols;
+  }
+
+  /* Return the data pointer */
+  const double *data() const {
+    return data_;
+  }
+
+  /* Check if the data is stored transposed */
+  bool transposed() const {
+    return transposed_;
+  }
+};
 
 class Matrix {
 private:
@@ -17,10 +69,10 @@ public:
 
   /* Matrix constructor */
   Matrix(std::size_t rows, std::size_t cols, double initValue) : nrows(rows), ncols(cols) {
-    /* If none of the dimensions is zero, allocate the data and assign it to
-       the data pointer */
+    /* If none of the dimensions is zero, take the data from the workspace
+       and assign it to the data pointer */
     if(rows * cols != 0) {
-      data = new double[rows * cols];
+      data = Workspace::local().acquire(rows * cols);
     /* Otherwise, assign nullptr to the data pointer and change the error state
        to dimension error */
     } else {
@@ -39,16 +91,16 @@ public:
 
   /* Matrix destructor */
   ~Matrix() {
-    /* Free memory in the data pointer */
-    delete[] data;
+    /* Give the data back to the workspace */
+    Workspace::local().release(data, nrows * ncols);
   }
 
   /* Matrix copy constructor */
   Matrix(const Matrix& m) : nrows(m.rows()), ncols(m.cols()) {
-    /* If none of the dimensions is zero, allocate the data and assign it to
-       the data pointer */
+    /* If none of the dimensions is zero, take the data from the workspace
+       and assign it to the data pointer */
     if(m.rows() * m.cols() != 0) {
-      data = new double[m.rows() * m.cols()];
+      data = Workspace::local().acquire(m.rows() * m.cols());
     /* Otherwise, assign nullptr to the data pointer and change the error state
        to dimension error */
     } else {
@@ -64,20 +116,37 @@ public:
     }
   }
 
+  /* Matrix constructor, copying the elements of a (possibly transposed) view */
+  explicit Matrix(const MatrixView& v) : Matrix(v.rows(), v.cols(), 0.0) {
+    for(std::size_t i = 0; i < nrows; ++i) {
+      for(std::size_t j = 0; j < ncols; ++j) {
+        data[i * ncols + j] = v(i, j);
+      }
+    }
+  }
+
+  /* Matrix move constructor */
+  Matrix(Matrix&& m) : nrows(m.nrows), ncols(m.ncols), data(m.data), error(m.error) {
+    /* Leave the moved matrix empty, so it has nothing to release */
+    m.nrows = 0;
+    m.ncols = 0;
+    m.data = nullptr;
+  }
+
   /* Matrix assignment */
   Matrix& operator=(const Matrix& m) {
     /* Assure that if this matrix is assigned to itself, nothing is done */
     if(&m != this) {
-      /* Free data if it is not null */
-      if(data != NULL) {
-        delete[] data;
+      /* Only exchange the data if the number of elements changes, otherwise
+         the current buffer is overwritten */
+      if(nrows * ncols != m.rows() * m.cols()) {
+        Workspace::local().release(data, nrows * ncols);
+        data = Workspace::local().acquire(m.rows() * m.cols());
       }
 
       /* Set dimensions to the corresponding dimensions from the assigned matrix */
       nrows = m.rows();
       ncols = m.cols();
-      /* Allocate new data according to the new dimensions */
-      data = new double[nrows * ncols];
 
       /* Copy element by element from the given matrix to this one */
       for(std::size_t i = 0; i < nrows; ++i) {
@@ -90,6 +159,19 @@ public:
     return *this;
   }
 
+  /* Matrix move assignment */
+  Matrix& operator=(Matrix&& m) {
+    /* Swap the contents, the moved matrix releases our old data */
+    if(&m != this) {
+      std::swap(nrows, m.nrows);
+      std::swap(ncols, m.ncols);
+      std::swap(data, m.data);
+      std::swap(error, m.error);
+    }
+
+    return *this;
+  }
+
   /* Return reference from the specified index */
   double& operator()(std::size_t i, std::size_t j) {
     return data[i * ncols + j];
@@ -225,36 +307,23 @@ public:
 
   /* Product assignment operator */
   Matrix& operator *=(const Matrix& m) {
-    /* Pointer to old data */
-    double *old_data = data;
-
     /* If the number of columns of this matrix and the number of rows of the
        other matrix is not equal, do nothing and change the error state */
     if(ncols != m.rows()) {
       error = MatrixError::ERR_OPER_DIM;
     /* Otherwise, proceed normally */
     } else {
-      /* Allocate data for the result with its dimensions */
-      data = new double[nrows * m.cols()];
+      /* Compute the product into a buffer from the workspace, so the old data
+         (which m may share) stays intact until the product is complete */
+      double *result_data = Workspace::local().acquire(nrows * m.cols());
 
-      /* Go through each element of the result matrix */
-      for(std::size_t i = 0; i < nrows; ++i) {
-        for(std::size_t j = 0; j < m.cols(); ++j) {
-          /* Current element of the result matrix is set to zero by default */
-          data[i * m.cols() + j] = 0.0;
-
-          /* Perform the matrix product by going through all the k columns in the
-             current line i for the first matrix, and through all the k lines in the
-             j column for the second matrix, the result is the summation of the
-             products got on each iteration */
-          for(std::size_t k = 0; k < ncols; ++k) {
-            data[i * m.cols() + j] += old_data[i * ncols + k] * m(k, j);
-          }
-        }
+      if(nrows * m.cols() != 0) {
+        gemm_kernel(nrows, m.cols(), ncols, 1.0, data, false, m.data, false, 0.0, result_data);
       }
 
+      Workspace::local().release(data, nrows * ncols);
+      data = result_data;
       ncols = m.cols();
-      delete[] old_data;
     }
 
     return *this;
@@ -262,29 +331,74 @@ public:
 
   /* Matrix product */
   Matrix operator *(const Matrix& m) const {
-    /* Result matrix */
-    Matrix result(nrows, m.cols(), 0.0);
-
     /* If the number of columns of this matrix and the number of rows of the
        other matrix is not equal, do nothing and returns an invalid matrix */
     if(ncols != m.rows()) {
       return Matrix(0, 0, 0.0);
+    }
+
+    /* Result matrix */
+    Matrix result(nrows, m.cols(), 0.0);
+    result.gemm(1.0, view(), m.view(), 0.0);
+    return result;
+  }
+
+  /* Scale all elements by the given factor, in place */
+  Matrix& scale(double alpha) {
+    for(std::size_t i = 0; i < nrows * ncols; ++i) {
+      data[i] *= alpha;
+    }
+
+    return *this;
+  }
+
+  /* Add alpha * x to this matrix, in place. The operand may be a transposed
+     view */
+  Matrix& axpy(double alpha, const MatrixView& x) {
+    /* If dimensions differ, do nothing and change the error state */
+    if(nrows != x.rows() || ncols != x.cols()) {
+      error = MatrixError::ERR_OPER_DIM;
     } else {
-      /* Go through each element of the result matrix */
       for(std::size_t i = 0; i < nrows; ++i) {
-        for(std::size_t j = 0; j < m.cols(); ++j) {
-          /* Perform the matrix product by going through all the k columns in the
-             current line i for the first matrix, and through all the k lines in the
-             j column for the second matrix, the result is the summation of the
-             products got on each iteration */
-          for(std::size_t k = 0; k < ncols; ++k) {
-            result(i, j) += data[i * ncols + k] * m(k, j);
-          }
+        for(std::size_t j = 0; j < ncols; ++j) {
+          data[i * ncols + j] += alpha * x(i, j);
         }
       }
     }
 
-    return result;
+    return *this;
+  }
+
+  /* Overwrite this matrix with alpha * a * b + beta * (this matrix), where the
+     operands may be transposed views. Neither operand may share data with this
+     matrix */
+  Matrix& gemm(double alpha, const MatrixView& a, const MatrixView& b, double beta) {
+    /* If dimensions do not fit, do nothing and change the error state */
+    if(a.cols() != b.rows() || nrows != a.rows() || ncols != b.cols()) {
+      error = MatrixError::ERR_OPER_DIM;
+    } else if(nrows * ncols != 0) {
+      gemm_kernel(
+        nrows, ncols, a.cols(),
+        alpha, a.data(), a.transposed(), b.data(), b.transposed(),
+        beta, data);
+    }
+
+    return *this;
+  }
+
+  /* Return a view on this matrix */
+  MatrixView view() const {
+    return MatrixView(data, nrows, ncols, false);
+  }
+
+  /* Return a transposed view on this matrix, no data is copied */
+  MatrixView transpose() const {
+    return MatrixView(data, ncols, nrows, true);
+  }
+
+  /* Matrices can be passed wherever a view is expected */
+  operator MatrixView() const {
+    return view();
   }
 
   /* Return the number of rows */
@@ -342,3 +456,8 @@ public:
     }
   }
 };
+
+/* Overwrite c with alpha * a * b + beta * c, see Matrix::gemm */
+inline Matrix& gemm(double alpha, const MatrixView& a, const MatrixView& b, double beta, Matrix& c) {
+  return c.gemm(alpha, a, b, beta);
+}
@@ -1,9 +1,76 @@
 #include <iostream>
+#include <string>
 #include "Matrix.h"
+#include "Strassen.h"
+#include "Pipeline.h"
+#include "Server.h"
 
-int main() {
+/* Print the accepted arguments */
+void usage(const char *program) {
+  std::cerr << "usage: " << program << " [CUTOFF] [--pipelined | --batch | --socket PATH]" << std::endl;
+}
+
+/* Parse a positive block size made of digits only into cutoff, returns false
+   if the argument is not one */
+bool parse_cutoff(const std::string& arg, std::size_t& cutoff) {
+  if(arg.empty() || arg.size() > 9 || arg.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+
+  cutoff = std::stoul(arg);
+  return cutoff > 0;
+}
+
+int main(int argc, char **argv) {
   /* Dimensions s1, s2 and s3 */
   std::size_t s1, s2, s3;
+  /* Block size below which square products use the blocked kernel instead of
+     the Strassen-Winograd recursion, can be given as an argument */
+  std::size_t cutoff = STRASSEN_DEFAULT_CUTOFF;
+  /* Whether to run as a pipeline, selected with --pipelined */
+  bool pipelined = false;
+  /* Whether to answer a stream of jobs from the standard input, selected
+     with --batch, or from a Unix domain socket, selected with --socket PATH */
+  bool batch = false;
+  std::string socket_path;
+
+  for(int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+
+    if(arg == "--pipelined") {
+      pipelined = true;
+    } else if(arg == "--batch") {
+      batch = true;
+    } else if(arg == "--socket" && i + 1 < argc) {
+      socket_path = argv[++i];
+    } else if(!parse_cutoff(arg, cutoff)) {
+      usage(argv[0]);
+      return -1;
+    }
+  }
+
+  /* Long-running modes, see ProductServer */
+  if(batch) {
+    ProductServer().serve(STDIN_FILENO, STDOUT_FILENO);
+    return 0;
+  }
+
+  if(!socket_path.empty()) {
+    std::cerr << serve_socket(socket_path) << std::endl;
+    return -1;
+  }
+
+  /* Overlap parsing, multiplication and output, see PipelinedProduct */
+  if(pipelined) {
+    PipelinedProduct product;
+
+    if(product.run(std::cin, std::cout).has_error()) {
+      std::cerr << product.error_message() << std::endl;
+      return -1;
+    }
+
+    return 0;
+  }
 
   /* Read dimensions from the standard input */
   std::cin >> s1 >> s2 >> s3;
@@ -24,8 +91,13 @@ int main() {
   /* Read matrix m2 data from standard input */
   std::cin >> m2;
 
-  /* Assign the m1 and m2 product result to the matrix m3 */
-  m3 = m1 * m2;
+  /* Assign the m1 and m2 product result to the matrix m3, square products
+     go through the recursive algorithm */
+  if(s1 == s2 && s2 == s3) {
+    m3 = strassen(m1, m2, cutoff);
+  } else {
+    m3 = m1 * m2;
+  }
 
   /* If there's an error with the result matrix m3, returns it */
   if(m3.has_error()) {
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <iterator>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Gemm.h"
+
+/* Rows of the result that are parsed, computed and formatted together */
+const std::size_t PIPELINE_BLOCK_ROWS = 16;
+
+/* Number of finished blocks per worker that may wait for the writer, before
+   the workers pause so that the output does not pile up in memory */
+const std::size_t PIPELINE_BLOCKS_AHEAD = 4;
+
+/* Return the position of the first non-whitespace character from p on */
+inline const char *pipeline_skip_space(const char *p, const char *end) {
+  while(p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == '\v' || *p == '\f')) {
+    ++p;
+  }
+
+  return p;
+}
+
+/* Return the position after the token starting at p */
+inline const char *pipeline_skip_token(const char *p, const char *end) {
+  while(p < end && !(*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == '\v' || *p == '\f')) {
+    ++p;
+  }
+
+  return p;
+}
+
+/* Parse the number at p (after whitespace) and advance p past it. Like the
+   stream extraction operator, missing or malformed entries are read as zero,
+   after which p stays at the end of the input */
+inline double pipeline_parse(const char *&p, const char *end) {
+  p = pipeline_skip_space(p, end);
+
+  if(p == end) {
+    return 0.0;
+  }
+
+  /* The input buffer is null terminated, so strtod stops at its end */
+  char *next;
+  double value = std::strtod(p, &next);
+
+  if(next == p) {
+    p = end;
+    return 0.0;
+  }
+
+  p = next;
+  return value;
+}
+
+/* Append the rows x cols row-major values to out, formatted like the stream
+   insertion operator of Matrix does */
+inline void pipeline_format(const double *values, std::size_t rows, std::size_t cols, std::string& out) {
+  char number[32];
+
+  for(std::size_t i = 0; i < rows; ++i) {
+    for(std::size_t j = 0; j < cols; ++j) {
+      /* %g with the default precision is what std::ostream prints */
+      int length = std::snprintf(number, sizeof(number), "%g ", values[i * cols + j]);
+      out.append(number, length);
+    }
+
+    out.push_back('\n');
+  }
+}
+
+/* Matrix product program working as a pipeline: the whole input is read at
+   once, the entries of m1 are only skipped to find m2, which is parsed
+   first, and then blocks of rows of m1 are parsed and multiplied by worker
+   threads while the calling thread writes finished blocks of the result in
+   order. Output starts as soon as the first block is done, and parsing,
+   multiplication and formatting of different blocks overlap. The result is
+   the one of the blocked kernel, printed like the sequential program does */
+class PipelinedProduct {
+private:
+  /* Possible errors for the pipeline */
+  enum PipelineError {
+    ERR_SUCCESS, ERR_DIM
+  };
+
+  /* Number of worker threads */
+  unsigned workers;
+  /* Current error state */
+  PipelineError error = PipelineError::ERR_SUCCESS;
+public:
+  /* PipelinedProduct constructor, zero threads uses one per processor */
+  explicit PipelinedProduct(unsigned threads = 0) : workers(threads) {
+    if(workers == 0) {
+      workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+  }
+
+  /* Read s1, s2, s3, m1 and m2 from input and write m1 * m2 to output */
+  PipelinedProduct& run(std::istream& input, std::ostream& output) {
+    /* Slurp the input, the string keeps it null terminated */
+    std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    const char *p = text.c_str();
+    const char *end = p + text.size();
+
+    /* Dimensions s1, s2 and s3 */
+    std::size_t dims[3];
+
+    for(std::size_t &dim : dims) {
+      const double value = pipeline_parse(p, end);
+      dim = (value > 0.0) ? (std::size_t)value : 0;
+    }
+
+    const std::size_t s1 = dims[0], s2 = dims[1], s3 = dims[2];
+
+    if(s1 * s2 * s3 == 0) {
+      error = PipelineError::ERR_DIM;
+      return *this;
+    }
+
+    /* Skip m1, remembering where each block of its rows starts */
+    const std::size_t blocks = (s1 + PIPELINE_BLOCK_ROWS - 1) / PIPELINE_BLOCK_ROWS;
+    std::vector<const char *> block_start(blocks);
+
+    for(std::size_t i = 0; i < s1; ++i) {
+      if(i % PIPELINE_BLOCK_ROWS == 0) {
+        block_start[i / PIPELINE_BLOCK_ROWS] = p;
+      }
+
+      for(std::size_t j = 0; j < s2; ++j) {
+        p = pipeline_skip_token(pipeline_skip_space(p, end), end);
+      }
+    }
+
+    /* Parse m2 */
+    std::vector<double> m2(s2 * s3);
+
+    for(double &value : m2) {
+      value = pipeline_parse(p, end);
+    }
+
+    /* Finished blocks of formatted output, handed from the workers to the
+       writer, and the number of blocks written and claimed so far */
+    std::vector<std::string> finished(blocks);
+    std::vector<bool> ready(blocks, false);
+    std::size_t written = 0, claimed = 0;
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    auto work = [&] () {
+      std::vector<double> a(PIPELINE_BLOCK_ROWS * s2), c(PIPELINE_BLOCK_ROWS * s3);
+
+      while(true) {
+        std::size_t block;
+
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          changed.wait(lock, [&] { return claimed >= blocks || claimed < written + PIPELINE_BLOCKS_AHEAD * workers; });
+
+          if(claimed >= blocks) {
+            return;
+          }
+
+          block = claimed++;
+        }
+
+        /* Parse the rows of m1, multiply and format them */
+        const std::size_t first = block * PIPELINE_BLOCK_ROWS;
+        const std::size_t rows = std::min(PIPELINE_BLOCK_ROWS, s1 - first);
+        const char *q = block_start[block];
+
+        for(std::size_t k = 0; k < rows * s2; ++k) {
+          a[k] = pipeline_parse(q, end);
+        }
+
+        gemm_kernel(rows, s3, s2, 1.0, a.data(), false, m2.data(), false, 0.0, c.data());
+
+        std::string formatted;
+        formatted.reserve(rows * s3 * 12);
+        pipeline_format(c.data(), rows, s3, formatted);
+
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          finished[block].swap(formatted);
+          ready[block] = true;
+        }
+
+        changed.notify_all();
+      }
+    };
+
+    std::vector<std::thread> threads;
+
+    for(unsigned t = 0; t < workers; ++t) {
+      threads.emplace_back(work);
+    }
+
+    /* Write the blocks in order as they become ready */
+    while(written < blocks) {
+      std::string block;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return ready[written]; });
+        block.swap(finished[written]);
+      }
+
+      output.write(block.data(), block.size());
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++written;
+      }
+
+      changed.notify_all();
+    }
+
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+
+    output.flush();
+    return *this;
+  }
+
+  /* Check if the pipeline is in an error state */
+  bool has_error() const {
+    return (error != PipelineError::ERR_SUCCESS);
+  }
+
+  /* Return the message for the pipeline current error state */
+  std::string error_message() const {
+    switch(error) {
+      case PipelineError::ERR_SUCCESS:
+        return "No error found!";
+      case PipelineError::ERR_DIM:
+        return "None of the input dimensions should be zero!";
+      default:
+        return "Some error occurred!";
+    }
+  }
+};
@@ -0,0 +1,89 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include "Matrix.h"
+#include "Pipeline.h"
+
+/* Compares the sequential MatrixProduct (parse m1, parse m2, multiply,
+   print) with the pipelined one on a generated text input, measuring the
+   time until the first character of output and the total time. The size can
+   be given as the first argument */
+
+using Clock = std::chrono::steady_clock;
+
+/* Output buffer recording when it is first written to */
+class TimedBuffer : public std::stringbuf {
+public:
+  Clock::time_point first;
+  bool written = false;
+protected:
+  std::streamsize xsputn(const char *s, std::streamsize count) override {
+    mark();
+    return std::stringbuf::xsputn(s, count);
+  }
+
+  int_type overflow(int_type c) override {
+    mark();
+    return std::stringbuf::overflow(c);
+  }
+private:
+  void mark() {
+    if(!written) {
+      first = Clock::now();
+      written = true;
+    }
+  }
+};
+
+double seconds(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+int main(int argc, char **argv) {
+  std::size_t n = (argc > 1) ? std::stoul(argv[1]) : 800;
+
+  std::ostringstream generated;
+  generated << n << " " << n << " " << n << "\n";
+
+  for(std::size_t i = 0; i < 2 * n * n; ++i) {
+    generated << std::sin(0.37 * i) * 100. << ((i % n == n - 1) ? "\n" : " ");
+  }
+
+  const std::string input = generated.str();
+  std::cout << n << " x " << n << " product, " << input.size() / 1e6 << " MB of input" << std::endl;
+
+  /* Sequential */
+  {
+    std::istringstream in(input);
+    TimedBuffer buffer;
+    std::ostream out(&buffer);
+    Clock::time_point start = Clock::now();
+
+    std::size_t s1, s2, s3;
+    in >> s1 >> s2 >> s3;
+    Matrix m1(s1, s2, 0.0), m2(s2, s3, 0.0);
+    in >> m1 >> m2;
+    out << m1 * m2;
+
+    Clock::time_point stop = Clock::now();
+    std::cout << "sequential: first output after " << seconds(start, buffer.first) << " s, total " << seconds(start, stop) << " s" << std::endl;
+  }
+
+  /* Pipelined */
+  for(unsigned threads : { 1u, std::max(1u, std::thread::hardware_concurrency()) }) {
+    std::istringstream in(input);
+    TimedBuffer buffer;
+    std::ostream out(&buffer);
+    Clock::time_point start = Clock::now();
+
+    PipelinedProduct(threads).run(in, out);
+
+    Clock::time_point stop = Clock::now();
+    std::cout << "pipelined, " << threads << " workers: first output after " << seconds(start, buffer.first) << " s, total " << seconds(start, stop) << " s" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include "Matrix.h"
+#include "Pipeline.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// the sequential program, without the Strassen-Winograd path
+std::string sequential(const std::string& input) {
+	std::istringstream in(input);
+	size_t s1, s2, s3;
+	in >> s1 >> s2 >> s3;
+	Matrix m1(s1, s2, 0.0), m2(s2, s3, 0.0);
+	in >> m1 >> m2;
+	std::ostringstream out;
+	out << m1 * m2;
+	return out.str();
+}
+
+std::string pipelined(const std::string& input, unsigned threads) {
+	std::istringstream in(input);
+	std::ostringstream out;
+	PipelinedProduct product(threads);
+	assert("pipeline succeeded" && !product.run(in, out).has_error());
+	return out.str();
+}
+
+std::string generated(size_t s1, size_t s2, size_t s3) {
+	std::ostringstream out;
+	out << s1 << " " << s2 << " " << s3 << "\n";
+	for (size_t i = 0; i < s1 * s2 + s2 * s3; ++i) {
+		out << std::sin(0.37 * i) * 100. << ((i % 7 == 6) ? "\n" : "\t");
+	}
+	return out.str();
+}
+
+void test_testcases() {
+	TESTCASE("test_testcases");
+	for (std::string name : { "Square", "NonSquareInt", "NonSquareRandom", "BigMatrix" }) {
+		for (std::string suffix : { ".input.txt", ".input.pretty.txt" }) {
+			std::ifstream file(std::string(TESTCASE_DIR) + "/" + name + suffix);
+			assert("test case file found" && file);
+			std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			for (unsigned threads : { 1, 3 }) {
+				assert("same output as the sequential program" && pipelined(input, threads) == sequential(input));
+			}
+		}
+	}
+}
+
+// more rows than blocks and workers, and partial last blocks
+void test_generated() {
+	TESTCASE("test_generated");
+	for (size_t s1 : { 1, 15, 16, 17, 100 }) {
+		std::string input = generated(s1, 23, 9);
+		for (unsigned threads : { 1, 2, 5 }) {
+			assert("same output as the sequential program" && pipelined(input, threads) == sequential(input));
+		}
+	}
+}
+
+void test_errors() {
+	TESTCASE("test_errors");
+	std::istringstream in("2 0 3\n");
+	std::ostringstream out;
+	PipelinedProduct product(2);
+	assert("zero dimension" && product.run(in, out).has_error());
+	assert("error message" && product.error_message() == "None of the input dimensions should be zero!");
+	assert("no output" && out.str().empty());
+
+	// missing entries are read as zero, like the stream operators do
+	std::string truncated = "2 2 2\n1 2 3 4\n5 6";
+	assert("truncated input" && pipelined(truncated, 2) == sequential(truncated));
+}
+
+int main() {
+	test_testcases();
+	test_generated();
+	test_errors();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,392 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Matrix.h"
+
+/* Size of the read buffer of a connection */
+const std::size_t SERVER_BUFFER_SIZE = 1 << 16;
+
+/* Largest number of entries of the operands and the result of a job
+   together, larger jobs are answered with an error */
+const std::size_t SERVER_MAX_ENTRIES = std::size_t(1) << 26;
+
+/* Largest number of connections served at once by serve_socket */
+const std::size_t SERVER_MAX_CONNECTIONS = 64;
+
+/* Buffered writing of text to a file descriptor */
+class FdWriter {
+private:
+  /* File descriptor written to */
+  int fd;
+  /* Pending output */
+  std::string buffer;
+  /* Whether a write failed, e.g. because the peer went away */
+  bool failed = false;
+public:
+  /* FdWriter constructor */
+  explicit FdWriter(int fd) : fd(fd) {
+    buffer.reserve(SERVER_BUFFER_SIZE);
+  }
+
+  /* FdWriter destructor, writing out pending output */
+  ~FdWriter() {
+    flush();
+  }
+
+  /* Append text */
+  void append(const char *text, std::size_t length) {
+    buffer.append(text, length);
+
+    if(buffer.size() >= SERVER_BUFFER_SIZE) {
+      flush();
+    }
+  }
+
+  /* Append a number formatted like std::ostream does, and a space */
+  void append(double value) {
+    char number[32];
+    int length = std::snprintf(number, sizeof(number), "%g ", value);
+    append(number, length);
+  }
+
+  /* Write out the pending output */
+  void flush() {
+    std::size_t written = 0;
+
+    while(!failed && written < buffer.size()) {
+      ssize_t count = ::write(fd, buffer.data() + written, buffer.size() - written);
+
+      if(count < 0 && errno == EINTR) {
+        continue;
+      }
+
+      if(count <= 0) {
+        failed = true;
+      } else {
+        written += count;
+      }
+    }
+
+    buffer.clear();
+  }
+
+  /* Check if the output is broken */
+  bool has_error() const {
+    return failed;
+  }
+};
+
+/* Buffered reading of whitespace separated numbers from a file descriptor */
+class FdReader {
+private:
+  /* File descriptor read from */
+  int fd;
+  /* Read buffer, with the unread characters in [pos, len) */
+  std::vector<char> buffer;
+  std::size_t pos = 0, len = 0;
+  /* Characters of the current token, kept to avoid allocations */
+  std::string token;
+  /* Writer flushed before waiting for input, so that a client sees all
+     answers before it has to send more */
+  FdWriter *output;
+
+  /* Refill the buffer, returns false at the end of the input */
+  bool refill() {
+    ssize_t count;
+
+    if(output != nullptr) {
+      output->flush();
+    }
+
+    do {
+      count = ::read(fd, buffer.data(), buffer.size());
+    } while(count < 0 && errno == EINTR);
+
+    pos = 0;
+    len = (count > 0) ? count : 0;
+    return len > 0;
+  }
+
+  static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+  }
+public:
+  /* FdReader constructor, flushing the given writer before waiting */
+  explicit FdReader(int fd, FdWriter *output = nullptr) : fd(fd), buffer(SERVER_BUFFER_SIZE), output(output) {}
+
+  /* Read the next number, returns false at the end of the input. Malformed
+     numbers are read as zero */
+  bool next(double& value) {
+    token.clear();
+
+    /* Skip whitespace, then collect the token, across refills */
+    while(true) {
+      if(pos == len && !refill()) {
+        break;
+      }
+
+      char c = buffer[pos];
+
+      if(is_space(c)) {
+        if(!token.empty()) {
+          break;
+        }
+      } else {
+        token.push_back(c);
+      }
+
+      ++pos;
+    }
+
+    if(token.empty()) {
+      return false;
+    }
+
+    value = std::strtod(token.c_str(), nullptr);
+    return true;
+  }
+};
+
+/* Long-running matrix product service. It reads a stream of jobs, each in
+   the input format of MatrixProduct (s1 s2 s3, then m1 and m2), so jobs need
+   no extra framing, and answers each of them with a line "s1 s3" followed by
+   the rows of the product, printed like MatrixProduct does, or with a line
+   "error: <message>". Jobs with dimensions that are not integers or with
+   more than SERVER_MAX_ENTRIES entries end the stream after their error
+   line. Matrices are kept between jobs and only replaced when
+   the dimensions change, and products go through the blocked kernel into
+   the kept result, so a stream of equally sized jobs does not allocate.
+   Output is flushed whenever reading has to wait for more input */
+class ProductServer {
+private:
+  /* Operands and result, reused between jobs */
+  Matrix m1, m2, m3;
+  /* Number of jobs answered */
+  std::size_t count = 0;
+
+  /* Convert a dimension read from the input, returns false unless it is a
+     non-negative integer. Sizes above SERVER_MAX_ENTRIES are clamped to it
+     plus one, which is too large for a job all the same */
+  static bool dimension(double value, std::size_t& size) {
+    if(!(value >= 0.0) || std::isinf(value) || std::floor(value) != value) {
+      return false;
+    }
+
+    size = (value > (double)SERVER_MAX_ENTRIES) ? SERVER_MAX_ENTRIES + 1 : (std::size_t)value;
+    return true;
+  }
+
+  /* Return a * b, or SERVER_MAX_ENTRIES + 1 if that is more, so that sums
+     of a few of them can not overflow */
+  static std::size_t entries(std::size_t a, std::size_t b) {
+    return (b != 0 && a > SERVER_MAX_ENTRIES / b) ? SERVER_MAX_ENTRIES + 1 : a * b;
+  }
+
+  /* Skip the given number of input entries */
+  static void skip(FdReader& reader, std::size_t count) {
+    double value;
+
+    while(count > 0 && reader.next(value)) {
+      --count;
+    }
+  }
+
+  /* Answer a job with an error line */
+  void reject(FdWriter& writer, const char *message) {
+    writer.append("error: ", 7);
+    writer.append(message, std::strlen(message));
+    writer.append("\n", 1);
+    ++count;
+  }
+
+  /* Make m hold a rows x cols matrix, keeping it if it already does */
+  static void resize(Matrix& m, std::size_t rows, std::size_t cols) {
+    if(m.rows() != rows || m.cols() != cols) {
+      m = Matrix(rows, cols, 0.0);
+    }
+  }
+
+  /* Read the entries of m, returns false if the input ended */
+  static bool read(FdReader& reader, Matrix& m) {
+    double value;
+
+    for(std::size_t i = 0; i < m.rows(); ++i) {
+      for(std::size_t j = 0; j < m.cols(); ++j) {
+        if(!reader.next(value)) {
+          return false;
+        }
+
+        m(i, j) = value;
+      }
+    }
+
+    return true;
+  }
+public:
+  /* ProductServer constructor */
+  ProductServer() : m1(1, 1, 0.0), m2(1, 1, 0.0), m3(1, 1, 0.0) {}
+
+  /* Answer the jobs read from in_fd on out_fd, until the input ends or the
+     output breaks */
+  ProductServer& serve(int in_fd, int out_fd) {
+    FdWriter writer(out_fd);
+    FdReader reader(in_fd, &writer);
+    double dims[3];
+
+    while(!writer.has_error()) {
+      if(!reader.next(dims[0]) || !reader.next(dims[1]) || !reader.next(dims[2])) {
+        break;
+      }
+
+      /* The entries of a job with malformed dimensions can not be told
+         apart from the next job, and skipping those of a too large one
+         could take as long as the job itself, so in both cases the input
+         is not read any further */
+      std::size_t s1, s2, s3;
+
+      if(!dimension(dims[0], s1) || !dimension(dims[1], s2) || !dimension(dims[2], s3)) {
+        reject(writer, "The input dimensions should be non-negative integers!");
+        break;
+      }
+
+      const std::size_t inputs = entries(s1, s2) + entries(s2, s3);
+
+      if(inputs + entries(s1, s3) > SERVER_MAX_ENTRIES) {
+        reject(writer, "The job is too large!");
+        break;
+      }
+
+      /* Jobs with a zero dimension are answered with an error, after
+         skipping whatever entries they have */
+      if(s1 == 0 || s2 == 0 || s3 == 0) {
+        skip(reader, inputs);
+        reject(writer, "None of the input dimensions should be zero!");
+        continue;
+      }
+
+      /* Allocations can still fail when many connections run large jobs */
+      try {
+        resize(m1, s1, s2);
+        resize(m2, s2, s3);
+        resize(m3, s1, s3);
+      } catch(const std::bad_alloc&) {
+        m1 = m2 = m3 = Matrix(1, 1, 0.0);
+        skip(reader, inputs);
+        reject(writer, "Not enough memory for the job!");
+        continue;
+      }
+
+      if(!read(reader, m1) || !read(reader, m2)) {
+        break;
+      }
+
+      m3.gemm(1.0, m1, m2, 0.0);
+
+      /* Header, then the rows of the result */
+      char header[64];
+      int length = std::snprintf(header, sizeof(header), "%zu %zu\n", s1, s3);
+      writer.append(header, length);
+
+      for(std::size_t i = 0; i < s1; ++i) {
+        for(std::size_t j = 0; j < s3; ++j) {
+          writer.append(m3(i, j));
+        }
+
+        writer.append("\n", 1);
+      }
+
+      ++count;
+    }
+
+    writer.flush();
+    return *this;
+  }
+
+  /* Return the number of jobs answered */
+  std::size_t jobs() const {
+    return count;
+  }
+};
+
+/* Listen on the Unix domain socket at path and serve every connection with
+   its own ProductServer on its own thread. Connections beyond the given
+   number served at once are answered with an error line and closed. Only
+   returns if the socket can not be set up, with a message describing why */
+inline std::string serve_socket(const std::string& path, std::size_t max_connections = SERVER_MAX_CONNECTIONS) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+
+  if(path.size() >= sizeof(address.sun_path)) {
+    return "Socket path is too long!";
+  }
+
+  std::strcpy(address.sun_path, path.c_str());
+
+  int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if(listener < 0) {
+    return std::string("Could not create socket: ") + std::strerror(errno);
+  }
+
+  ::unlink(path.c_str());
+
+  if(::bind(listener, (sockaddr *)&address, sizeof(address)) < 0 || ::listen(listener, 16) < 0) {
+    std::string message = std::string("Could not listen on ") + path + ": " + std::strerror(errno);
+    ::close(listener);
+    return message;
+  }
+
+  /* Clients closing their connection early must not end the server */
+  std::signal(SIGPIPE, SIG_IGN);
+
+  /* Shared with the connection threads, which may outlive this function */
+  std::shared_ptr<std::atomic<std::size_t> > active = std::make_shared<std::atomic<std::size_t> >(0);
+
+  while(true) {
+    int connection = ::accept(listener, nullptr, nullptr);
+
+    if(connection < 0) {
+      if(errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+
+      std::string message = std::string("Could not accept connections: ") + std::strerror(errno);
+      ::close(listener);
+      return message;
+    }
+
+    if(active->fetch_add(1) >= max_connections) {
+      --*active;
+      const char message[] = "error: Too many connections!\n";
+      FdWriter(connection).append(message, sizeof(message) - 1);
+      ::close(connection);
+      continue;
+    }
+
+    std::thread([connection, active] () {
+      /* Failures of one connection must not end the server */
+      try {
+        ProductServer().serve(connection, connection);
+      } catch(const std::exception&) {
+      }
+
+      ::close(connection);
+      --*active;
+    }).detach();
+  }
+}
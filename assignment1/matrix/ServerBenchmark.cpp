@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* Load generator for the server mode of MatrixProduct. The same stream of
+   small products is answered once by starting MatrixProduct for every job,
+   and once by a single `MatrixProduct --socket` process serving a number of
+   concurrent clients, each sending its share of the jobs over one
+   connection. The job count, the matrix size and the number of clients can
+   be given as arguments */
+
+using Clock = std::chrono::steady_clock;
+
+double seconds(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+/* Write all of text to fd */
+void write_all(int fd, const std::string& text) {
+  std::size_t written = 0;
+
+  while(written < text.size()) {
+    ssize_t count = ::write(fd, text.data() + written, text.size() - written);
+
+    if(count <= 0) {
+      return;
+    }
+
+    written += count;
+  }
+}
+
+/* Read from fd until the end of the input */
+std::string read_all(int fd) {
+  std::string text;
+  char buffer[4096];
+  ssize_t count;
+
+  while((count = ::read(fd, buffer, sizeof(buffer))) > 0) {
+    text.append(buffer, count);
+  }
+
+  return text;
+}
+
+/* Start MatrixProduct with the given arguments (if any), connecting its standard input
+   and output to the returned descriptors if requested */
+pid_t spawn(const char *argument, const char *value, int *input, int *output) {
+  int in[2], out[2];
+
+  if(::pipe(in) != 0 || ::pipe(out) != 0) {
+    return -1;
+  }
+
+  pid_t pid = ::fork();
+
+  if(pid == 0) {
+    ::dup2(in[0], STDIN_FILENO);
+    ::dup2(out[1], STDOUT_FILENO);
+    ::close(in[0]); ::close(in[1]); ::close(out[0]); ::close(out[1]);
+    ::execl(MATRIX_PRODUCT, MATRIX_PRODUCT, argument, value, (char *)nullptr);
+    ::_exit(127);
+  }
+
+  ::close(in[0]);
+  ::close(out[1]);
+
+  if(input != nullptr) { *input = in[1]; } else { ::close(in[1]); }
+  if(output != nullptr) { *output = out[0]; } else { ::close(out[0]); }
+  return pid;
+}
+
+int main(int argc, char **argv) {
+  const std::size_t jobs = (argc > 1) ? std::stoul(argv[1]) : 200;
+  const std::size_t n = (argc > 2) ? std::stoul(argv[2]) : 8;
+  const std::size_t clients = (argc > 3) ? std::stoul(argv[3]) : 4;
+
+  std::ostringstream generated;
+  generated << n << " " << n << " " << n << "\n";
+
+  for(std::size_t i = 0; i < 2 * n * n; ++i) {
+    generated << std::sin(0.37 * i) * 100. << ((i % n == n - 1) ? "\n" : " ");
+  }
+
+  const std::string job = generated.str();
+  std::cout << jobs << " jobs of " << n << " x " << n << " products" << std::endl;
+
+  std::signal(SIGPIPE, SIG_IGN);
+
+  /* One process per job */
+  {
+    std::size_t bytes = 0;
+    Clock::time_point start = Clock::now();
+
+    for(std::size_t j = 0; j < jobs; ++j) {
+      int input, output;
+      pid_t pid = spawn(nullptr, nullptr, &input, &output);
+      write_all(input, job);
+      ::close(input);
+      bytes += read_all(output).size();
+      ::close(output);
+      ::waitpid(pid, nullptr, 0);
+    }
+
+    double time = seconds(start, Clock::now());
+    std::cout << "process per job: " << time << " s, " << jobs / time << " jobs/s (" << bytes << " bytes of output)" << std::endl;
+  }
+
+  /* One server, the clients send their jobs one after another and wait for
+     each answer, like a request-response client would */
+  {
+    std::string path = "/tmp/ServerBenchmark." + std::to_string(::getpid()) + ".sock";
+    pid_t server = spawn("--socket", path.c_str(), nullptr, nullptr);
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path.c_str());
+
+    /* Wait until the server listens */
+    int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    while(::connect(probe, (sockaddr *)&address, sizeof(address)) < 0) {
+      ::usleep(1000);
+    }
+
+    ::close(probe);
+
+    std::vector<std::size_t> bytes(clients, 0);
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+
+    for(std::size_t c = 0; c < clients; ++c) {
+      threads.emplace_back([&, c] () {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if(::connect(fd, (sockaddr *)&address, sizeof(address)) < 0) {
+          return;
+        }
+
+        char buffer[4096];
+
+        for(std::size_t j = c; j < jobs; j += clients) {
+          write_all(fd, job);
+
+          /* The answer is the header and n lines */
+          std::size_t lines = 0;
+
+          while(lines < n + 1) {
+            ssize_t count = ::read(fd, buffer, sizeof(buffer));
+
+            if(count <= 0) {
+              break;
+            }
+
+            lines += std::count(buffer, buffer + count, '\n');
+            bytes[c] += count;
+          }
+        }
+
+        ::close(fd);
+      });
+    }
+
+    for(std::thread &thread : threads) {
+      thread.join();
+    }
+
+    double time = seconds(start, Clock::now());
+    std::size_t total = 0;
+
+    for(std::size_t b : bytes) {
+      total += b;
+    }
+
+    std::cout << "server, " << clients << " clients: " << time << " s, " << jobs / time << " jobs/s (" << total << " bytes of output)" << std::endl;
+
+    ::kill(server, SIGTERM);
+    ::waitpid(server, nullptr, 0);
+    ::unlink(path.c_str());
+  }
+
+  return 0;
+}
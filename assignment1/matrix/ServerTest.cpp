@@ -0,0 +1,279 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Matrix.h"
+#include "Server.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// the answer of the server for one job: the header, then the sequential result
+std::string expected(const std::string& input) {
+	std::istringstream in(input);
+	size_t s1, s2, s3;
+	in >> s1 >> s2 >> s3;
+	if (s1 * s2 * s3 == 0) {
+		return "error: None of the input dimensions should be zero!\n";
+	}
+	Matrix m1(s1, s2, 0.0), m2(s2, s3, 0.0);
+	in >> m1 >> m2;
+	std::ostringstream out;
+	out << s1 << " " << s3 << "\n" << m1 * m2;
+	return out.str();
+}
+
+std::string generated(size_t s1, size_t s2, size_t s3, double seed) {
+	std::ostringstream out;
+	out << s1 << " " << s2 << " " << s3 << "\n";
+	for (size_t i = 0; i < s1 * s2 + s2 * s3; ++i) {
+		out << std::sin(seed * i) * 100. << ((i % 7 == 6) ? "\n" : "\t");
+	}
+	return out.str();
+}
+
+void write_all(int fd, const std::string& text) {
+	size_t written = 0;
+	while (written < text.size()) {
+		ssize_t count = ::write(fd, text.data() + written, text.size() - written);
+		assert("write succeeded" && count > 0);
+		written += count;
+	}
+}
+
+std::string read_exactly(int fd, size_t length) {
+	std::string text(length, '\0');
+	size_t done = 0;
+	while (done < length) {
+		ssize_t count = ::read(fd, &text[done], length - done);
+		assert("read succeeded" && count > 0);
+		done += count;
+	}
+	return text;
+}
+
+std::string read_all(int fd) {
+	std::string text;
+	char buffer[4096];
+	ssize_t count;
+	while ((count = ::read(fd, buffer, sizeof(buffer))) > 0) {
+		text.append(buffer, count);
+	}
+	return text;
+}
+
+// serve all jobs at once through pipes, like `MatrixProduct --batch < jobs`
+std::string batch(const std::string& jobs, size_t& answered) {
+	int in[2], out[2];
+	assert("pipes created" && ::pipe(in) == 0 && ::pipe(out) == 0);
+	std::thread producer([&] () {
+		write_all(in[1], jobs);
+		::close(in[1]);
+	});
+	std::thread server([&] () {
+		answered = ProductServer().serve(in[0], out[1]).jobs();
+		::close(out[1]);
+	});
+	std::string answers = read_all(out[0]);
+	producer.join();
+	server.join();
+	::close(in[0]);
+	::close(out[0]);
+	return answers;
+}
+
+void test_testcases() {
+	TESTCASE("test_testcases");
+	std::string jobs, answers;
+	size_t count = 0;
+	for (std::string name : { "Square", "NonSquareInt", "NonSquareRandom", "BigMatrix" }) {
+		for (std::string suffix : { ".input.txt", ".input.pretty.txt" }) {
+			std::ifstream file(std::string(TESTCASE_DIR) + "/" + name + suffix);
+			assert("test case file found" && file);
+			std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			jobs += input + "\n";
+			answers += expected(input);
+			++count;
+		}
+	}
+	size_t answered = 0;
+	assert("same output as the sequential program" && batch(jobs, answered) == answers);
+	assert("all jobs answered" && answered == count);
+}
+
+// repeated and changing sizes, and jobs with a zero dimension in between
+void test_mixed() {
+	TESTCASE("test_mixed");
+	std::string jobs, answers;
+	size_t count = 0;
+	for (size_t s1 : { 3, 3, 17, 3, 0, 40, 40, 1 }) {
+		for (size_t s3 : { 5, 0, 5 }) {
+			std::string input = generated(s1, 11, s3, 0.1 * (count + 1));
+			jobs += input;
+			answers += expected(input);
+			++count;
+		}
+	}
+	size_t answered = 0;
+	assert("same output as the sequential program" && batch(jobs, answered) == answers);
+	assert("all jobs answered" && answered == count);
+
+	// an incomplete last job is dropped without an answer
+	std::string truncated = generated(2, 2, 2, 0.5);
+	truncated.resize(truncated.size() / 2);
+	assert("incomplete job dropped" && batch(generated(2, 3, 4, 0.3) + truncated, answered) == expected(generated(2, 3, 4, 0.3)));
+	assert("one job answered" && answered == 1);
+}
+
+// malformed and too large dimensions are answered with an error and end the stream
+void test_limits() {
+	TESTCASE("test_limits");
+	const std::string first = generated(2, 3, 4, 0.3), second = generated(3, 2, 2, 0.4);
+	const std::string malformed = "error: The input dimensions should be non-negative integers!\n";
+	const std::string large = "error: The job is too large!\n";
+	const std::pair<std::string, std::string> jobs[] = {
+		{ "100000 100000 100000", large }, { "1 1e300 1", large }, { "8192 8192 1", large },
+		{ "0 100000 100000", large }, { "2.5 2 2", malformed }, { "-1 2 2", malformed },
+		{ "inf 1 1", malformed }, { "nan 1 1", malformed } };
+	for (const auto& job : jobs) {
+		size_t answered = 0;
+		assert("error answered, then nothing more" && batch(first + job.first + "\n1 2 3 4\n" + second, answered) == expected(first) + job.second);
+		assert("error counted as an answer" && answered == 2);
+	}
+}
+
+// a client waiting for each answer before sending the next job must get it
+void test_interactive() {
+	TESTCASE("test_interactive");
+	int fds[2];
+	assert("socket pair created" && ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+	size_t answered = 0;
+	std::thread server([&] () {
+		answered = ProductServer().serve(fds[1], fds[1]).jobs();
+	});
+	for (size_t job = 0; job < 20; ++job) {
+		std::string input = generated(1 + job % 4, 6, 2 + job % 3, 0.2 * (job + 1));
+		write_all(fds[0], input);
+		std::string answer = expected(input);
+		assert("answer before the next job" && read_exactly(fds[0], answer.size()) == answer);
+	}
+	::shutdown(fds[0], SHUT_WR);
+	server.join();
+	::close(fds[1]);
+	assert("all jobs answered" && answered == 20);
+	assert("nothing else written" && read_all(fds[0]).empty());
+	::close(fds[0]);
+}
+
+// start serve_socket on its own thread, returns the address to connect to
+sockaddr_un start_server(const std::string& path, size_t max_connections) {
+	std::thread([path, max_connections] () {
+		std::string message = serve_socket(path, max_connections);
+		std::cerr << message << std::endl;
+		assert("server running" && false);
+	}).detach();
+
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	std::strcpy(address.sun_path, path.c_str());
+	return address;
+}
+
+int connect_to(const sockaddr_un& address) {
+	int client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	assert("socket created" && client >= 0);
+	int attempts = 0;
+	while (::connect(client, (const sockaddr *)&address, sizeof(address)) < 0) {
+		assert("connected" && ++attempts < 1000);
+		::usleep(1000);
+	}
+	return client;
+}
+
+void test_socket() {
+	TESTCASE("test_socket");
+	std::string path = "/tmp/ServerTest." + std::to_string(::getpid()) + ".sock";
+	sockaddr_un address = start_server(path, SERVER_MAX_CONNECTIONS);
+
+	// two clients at once, each served on its own connection
+	int clients[2];
+	for (int &client : clients) {
+		client = connect_to(address);
+	}
+	std::string first = generated(5, 4, 3, 0.7), second = generated(2, 9, 6, 0.9);
+	write_all(clients[0], first + first);
+	write_all(clients[1], second);
+	::shutdown(clients[1], SHUT_WR);
+	assert("second client answered" && read_all(clients[1]) == expected(second));
+	::shutdown(clients[0], SHUT_WR);
+	assert("first client answered" && read_all(clients[0]) == expected(first) + expected(first));
+	for (int client : clients) {
+		::close(client);
+	}
+	::unlink(path.c_str());
+}
+
+// connections beyond the limit are turned away until one ends
+void test_connections() {
+	TESTCASE("test_connections");
+	std::string path = "/tmp/ServerTest." + std::to_string(::getpid()) + ".limited.sock";
+	sockaddr_un address = start_server(path, 1);
+
+	int first = connect_to(address), second = connect_to(address);
+	assert("second connection turned away" && read_all(second) == "error: Too many connections!\n");
+	::close(second);
+
+	const std::string job = generated(3, 4, 5, 0.6);
+	write_all(first, job);
+	::shutdown(first, SHUT_WR);
+	assert("first connection served" && read_all(first) == expected(job));
+	::close(first);
+
+	// the first connection ends shortly after its answer
+	std::string answer;
+	for (int attempts = 0; answer != expected(job); ++attempts) {
+		assert("served again" && attempts < 1000);
+		::usleep(1000);
+		int third = connect_to(address);
+		// fails if the connection is turned away, which leaves the error as the answer
+		if (::write(third, job.data(), job.size()) < 0) {
+			assert("turned away" && errno == EPIPE);
+		}
+		::shutdown(third, SHUT_WR);
+		answer = read_all(third);
+		::close(third);
+	}
+	::unlink(path.c_str());
+}
+
+int main() {
+	test_testcases();
+	test_mixed();
+	test_limits();
+	test_interactive();
+	test_socket();
+	test_connections();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
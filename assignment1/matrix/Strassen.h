@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include "Gemm.h"
+#include "Matrix.h"
+#include "Workspace.h"
+
+/* Default size up to which the recursion falls back to the blocked kernel,
+   see StrassenBenchmark for finding the crossover on a given machine */
+const std::size_t STRASSEN_DEFAULT_CUTOFF = 512;
+
+/* Copy the h x h block starting at (row, col) of the n x n matrix src into
+   dst, filling the positions outside of src with zeros */
+inline void strassen_copy_block(
+  std::size_t n, const double *src, std::size_t row, std::size_t col,
+  std::size_t h, double *dst) {
+
+  for(std::size_t i = 0; i < h; ++i) {
+    for(std::size_t j = 0; j < h; ++j) {
+      dst[i * h + j] = (row + i < n && col + j < n) ? src[(row + i) * n + col + j] : 0.0;
+    }
+  }
+}
+
+/* Copy the part of the h x h block src that lies inside the n x n matrix dst
+   to position (row, col) */
+inline void strassen_store_block(
+  std::size_t n, double *dst, std::size_t row, std::size_t col,
+  std::size_t h, const double *src) {
+
+  for(std::size_t i = 0; i < h && row + i < n; ++i) {
+    for(std::size_t j = 0; j < h && col + j < n; ++j) {
+      dst[(row + i) * n + col + j] = src[i * h + j];
+    }
+  }
+}
+
+/* z = x + sign * y, for buffers of the given size */
+inline void strassen_add(std::size_t size, const double *x, double sign, const double *y, double *z) {
+  for(std::size_t i = 0; i < size; ++i) {
+    z[i] = x[i] + sign * y[i];
+  }
+}
+
+/* Computes C = A * B for n x n row-major buffers using the Strassen-Winograd
+   recursion (7 block products and 15 block additions per level). Odd sizes
+   are handled by zero padding the blocks to ceil(n / 2) on each level, and
+   blocks of size cutoff or below go to the blocked kernel. Temporaries come
+   from the thread's workspace, so repeated products reuse them */
+inline void strassen_product(std::size_t n, const double *a, const double *b, double *c, std::size_t cutoff) {
+  if(n <= std::max<std::size_t>(cutoff, 1)) {
+    gemm_kernel(n, n, n, 1.0, a, false, b, false, 0.0, c);
+    return;
+  }
+
+  const std::size_t h = (n + 1) / 2;
+  const std::size_t size = h * h;
+  Workspace& workspace = Workspace::local();
+
+  /* Blocks of the operands, the Winograd sums and the seven products */
+  double *block[23];
+  for(double *&buffer : block) {
+    buffer = workspace.acquire(size);
+  }
+
+  double *a11 = block[0], *a12 = block[1], *a21 = block[2], *a22 = block[3];
+  double *b11 = block[4], *b12 = block[5], *b21 = block[6], *b22 = block[7];
+  double *s1 = block[8], *s2 = block[9], *s3 = block[10], *s4 = block[11];
+  double *t1 = block[12], *t2 = block[13], *t3 = block[14], *t4 = block[15];
+  double *p1 = block[16], *p2 = block[17], *p3 = block[18], *p4 = block[19];
+  double *p5 = block[20], *p6 = block[21], *p7 = block[22];
+
+  strassen_copy_block(n, a, 0, 0, h, a11);
+  strassen_copy_block(n, a, 0, h, h, a12);
+  strassen_copy_block(n, a, h, 0, h, a21);
+  strassen_copy_block(n, a, h, h, h, a22);
+  strassen_copy_block(n, b, 0, 0, h, b11);
+  strassen_copy_block(n, b, 0, h, h, b12);
+  strassen_copy_block(n, b, h, 0, h, b21);
+  strassen_copy_block(n, b, h, h, h, b22);
+
+  /* Sums of the blocks of A and B */
+  strassen_add(size, a21, 1.0, a22, s1);
+  strassen_add(size, s1, -1.0, a11, s2);
+  strassen_add(size, a11, -1.0, a21, s3);
+  strassen_add(size, a12, -1.0, s2, s4);
+  strassen_add(size, b12, -1.0, b11, t1);
+  strassen_add(size, b22, -1.0, t1, t2);
+  strassen_add(size, b22, -1.0, b12, t3);
+  strassen_add(size, t2, -1.0, b21, t4);
+
+  /* Block products */
+  strassen_product(h, a11, b11, p1, cutoff);
+  strassen_product(h, a12, b21, p2, cutoff);
+  strassen_product(h, s4, b22, p3, cutoff);
+  strassen_product(h, a22, t4, p4, cutoff);
+  strassen_product(h, s1, t1, p5, cutoff);
+  strassen_product(h, s2, t2, p6, cutoff);
+  strassen_product(h, s3, t3, p7, cutoff);
+
+  /* Combine the products into the blocks of C, reusing their buffers */
+  strassen_add(size, p1, 1.0, p6, p6);  // U2 = P1 + P6
+  strassen_add(size, p6, 1.0, p7, p7);  // U3 = U2 + P7
+  strassen_add(size, p6, 1.0, p5, p6);  // U4 = U2 + P5
+  strassen_add(size, p6, 1.0, p3, p3);  // C12 = U4 + P3
+  strassen_add(size, p7, -1.0, p4, p4); // C21 = U3 - P4
+  strassen_add(size, p7, 1.0, p5, p5);  // C22 = U3 + P5
+  strassen_add(size, p1, 1.0, p2, p1);  // C11 = P1 + P2
+
+  strassen_store_block(n, c, 0, 0, h, p1);
+  strassen_store_block(n, c, 0, h, h, p3);
+  strassen_store_block(n, c, h, 0, h, p4);
+  strassen_store_block(n, c, h, h, h, p5);
+
+  for(double *buffer : block) {
+    workspace.release(buffer, size);
+  }
+}
+
+/* Matrix product through the Strassen-Winograd recursion. Non-square
+   operands are zero padded to a square of their largest dimension. Returns
+   an invalid matrix if the dimensions do not fit, like operator* does */
+inline Matrix strassen(const Matrix& a, const Matrix& b, std::size_t cutoff = STRASSEN_DEFAULT_CUTOFF) {
+  if(a.cols() != b.rows() || a.rows() * a.cols() * b.cols() == 0) {
+    return Matrix(0, 0, 0.0);
+  }
+
+  Matrix result(a.rows(), b.cols(), 0.0);
+  const std::size_t n = std::max(std::max(a.rows(), a.cols()), b.cols());
+
+  /* Square operands are used in place */
+  if(a.rows() == n && a.cols() == n && b.cols() == n) {
+    strassen_product(n, &a(0, 0), &b(0, 0), &result(0, 0), cutoff);
+    return result;
+  }
+
+  /* Otherwise, embed them into zero padded square buffers */
+  Matrix pa(n, n, 0.0), pb(n, n, 0.0), pc(n, n, 0.0);
+
+  for(std::size_t i = 0; i < a.rows(); ++i) {
+    for(std::size_t j = 0; j < a.cols(); ++j) {
+      pa(i, j) = a(i, j);
+    }
+  }
+
+  for(std::size_t i = 0; i < b.rows(); ++i) {
+    for(std::size_t j = 0; j < b.cols(); ++j) {
+      pb(i, j) = b(i, j);
+    }
+  }
+
+  strassen_product(n, &pa(0, 0), &pb(0, 0), &pc(0, 0), cutoff);
+
+  for(std::size_t i = 0; i < result.rows(); ++i) {
+    for(std::size_t j = 0; j < result.cols(); ++j) {
+      result(i, j) = pc(i, j);
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include "Matrix.h"
+#include "Strassen.h"
+
+double measureTime(std::function<void()> toMeasure) {
+  std::chrono::time_point<std::chrono::steady_clock> start, end;
+  start = std::chrono::steady_clock::now();
+  toMeasure();
+  end = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed = end - start;
+  return elapsed.count();
+}
+
+Matrix filled(std::size_t n, double offset) {
+  Matrix m(n, n, 0.0);
+  for(std::size_t i = 0; i < n; ++i) {
+    for(std::size_t j = 0; j < n; ++j) {
+      m(i, j) = std::sin(offset + 0.37 * i + 1.3 * j);
+    }
+  }
+  return m;
+}
+
+/* Compares the blocked kernel with the Strassen-Winograd recursion for
+   several cutoffs, to find the size from which the recursion pays off. The
+   largest size can be given as the first argument */
+int main(int argc, char **argv) {
+  std::size_t max_size = (argc > 1) ? std::stoul(argv[1]) : 1024;
+  const std::size_t cutoffs[] = { 128, 256, 512 };
+
+  std::cout << "n\tkernel[s]";
+  for(std::size_t cutoff : cutoffs) {
+    std::cout << "\tcutoff " << cutoff << "[s]";
+  }
+  std::cout << std::endl;
+
+  for(std::size_t n = 128; n <= max_size; n += n / 2) {
+    Matrix a = filled(n, 0.1), b = filled(n, 0.5), c(n, n, 0.0);
+
+    /* Run once before measuring, so the workspace is warmed up */
+    c = strassen(a, b, cutoffs[0]);
+
+    std::cout << n << "\t" << measureTime([&] { c = a * b; });
+    for(std::size_t cutoff : cutoffs) {
+      std::cout << "\t" << measureTime([&] { c = strassen(a, b, cutoff); });
+    }
+    std::cout << std::endl;
+  }
+
+  return 0;
+}
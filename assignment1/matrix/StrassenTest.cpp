@@ -0,0 +1,95 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cmath>
+#include "Matrix.h"
+#include "Strassen.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// relative comparison, the expected outputs are printed with 6 significant digits
+bool almostEqual(double a, double b, double epsilon) {
+	return std::abs(a - b) <= epsilon * std::max(1.0, std::abs(b));
+}
+
+bool almostEqual(const Matrix& a, const Matrix& b, double epsilon) {
+	if (a.rows() != b.rows() || a.cols() != b.cols()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.rows(); ++i) {
+		for (size_t j = 0; j < a.cols(); ++j) {
+			if (!almostEqual(a(i, j), b(i, j), epsilon)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+Matrix filled(size_t rows, size_t cols, double offset) {
+	Matrix m(rows, cols, 0.0);
+	for (size_t i = 0; i < rows; ++i) {
+		for (size_t j = 0; j < cols; ++j) {
+			m(i, j) = std::sin(offset + 0.37 * i + 1.3 * j);
+		}
+	}
+	return m;
+}
+
+void test_testcases() {
+	TESTCASE("test_testcases");
+	for (std::string name : { "Square", "NonSquareInt", "NonSquareRandom", "BigMatrix" }) {
+		std::ifstream input(std::string(TESTCASE_DIR) + "/" + name + ".input.txt");
+		std::ifstream output(std::string(TESTCASE_DIR) + "/" + name + ".output.txt");
+		assert("test case files found" && input && output);
+
+		size_t s1, s2, s3;
+		input >> s1 >> s2 >> s3;
+		Matrix m1(s1, s2, 0.0), m2(s2, s3, 0.0), expected(s1, s3, 0.0);
+		input >> m1 >> m2;
+		output >> expected;
+
+		for (size_t cutoff : { 1, 2, 3, 64 }) {
+			assert("matches the reference output" && almostEqual(strassen(m1, m2, cutoff), expected, 1e-5));
+		}
+	}
+}
+
+// odd and even sizes, so that both peeling paths are exercised on several levels
+void test_against_kernel() {
+	TESTCASE("test_against_kernel");
+	for (size_t n : { 1, 2, 5, 16, 17, 31, 64, 100, 129 }) {
+		Matrix a = filled(n, n, 0.1);
+		Matrix b = filled(n, n, 0.7);
+		Matrix expected = a * b;
+		for (size_t cutoff : { 1, 4, 16 }) {
+			assert("square product" && almostEqual(strassen(a, b, cutoff), expected, 1e-10));
+		}
+	}
+	Matrix a = filled(37, 11, 0.2);
+	Matrix b = filled(11, 23, 0.4);
+	assert("rectangular product" && almostEqual(strassen(a, b, 4), a * b, 1e-10));
+	assert("dimension check" && strassen(b, b).rows() == 0);
+}
+
+int main() {
+	test_testcases();
+	test_against_kernel();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+/* Default number of elements a workspace keeps in released buffers (128 MiB) */
+constexpr std::size_t WORKSPACE_CAPACITY = std::size_t(1) << 24;
+
+/* Pool of scratch buffers the matrices of a thread draw their storage from.
+   Buffers handed back to the workspace are kept in a free list per size, so
+   code that creates temporaries of the same dimensions over and over (the
+   iterations of a solver, a chain of operators) only touches the heap while
+   the pool warms up. The released buffers are bounded by the capacity: a
+   buffer that does not fit evicts the ones of other sizes, so a long-running
+   process seeing many different sizes only keeps the recent ones */
+class Workspace {
+private:
+  /* Released buffers, indexed by their number of elements */
+  std::unordered_map<std::size_t, std::vector<double *>> free_buffers;
+  /* Number of elements in released buffers, and the most that are kept */
+  std::size_t num_pooled = 0, max_pooled;
+  /* Number of buffers requested from the heap so far */
+  std::size_t num_allocations = 0;
+
+  /* Free the released buffers of all sizes but the given one until a buffer
+     of that size fits */
+  void evict(std::size_t size) {
+    for(auto it = free_buffers.begin(); it != free_buffers.end() && num_pooled + size > max_pooled;) {
+      if(it->first == size) {
+        ++it;
+        continue;
+      }
+
+      for(double *buffer : it->second) {
+        delete[] buffer;
+      }
+
+      num_pooled -= it->first * it->second.size();
+      it = free_buffers.erase(it);
+    }
+  }
+public:
+  /* Workspace constructor, keeping at most capacity elements in released buffers */
+  explicit Workspace(std::size_t capacity = WORKSPACE_CAPACITY) : max_pooled(capacity) {}
+
+  /* The pool owns its buffers, so it can not be copied */
+  Workspace(const Workspace&) = delete;
+  Workspace& operator=(const Workspace&) = delete;
+
+  /* Workspace destructor */
+  ~Workspace() {
+    clear();
+  }
+
+  /* Return a buffer with space for the given number of elements, reusing a
+     released one when available */
+  double *acquire(std::size_t size) {
+    /* Empty matrices have no storage */
+    if(size == 0) {
+      return nullptr;
+    }
+
+    /* Look for a released buffer with the same size */
+    auto it = free_buffers.find(size);
+    if(it != free_buffers.end() && !it->second.empty()) {
+      double *buffer = it->second.back();
+      it->second.pop_back();
+      num_pooled -= size;
+      return buffer;
+    }
+
+    /* Otherwise, fall back to the heap */
+    ++num_allocations;
+    return new double[size];
+  }
+
+  /* Give a buffer obtained from acquire() back to the pool, or to the heap
+     if it does not fit into the capacity */
+  void release(double *buffer, std::size_t size) {
+    if(buffer == nullptr) {
+      return;
+    }
+
+    evict(size);
+
+    if(num_pooled + size > max_pooled) {
+      delete[] buffer;
+      return;
+    }
+
+    free_buffers[size].push_back(buffer);
+    num_pooled += size;
+  }
+
+  /* Make sure that count buffers of the given size can be acquired without
+     touching the heap, as far as they fit into the capacity */
+  void reserve(std::size_t size, std::size_t count) {
+    if(size == 0) {
+      return;
+    }
+
+    evict(size);
+    std::vector<double *>& buffers = free_buffers[size];
+    buffers.reserve(count);
+
+    while(buffers.size() < count && num_pooled + size <= max_pooled) {
+      ++num_allocations;
+      buffers.push_back(new double[size]);
+      num_pooled += size;
+    }
+  }
+
+  /* Free all the buffers currently held by the pool */
+  void clear() {
+    for(auto& entry : free_buffers) {
+      for(double *buffer : entry.second) {
+        delete[] buffer;
+      }
+    }
+
+    free_buffers.clear();
+    num_pooled = 0;
+  }
+
+  /* Return the number of elements currently held in released buffers */
+  std::size_t pooled() const {
+    return num_pooled;
+  }
+
+  /* Return the number of buffers requested from the heap so far */
+  std::size_t allocations() const {
+    return num_allocations;
+  }
+
+  /* Return the workspace of the calling thread. Matrices must not outlive
+     the thread (or, for the main thread, the end of main) that created them */
+  static Workspace& local() {
+    thread_local Workspace workspace;
+    return workspace;
+  }
+};
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include "Matrix.h"
+
+using std::size_t;
+
+// count every request to the global heap, so steady-state loops can be checked
+// for hidden allocations
+static size_t numHeapAllocations = 0;
+
+void* operator new(size_t size) {
+	++numHeapAllocations;
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+	std::free(p);
+}
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+Matrix operator*(const Matrix& m, double factor) {
+	Matrix result(m);
+	for (size_t i = 0; i < m.rows(); ++i) {
+		for (size_t j = 0; j < m.cols(); ++j) {
+			result(i, j) *= factor;
+		}
+	}
+	return result;
+}
+
+// one step of a toy iteration that creates several temporaries per step
+void step(const Matrix& a, const Matrix& x, Matrix& y) {
+	y = a * x + x;
+	y -= x * 0.0 + x;
+	y *= Matrix(x.cols(), x.cols(), 0.5);
+	y += x;
+}
+
+void test_reuse(size_t n = 16) {
+	TESTCASE("test_reuse");
+	Workspace& workspace = Workspace::local();
+	size_t before = workspace.allocations();
+	{
+		Matrix m1(n, n, 1.0);
+	}
+	{
+		Matrix m2(n, n, 2.0);
+	}
+	assert("released buffer is reused" && workspace.allocations() == before + 1);
+
+	workspace.reserve(2 * n, 3);
+	size_t reserved = workspace.allocations();
+	{
+		Matrix m1(2 * n, 1, 0.0), m2(1, 2 * n, 0.0), m3(2, n, 0.0);
+	}
+	assert("reserved buffers are used" && workspace.allocations() == reserved);
+}
+
+void test_steady_state(size_t n = 32, size_t numIterations = 100) {
+	TESTCASE("test_steady_state");
+	Matrix a(n, n, 0.01);
+	Matrix x(n, 4, 1.0);
+	Matrix y(n, 4, 0.0);
+
+	step(a, x, y);
+	Matrix expected = y;
+	// warm up the workspace
+	step(a, x, y);
+
+	size_t heapBefore = numHeapAllocations;
+	size_t poolBefore = Workspace::local().allocations();
+	for (size_t it = 0; it < numIterations; ++it) {
+		step(a, x, y);
+	}
+	assert("no heap allocations in the steady state" && numHeapAllocations == heapBefore);
+	assert("no pool misses in the steady state" && Workspace::local().allocations() == poolBefore);
+	assert("results are unaffected by buffer reuse" && y == expected);
+}
+
+// released buffers are bounded, new sizes evict the old ones
+void test_bounded() {
+	TESTCASE("test_bounded");
+	Workspace workspace(100);
+	for (size_t size = 1; size <= 40; ++size) {
+		workspace.release(workspace.acquire(size), size);
+		assert("within the capacity" && workspace.pooled() <= 100);
+	}
+	assert("latest size kept" && workspace.pooled() >= 40);
+	size_t before = workspace.allocations();
+	workspace.release(workspace.acquire(40), 40);
+	assert("latest size reused" && workspace.allocations() == before);
+	workspace.release(workspace.acquire(200), 200);
+	assert("larger than the capacity" && workspace.pooled() <= 100);
+	workspace.reserve(30, 10);
+	assert("reserve within the capacity" && workspace.pooled() <= 100);
+	workspace.clear();
+	assert("cleared" && workspace.pooled() == 0);
+}
+
+void test_move(size_t rows = 3, size_t cols = 5) {
+	TESTCASE("test_move");
+	Matrix m1(rows, cols, 2.0);
+	const double* buffer = &m1(0, 0);
+	Matrix m2(std::move(m1));
+	assert("move constructor steals the data" && &m2(0, 0) == buffer);
+	assert("moved matrix is empty" && m1.rows() * m1.cols() == 0);
+	Matrix m3(1, 1, 0.0);
+	m3 = std::move(m2);
+	assert("move assignment steals the data" && &m3(0, 0) == buffer);
+	assert("move assignment keeps the dimensions" && m3.rows() == rows && m3.cols() == cols);
+}
+
+int main() {
+	test_reuse();
+	test_steady_state();
+	test_bounded();
+	test_move();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <variant>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Matrix.h"
+#include "Stencil.h"
+#include "BandedMatrix.h"
+#include "CSRMatrix.h"
+
+/* Representations an AutoOperator can choose from, cheapest first */
+enum class OperatorKind {
+  Stencil, Banded, CSR, Dense
+};
+
+/* Operator that stores a square matrix in the cheapest of the available
+   representations. Analyzing a dense matrix scans it once, and picks
+   - a Stencil, if the boundary rows only hold the same diagonal entry and all
+     inner rows hold the same entries on the diagonal and its two neighbours,
+   - a BandedMatrix, if all entries lie within maxBandwidth diagonals of the
+     main diagonal and the band is not much larger than the non-zeros,
+   - a CSRMatrix, if at most a quarter of the entries are non-zero,
+   - the dense Matrix otherwise.
+   Products go to the chosen representation, so solvers taking a MatrixLike
+   get the fast path for matrices assembled as dense ones */
+template<typename T, std::size_t n, std::size_t maxBandwidth = 2>
+class AutoOperator : public MatrixLike<T, AutoOperator<T, n, maxBandwidth>, n, n> {
+private:
+  /* Dense matrices are shared between copies of the operator instead of
+     being copied, as they are the only large representation */
+  using Representation = std::variant<
+    Stencil<T, n, n>,
+    BandedMatrix<T, n, n, maxBandwidth>,
+    CSRMatrix<T, n, n>,
+    std::shared_ptr<const Matrix<T, n, n>>>;
+
+  /* The chosen representation */
+  Representation op;
+
+  /* Return the operator held by an alternative of the representation */
+  template<class Op>
+  static const Op& operand(const Op& o) {
+    return o;
+  }
+
+  template<class Op>
+  static const Op& operand(const std::shared_ptr<const Op>& o) {
+    return *o;
+  }
+
+  /* Check if the matrix matches the Stencil pattern described above */
+  static bool isStencil(const Matrix<T, n, n>& m) {
+    if(n < 3 || m(0, 0) != m(n - 1, n - 1)) {
+      return false;
+    }
+
+    for(std::size_t i = 1; i < n - 1; ++i) {
+      for(int d = -1; d <= 1; ++d) {
+        if(m(i, i + d) != m(1, 1 + d)) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /* Build the Stencil for a matrix passing isStencil. The diagonal entry is
+     kept even if it is zero, the inverse diagonal then has the same infinite
+     entries as the one of the dense matrix */
+  static Stencil<T, n, n> toStencil(const Matrix<T, n, n>& m) {
+    std::vector<StencilEntry<T>> inner;
+
+    for(int d = -1; d <= 1; ++d) {
+      if(d == 0 || m(1, 1 + d) != 0.0) {
+        inner.push_back({ d, m(1, 1 + d) });
+      }
+    }
+
+    return Stencil<T, n, n>({ { 0, m(0, 0) } }, inner);
+  }
+
+  /* Choose the representation of a dense matrix */
+  static Representation analyze(const Matrix<T, n, n>& m) {
+    /* Number of non-zeros, their largest distance to the diagonal, and
+       whether they stay within the stencil pattern */
+    std::size_t nonZeros = 0, bandwidth = 0;
+    bool stencil = true;
+
+    for(std::size_t i = 0; i < n; ++i) {
+      for(std::size_t j = 0; j < n; ++j) {
+        if(m(i, j) != 0.0) {
+          const std::size_t distance = (i > j) ? i - j : j - i;
+          const bool boundary = (i == 0 || i == n - 1);
+
+          ++nonZeros;
+          bandwidth = std::max(bandwidth, distance);
+          stencil = stencil && distance <= (boundary ? 0 : 1);
+        }
+      }
+    }
+
+    if(stencil && isStencil(m)) {
+      return toStencil(m);
+    }
+
+    /* The band also stores zeros, CSR an index for each entry */
+    if(bandwidth <= maxBandwidth && n * (2 * maxBandwidth + 1) <= 2 * nonZeros) {
+      BandedMatrix<T, n, n, maxBandwidth> banded(0.0);
+
+      for(std::size_t i = 0; i < n; ++i) {
+        for(std::size_t j = (i > bandwidth) ? i - bandwidth : 0; j < n && j <= i + bandwidth; ++j) {
+          banded(i, j) = m(i, j);
+        }
+      }
+
+      return banded;
+    }
+
+    if(4 * nonZeros <= n * n) {
+      return CSRMatrix<T, n, n>(m);
+    }
+
+    return std::make_shared<const Matrix<T, n, n>>(m);
+  }
+public:
+  /* AutoOperator constructor, analyzing the given dense matrix */
+  explicit AutoOperator(const Matrix<T, n, n>& m) : op(analyze(m)) {}
+
+  /* AutoOperator constructors, wrapping an operator as it is */
+  explicit AutoOperator(const Stencil<T, n, n>& s) : op(s) {}
+  explicit AutoOperator(const BandedMatrix<T, n, n, maxBandwidth>& b) : op(b) {}
+  explicit AutoOperator(const CSRMatrix<T, n, n>& c) : op(c) {}
+
+  /* AutoOperator destructor */
+  ~AutoOperator() noexcept override {}
+
+  /* Return the chosen representation */
+  OperatorKind kind() const {
+    return static_cast<OperatorKind>(op.index());
+  }
+
+  /* Matrix-Vector product */
+  Vector<T, n> operator *(const Vector<T, n> &v) const {
+    /* Result vector */
+    Vector<T, n> result(0.0);
+    apply(v, result);
+    return result;
+  }
+
+  /* Matrix-Vector product written into an existing vector */
+  void apply(const Vector<T, n> &v, Vector<T, n> &result) const {
+    std::visit([&] (const auto& o) { operand(o).apply(v, result); }, op);
+  }
+
+  /* Returns the inverse diagonal of the matrix, a dense matrix gives a
+     diagonal CSR matrix instead of another dense one */
+  AutoOperator<T, n, maxBandwidth> inverseDiagonal() const {
+    if(auto dense = std::get_if<std::shared_ptr<const Matrix<T, n, n>>>(&op)) {
+      Vector<T, n> d(0.0);
+
+      for(std::size_t i = 0; i < n; ++i) {
+        d(i) = 1.0 / (**dense)(i, i);
+      }
+
+      return AutoOperator<T, n, maxBandwidth>(CSRMatrix<T, n, n>::diagonal(d));
+    }
+
+    return std::visit([] (const auto& o) {
+      return AutoOperator<T, n, maxBandwidth>(operand(o).inverseDiagonal());
+    }, op);
+  }
+
+  /* Return the number of rows */
+  std::size_t rows() const {
+    return n;
+  }
+
+  /* Return the number of columns */
+  std::size_t cols() const {
+    return n;
+  }
+};
@@ -0,0 +1,158 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include "Matrix.h"
+#include "Vector.h"
+#include "AutoOperator.h"
+#include "Jacobi.h"
+
+#define PI 3.141592653589793
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+bool almostEqual(double a, double b, double epsilon = 1e-10) {
+	return std::abs(a - b) <= epsilon * std::max(1.0, std::abs(b));
+}
+
+// the operator and its inverse diagonal agree with the dense matrix
+template<size_t n, size_t bandwidth>
+void checkProducts(const Matrix<double, n, n>& dense, const AutoOperator<double, n, bandwidth>& A) {
+	Vector<double, n> x([] (size_t i) { return std::cos(0.3 * i) + 0.1 * i; });
+	Vector<double, n> ax = A * x, dx = dense * x;
+	Vector<double, n> ix = A.inverseDiagonal() * x, idx = dense.inverseDiagonal() * x;
+	for (size_t i = 0; i < n; ++i) {
+		assert("product matches the dense matrix" && almostEqual(ax(i), dx(i)));
+		assert("inverse diagonal matches the dense matrix" && almostEqual(ix(i), idx(i)));
+	}
+}
+
+// the matrix assembled in testFullMatrix of SolverTest
+template<size_t numPoints>
+void checkPoisson(int expectedIterations) {
+	const double hxSq = 1. / ((numPoints - 1) * (numPoints - 1));
+	std::unique_ptr<Matrix<double, numPoints, numPoints>> A(new Matrix<double, numPoints, numPoints>(0.));
+	(*A)(0, 0) = 1.;
+	for (size_t x = 1; x < numPoints - 1; ++x) {
+		(*A)(x, x - 1) = 1. / hxSq;
+		(*A)(x, x) = -2. / hxSq;
+		(*A)(x, x + 1) = 1. / hxSq;
+	}
+	(*A)(numPoints - 1, numPoints - 1) = 1.;
+
+	AutoOperator<double, numPoints> op(*A);
+	assert("detected as a stencil" && op.kind() == OperatorKind::Stencil);
+	checkProducts(*A, op);
+
+	Vector<double, numPoints> b(0.0), u(0.0), uDense(0.0);
+	for (size_t x = 0; x < numPoints; ++x) {
+		b(x) = sin(2. * PI * (1. + x / (double)(numPoints - 1))) + cos(PI * (x / (double)(numPoints - 1)));
+	}
+	Workspace<double, numPoints> workspace;
+	int iterations = jacobi(op, b, u, workspace);
+	int denseIterations = jacobi(*A, b, uDense, workspace);
+	assert("same iterations as the dense matrix" && iterations == expectedIterations && denseIterations == expectedIterations);
+	for (size_t i = 0; i < numPoints; ++i) {
+		assert("same solution as the dense matrix" && almostEqual(u(i), uDense(i)));
+	}
+
+	// a different last boundary row is not a stencil any more
+	(*A)(numPoints - 1, numPoints - 1) = 2.;
+	AutoOperator<double, numPoints> banded(*A);
+	assert("detected as banded" && banded.kind() == OperatorKind::Banded);
+	checkProducts(*A, banded);
+}
+
+void test_poisson() {
+	TESTCASE("test_poisson");
+	checkPoisson<33>(743);
+	checkPoisson<49>(1676);
+}
+
+void test_structures() {
+	TESTCASE("test_structures");
+	constexpr size_t n = 40;
+
+	// pentadiagonal
+	Matrix<double, n, n> penta(0.0);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = (i > 2 ? i - 2 : 0); j < n && j <= i + 2; ++j) {
+			penta(i, j) = (i == j) ? 10. + i : std::sin(1. + i + 2. * j);
+		}
+	}
+	AutoOperator<double, n> pentaOp(penta);
+	assert("pentadiagonal is banded" && pentaOp.kind() == OperatorKind::Banded);
+	checkProducts(penta, pentaOp);
+
+	// too wide for the band: only tridiagonal operators are stored banded
+	AutoOperator<double, n, 1> pentaSparse(penta);
+	assert("pentadiagonal beyond the bandwidth is sparse" && pentaSparse.kind() == OperatorKind::CSR);
+	checkProducts(penta, pentaSparse);
+
+	// periodic Laplacian, the corner entries spoil the band
+	Matrix<double, n, n> periodic(0.0);
+	for (size_t i = 0; i < n; ++i) {
+		periodic(i, i) = -2.;
+		periodic(i, (i + 1) % n) = 1.;
+		periodic(i, (i + n - 1) % n) = 1.;
+	}
+	AutoOperator<double, n> periodicOp(periodic);
+	assert("periodic Laplacian is sparse" && periodicOp.kind() == OperatorKind::CSR);
+	checkProducts(periodic, periodicOp);
+
+	// dense
+	Matrix<double, n, n> dense(0.0);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			dense(i, j) = (i == j) ? 2. * n : std::cos(0.5 * i + 0.2 * j);
+		}
+	}
+	AutoOperator<double, n> denseOp(dense);
+	assert("dense stays dense" && denseOp.kind() == OperatorKind::Dense);
+	assert("dense inverse diagonal is sparse" && denseOp.inverseDiagonal().kind() == OperatorKind::CSR);
+	checkProducts(dense, denseOp);
+
+	// copies share the dense matrix and stay usable
+	AutoOperator<double, n> copy(denseOp);
+	checkProducts(dense, copy);
+
+	// zero inner diagonal: still a stencil, with the infinite inverse diagonal of the dense matrix
+	Matrix<double, n, n> hollow(0.0);
+	hollow(0, 0) = hollow(n - 1, n - 1) = 1.;
+	for (size_t i = 1; i < n - 1; ++i) {
+		hollow(i, i - 1) = hollow(i, i + 1) = 1.;
+	}
+	AutoOperator<double, n> hollowOp(hollow);
+	assert("zero diagonal stencil" && hollowOp.kind() == OperatorKind::Stencil);
+	Vector<double, n> ones(1.0), ix = hollowOp.inverseDiagonal() * ones, idx = hollow.inverseDiagonal() * ones;
+	assert("boundary inverse diagonal" && ix(0) == 1. && ix(n - 1) == 1.);
+	assert("infinite inner inverse diagonal" && std::isinf(ix(n / 2)) && std::isinf(idx(n / 2)));
+	Stencil<double, n, n> offDiagonal({ { 0, 1. } }, { { -1, 1. },{ 1, 1. } });
+	Vector<double, n> entries(0.0);
+	offDiagonal.inverseDiagonalEntries(entries);
+	assert("stencil without a diagonal entry" && std::isinf(entries(n / 2)) && entries(0) == 1.);
+
+	CSRMatrix<double, n, n> csr(periodic);
+	assert("non-zeros" && csr.nonZeros() == 3 * n && csr(0, n - 1) == 1. && csr(0, 5) == 0.);
+}
+
+int main() {
+	test_poisson();
+	test_structures();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Stencil.h"
+
+/* Matrix whose non-zero entries all lie within the given number of diagonals
+   above and below the main diagonal. Only the band is stored, row by row,
+   so products and direct solves cost O(N * bandwidth) instead of O(N^2) */
+template<typename T, std::size_t nrows, std::size_t ncols, std::size_t bandwidth>
+class BandedMatrix : public MatrixLike<T, BandedMatrix<T, nrows, ncols, bandwidth>, nrows, ncols> {
+private:
+  /* Number of stored entries per row */
+  static constexpr std::size_t width = 2 * bandwidth + 1;
+  /* Band data, entry (i, j) is stored at i * width + (j - i + bandwidth) */
+  std::array<T, nrows * width> data;
+  /* Returned for entries outside of the band */
+  static constexpr T zero = 0.0;
+public:
+  /* BandedMatrix constructor */
+  BandedMatrix(T initValue) {
+    /* Go through the band and fill all the positions with the given initial
+       value, positions outside of the matrix are kept at zero */
+    for(std::size_t i = 0; i < nrows; ++i) {
+      for(std::size_t k = 0; k < width; ++k) {
+        data[i * width + k] = inMatrix(i, k) ? initValue : 0.0;
+      }
+    }
+  }
+
+  /* BandedMatrix constructor, taking the rows of a stencil. Stencil entries
+     that fall outside of the matrix are dropped, offsets wider than the band
+     throw std::invalid_argument, as they would land in the next row */
+  explicit BandedMatrix(const Stencil<T, nrows, ncols>& s) : BandedMatrix(0.0) {
+    for(std::size_t i = 0; i < nrows; ++i) {
+      const auto& entries = (i == 0 || i == nrows - 1) ? s.boundaryEntries() : s.innerEntries();
+
+      for(auto elem : entries) {
+        if((std::size_t)std::abs(elem.first) > bandwidth) {
+          throw std::invalid_argument("Stencil offset exceeds the bandwidth of the matrix");
+        }
+
+        if(inMatrix(i, bandwidth + elem.first)) {
+          data[i * width + bandwidth + elem.first] += elem.second;
+        }
+      }
+    }
+  }
+
+  /* BandedMatrix destructor */
+  ~BandedMatrix() noexcept override {}
+
+  /* Return reference from the specified index, which must lie in the band */
+  T& operator()(std::size_t i, std::size_t j) {
+    assert(inBand(i, j) && "Entry outside of the band");
+    return data[i * width + j + bandwidth - i];
+  }
+
+  /* Return element value from the specified index */
+  const T& operator()(std::size_t i, std::size_t j) const {
+    return inBand(i, j) ? data[i * width + j + bandwidth - i] : zero;
+  }
+
+  /* Check if the entry (i, j) is stored */
+  bool inBand(std::size_t i, std::size_t j) const {
+    return j + bandwidth >= i && j <= i + bandwidth && i < nrows && j < ncols;
+  }
+
+  /* Matrix-Vector product */
+  Vector<T, nrows> operator *(const Vector<T, nrows> &v) const {
+    /* Result vector */
+    Vector<T, nrows> result(0.0);
+    apply(v, result);
+    return result;
+  }
+
+  /* Matrix-Vector product written into an existing vector */
+  void apply(const Vector<T, nrows> &v, Vector<T, nrows> &result) const {
+    for(std::size_t i = 0; i < nrows; ++i) {
+      /* Only go through the columns of the band that lie in the matrix */
+      const std::size_t first = (i > bandwidth) ? i - bandwidth : 0;
+      const std::size_t last = std::min(i + bandwidth + 1, ncols);
+      T sum = 0.0;
+
+      for(std::size_t j = first; j < last; ++j) {
+        sum += data[i * width + j + bandwidth - i] * v(j);
+      }
+
+      result(i) = sum;
+    }
+  }
+
+  /* Returns the inverse diagonal of the matrix */
+  BandedMatrix<T, nrows, ncols, bandwidth> inverseDiagonal() const {
+    /* Result matrix */
+    BandedMatrix<T, nrows, ncols, bandwidth> result(0.0);
+
+    for(std::size_t i = 0; i < nrows; ++i) {
+      result(i, i) = 1.0 / data[i * width + bandwidth];
+    }
+
+    return result;
+  }
+
+  /* Solves A * u = b directly, see BandedLU. Returns false and leaves u
+     alone if the factorization fails */
+  bool solve(const Vector<T, nrows>& b, Vector<T, nrows>& u) const;
+
+  /* Return the band data, row by row */
+  const std::array<T, nrows * width>& values() const {
+    return data;
+  }
+
+  /* Return the number of rows */
+  std::size_t rows() const {
+    return nrows;
+  }
+
+  /* Return the number of columns */
+  std::size_t cols() const {
+    return ncols;
+  }
+
+private:
+  /* Check if position k of the band of row i is inside of the matrix */
+  static bool inMatrix(std::size_t i, std::size_t k) {
+    return i + k >= bandwidth && i + k - bandwidth < ncols;
+  }
+};
+
+/* LU factorization of a banded matrix without pivoting, which keeps the
+   factors inside of the band (for bandwidth 1 this is the Thomas algorithm).
+   The matrix must not need pivoting, as is the case for diagonally dominant
+   and for symmetric definite matrices, a zero pivot is reported by failed().
+   Factorizing costs O(N * bandwidth^2), every solve O(N * bandwidth) */
+template<typename T, std::size_t n, std::size_t bandwidth>
+class BandedLU {
+private:
+  /* L (unit diagonal, below) and U (on and above the diagonal), stored in
+     the band of a single matrix */
+  BandedMatrix<T, n, n, bandwidth> lu;
+  /* Whether a pivot turned out to be zero or not finite */
+  bool singular = false;
+public:
+  /* BandedLU constructor, factorizing the given matrix */
+  BandedLU(const BandedMatrix<T, n, n, bandwidth>& A) : lu(A) {
+    for(std::size_t k = 0; k < n; ++k) {
+      if(lu(k, k) == 0.0 || !std::isfinite(lu(k, k))) {
+        singular = true;
+        return;
+      }
+
+      const std::size_t last = std::min(k + bandwidth + 1, n);
+
+      /* Eliminate the entries below the pivot, within the band */
+      for(std::size_t i = k + 1; i < last; ++i) {
+        const T factor = lu(i, k) / lu(k, k);
+        lu(i, k) = factor;
+
+        for(std::size_t j = k + 1; j < last; ++j) {
+          lu(i, j) -= factor * lu(k, j);
+        }
+      }
+    }
+  }
+
+  /* Check if the factorization failed on a zero pivot, the factors can not
+     be used then */
+  bool failed() const {
+    return singular;
+  }
+
+  /* Solves A * u = b with the stored factors. Returns false and leaves u
+     alone if the factorization failed */
+  bool solve(const Vector<T, n>& b, Vector<T, n>& u) const {
+    if(singular) {
+      return false;
+    }
+
+    /* Forward substitution with L */
+    for(std::size_t i = 0; i < n; ++i) {
+      const std::size_t first = (i > bandwidth) ? i - bandwidth : 0;
+      T sum = b(i);
+
+      for(std::size_t j = first; j < i; ++j) {
+        sum -= lu(i, j) * u(j);
+      }
+
+      u(i) = sum;
+    }
+
+    /* Backward substitution with U */
+    for(std::size_t i = n; i-- > 0;) {
+      const std::size_t last = std::min(i + bandwidth + 1, n);
+      T sum = u(i);
+
+      for(std::size_t j = i + 1; j < last; ++j) {
+        sum -= lu(i, j) * u(j);
+      }
+
+      u(i) = sum / lu(i, i);
+    }
+
+    return true;
+  }
+};
+
+template<typename T, std::size_t nrows, std::size_t ncols, std::size_t bandwidth>
+bool BandedMatrix<T, nrows, ncols, bandwidth>::solve(const Vector<T, nrows>& b, Vector<T, nrows>& u) const {
+  static_assert(nrows == ncols, "Only square matrices can be solved for");
+  return BandedLU<T, nrows, bandwidth>(*this).solve(b, u);
+}
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "BandedMatrix.h"
+#include "Jacobi.h"
+
+#define PI 3.141592653589793
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+double measureTime(std::function<void( )> toMeasure) {
+	std::chrono::time_point<std::chrono::steady_clock> start, end;
+	start = std::chrono::steady_clock::now( );
+	toMeasure( );
+	end = std::chrono::steady_clock::now( );
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count( );
+}
+
+bool almostEqual(double a, double b, double epsilon = 1e-10) {
+	return std::abs(a - b) <= epsilon * std::max(1.0, std::abs(b));
+}
+
+template<size_t numPoints>
+void checkPoisson() {
+	const double hxSq = 1. / ((numPoints - 1) * (numPoints - 1));
+	Stencil<double, numPoints, numPoints> stencil({ { 0, 1. } }, { { -1, 1. / hxSq },{ 0, -2. / hxSq },{ 1, 1. / hxSq } });
+	BandedMatrix<double, numPoints, numPoints, 1> A(stencil);
+
+	Vector<double, numPoints> b(0.0);
+	for (size_t x = 0; x < numPoints; ++x) {
+		b(x) = sin(2. * PI * (1. + x / (double)(numPoints - 1))) + cos(PI * (x / (double)(numPoints - 1)));
+	}
+
+	// products agree with the stencil
+	Vector<double, numPoints> sb = stencil * b, ab = A * b;
+	for (size_t i = 0; i < numPoints; ++i) {
+		assert("banded product matches stencil" && almostEqual(ab(i), sb(i)));
+	}
+
+	Vector<double, numPoints> u(0.0), r(0.0);
+	double time = measureTime([&] { A.solve(b, u); });
+	double res = residual(stencil, b, u, r);
+	std::cout << "\t" << numPoints << " grid points solved in " << time * 1e6 << " microseconds, residual " << res << std::endl;
+	assert("direct solve" && res < 1e-8 * b.l2Norm() / hxSq);
+
+	// the direct solution is the limit of the Jacobi iteration
+	Workspace<double, numPoints> workspace;
+	Vector<double, numPoints> uJacobi(0.0);
+	jacobi(A, b, uJacobi, workspace, 1e-10);
+	for (size_t i = 0; i < numPoints; ++i) {
+		assert("Jacobi converges to the direct solution" && almostEqual(uJacobi(i), u(i), 1e-6));
+	}
+}
+
+void test_poisson() {
+	TESTCASE("test_poisson");
+	checkPoisson<33>();
+	checkPoisson<65>();
+	checkPoisson<193>();
+}
+
+// pentadiagonal system compared against the dense matrix
+void test_bandwidth() {
+	TESTCASE("test_bandwidth");
+	constexpr size_t n = 20;
+	BandedMatrix<double, n, n, 2> A(0.0);
+	Matrix<double, n, n> dense(0.0);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = (i > 2 ? i - 2 : 0); j < n && j <= i + 2; ++j) {
+			double v = (i == j) ? 10. + i : std::sin(1. + i + 2. * j);
+			A(i, j) = v;
+			dense(i, j) = v;
+		}
+	}
+	const auto& constA = A;
+	assert("outside of the band" && constA(0, 5) == 0.0 && !A.inBand(0, 3) && A.inBand(3, 1));
+
+	Vector<double, n> x([] (size_t i) { return std::cos(0.3 * i); });
+	Vector<double, n> ax = A * x, dx = dense * x;
+	for (size_t i = 0; i < n; ++i) {
+		assert("banded product matches dense" && almostEqual(ax(i), dx(i)));
+	}
+
+	Vector<double, n> u(0.0);
+	BandedLU<double, n, 2> lu(A);
+	lu.solve(ax, u);
+	for (size_t i = 0; i < n; ++i) {
+		assert("banded LU solve" && almostEqual(u(i), x(i)));
+	}
+
+	auto invDiag = A.inverseDiagonal();
+	assert("inverse diagonal" && invDiag(3, 3) == 1. / A(3, 3) && invDiag(3, 4) == 0.0);
+	BandedMatrix<double, 4, 4, 1> ones(1.0);
+	Vector<double, 4> rowSums = ones * Vector<double, 4>(1.0);
+	assert("entries outside of the matrix are not stored" && rowSums(0) == 2.0 && rowSums(1) == 3.0 && rowSums(3) == 2.0);
+}
+
+// zero pivots are reported instead of producing inf, offsets wider than the band are rejected
+void test_failure() {
+	TESTCASE("test_failure");
+	constexpr size_t n = 8;
+	BandedMatrix<double, n, n, 1> A(1.0);
+	const Vector<double, n> b(1.0), start(2.0);
+	Vector<double, n> u(start);
+	BandedLU<double, n, 1> lu(A);
+	assert("zero pivot" && lu.failed() && !lu.solve(b, u) && u == start);
+	assert("direct solve fails" && !A.solve(b, u) && u == start);
+
+	for (size_t i = 0; i < n; ++i) {
+		A(i, i) = 3.;
+	}
+	BandedLU<double, n, 1> regular(A);
+	assert("diagonally dominant" && !regular.failed() && regular.solve(b, u) && !(u == start));
+
+	const Stencil<double, n, n> wide({ { 0, 1. } }, { { -2, 1. },{ 0, 4. },{ 2, 1. } });
+	bool rejected = false;
+	try {
+		BandedMatrix<double, n, n, 1> narrow(wide);
+	} catch (const std::invalid_argument&) {
+		rejected = true;
+	}
+	assert("offset wider than the band" && rejected);
+	BandedLU<double, n, 2> wider((BandedMatrix<double, n, n, 2>(wide)));
+	assert("offset within the band" && !wider.failed());
+}
+
+int main() {
+	test_poisson();
+	test_bandwidth();
+	test_failure();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,353 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Stencil.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "Steppable.h"
+#include "Snapshot.h"
+
+/* Preconditioners provide apply(r, z), computing z = M^-1 r. Pointwise ones
+   (where M is diagonal) also provide scale(i), so the solver can fuse their
+   application into its vector updates */
+
+/* Jacobi preconditioner, M = D, built from MatrixLike::inverseDiagonal */
+template<typename T, std::size_t n>
+class JacobiPreconditioner {
+private:
+  /* Inverse diagonal of the operator, stored as a vector */
+  const Vector<T, n>& inverse_diagonal;
+public:
+  static constexpr bool pointwise = true;
+
+  /* The inverse diagonal is usually taken from Workspace::inverseDiagonal,
+     it has to outlive the preconditioner */
+  JacobiPreconditioner(const Vector<T, n>& inverseDiagonal) : inverse_diagonal(inverseDiagonal) {}
+
+  /* Return the scaling applied to element i */
+  T scale(std::size_t i) const {
+    return inverse_diagonal(i);
+  }
+
+  void apply(const Vector<T, n>& r, Vector<T, n>& z) const {
+    for(std::size_t i = 0; i < n; ++i) {
+      z(i) = inverse_diagonal(i) * r(i);
+    }
+  }
+};
+
+/* Symmetric successive over-relaxation preconditioner for stencils,
+   M = w / (2 - w) * (D / w + L) (D / w)^-1 (D / w + U), applied as a forward
+   and a backward sweep over the stencil entries */
+template<typename T, std::size_t n>
+class SSORPreconditioner {
+private:
+  /* Stencil entries of the first/last and of the inner rows */
+  std::vector<StencilEntry<T> > boundary, inner;
+  /* Diagonal coefficients of the first/last and of the inner rows */
+  T boundary_diagonal, inner_diagonal;
+  /* Relaxation factor */
+  T omega;
+
+  /* Return the entries applied to row i */
+  const std::vector<StencilEntry<T> >& entries(std::size_t i) const {
+    return (i == 0 || i == n - 1) ? boundary : inner;
+  }
+
+  /* Return the diagonal coefficient of row i */
+  T diagonal(std::size_t i) const {
+    return (i == 0 || i == n - 1) ? boundary_diagonal : inner_diagonal;
+  }
+public:
+  static constexpr bool pointwise = false;
+
+  SSORPreconditioner(const Stencil<T, n, n>& A, T omega = 1.0) : omega(omega) {
+    /* Split the entries into the diagonal and the off-diagonal ones */
+    boundary_diagonal = inner_diagonal = 0.0;
+
+    for(auto elem : A.boundaryEntries()) {
+      if(elem.first == 0) {
+        boundary_diagonal += elem.second;
+      } else {
+        boundary.push_back(elem);
+      }
+    }
+
+    for(auto elem : A.innerEntries()) {
+      if(elem.first == 0) {
+        inner_diagonal += elem.second;
+      } else {
+        inner.push_back(elem);
+      }
+    }
+  }
+
+  void apply(const Vector<T, n>& r, Vector<T, n>& z) const {
+    /* Forward sweep, solving (D / w + L) y = r, y is kept in z */
+    for(std::size_t i = 0; i < n; ++i) {
+      T sum = r(i);
+
+      for(auto elem : entries(i)) {
+        if(elem.first < 0) {
+          sum -= elem.second * z(i + elem.first);
+        }
+      }
+
+      z(i) = sum * omega / diagonal(i);
+    }
+
+    /* Scale with D / w, then backward sweep solving (D / w + U) z = D / w y,
+       including the (2 - w) / w factor of M^-1 */
+    const T factor = (2.0 - omega) / omega;
+
+    for(std::size_t i = n; i-- > 0;) {
+      T sum = z(i) * diagonal(i) / omega * factor;
+
+      for(auto elem : entries(i)) {
+        if(elem.first > 0) {
+          sum -= elem.second * z(i + elem.first);
+        }
+      }
+
+      z(i) = sum * omega / diagonal(i);
+    }
+  }
+};
+
+/* Resumable preconditioned conjugate gradient solver, drawing all of its
+   temporaries from the given workspace, see Steppable. Per iteration, it
+   takes one operator application and three passes over the vectors: the
+   p * Ap reduction, the update of u and r (fused with the preconditioner and
+   both reductions for pointwise preconditioners) and the update of the
+   search direction. The operator has to be symmetric and definite (positive
+   or negative, like the preconditioner) apart from rows that only have a
+   diagonal entry. A, b, u and the workspace have to outlive the stepper, and
+   the workspace must not be used by other solves in the meantime. Solves
+   until the residual is reduced by the given factor, recording the residuals
+   and the phases in the telemetry if one is given. Its state is u, r, z and
+   p with r * z and the residual norms */
+template<typename T, class MatrixImpl, std::size_t n, class Preconditioner = JacobiPreconditioner<T, n>>
+class CGStepper : public Steppable, public Checkpointable {
+private:
+  /* Problem, preconditioner and scratch storage */
+  const MatrixLike<T, MatrixImpl, n, n>& A;
+  const Vector<T, n>& b;
+  Vector<T, n>& u;
+  Workspace<T, n>& workspace;
+  Preconditioner M;
+  double tolerance;
+  SolverTelemetry *telemetry;
+  /* Initial and current residual norm, r * z, and the iterations done */
+  double initRes = 0.0, curRes = 0.0, rz = 0.0;
+  unsigned int curIt = 0;
+  bool started = false;
+
+  /* Set up the residual and the first search direction */
+  void start() {
+    TELEMETRY(telemetry, begin("setup"));
+    Vector<T, n>& r = workspace.vector(0);
+    Vector<T, n>& z = workspace.vector(1);
+    Vector<T, n>& p = workspace.vector(2);
+    workspace.reserve(4);
+
+    initRes = residual(A, b, u, r); // determine the initial residual
+
+    /* Rows that only have a diagonal entry, like Dirichlet boundaries, make the
+       operator nonsymmetric. A Jacobi step satisfies them exactly, after which
+       the iteration stays in the symmetric part coupling the remaining rows */
+    const Vector<T, n>& invDiag = workspace.inverseDiagonal(A);
+
+    for(std::size_t i = 0; i < n; ++i) {
+      u(i) += invDiag(i) * r(i);
+    }
+
+    curRes = residual(A, b, u, r);
+
+    M.apply(r, z);
+
+    for(std::size_t i = 0; i < n; ++i) {
+      p(i) = z(i);
+      rz += r(i) * z(i);
+    }
+
+    started = true;
+    TELEMETRY(telemetry, end("setup", 0, curRes));
+  }
+public:
+  /* CGStepper constructor, the work starts with the first step */
+  CGStepper(
+    const MatrixLike<T, MatrixImpl, n, n>& A,
+    const Vector<T, n>& b,
+    Vector<T, n>& u,
+    Workspace<T, n>& workspace,
+    const Preconditioner& M,
+    double tolerance = 1.e-5,
+    SolverTelemetry *telemetry = nullptr)
+    : A(A), b(b), u(u), workspace(workspace), M(M), tolerance(tolerance), telemetry(telemetry) {}
+
+  /* CGStepper constructor with the Jacobi preconditioner, taking the
+     inverse diagonal from the workspace */
+  CGStepper(
+    const MatrixLike<T, MatrixImpl, n, n>& A,
+    const Vector<T, n>& b,
+    Vector<T, n>& u,
+    Workspace<T, n>& workspace,
+    double tolerance = 1.e-5,
+    SolverTelemetry *telemetry = nullptr)
+    : A(A), b(b), u(u), workspace(workspace), M(workspace.inverseDiagonal(A)), tolerance(tolerance), telemetry(telemetry) {}
+
+  bool step(unsigned int count) override {
+    if(!started) {
+      start();
+    }
+
+    Vector<T, n>& r = workspace.vector(0);
+    Vector<T, n>& z = workspace.vector(1);
+    Vector<T, n>& p = workspace.vector(2);
+    Vector<T, n>& q = workspace.vector(3);
+
+    TELEMETRY(telemetry, begin("iterate", curIt));
+
+    for(unsigned int k = 0; k < count && !converged() && !failed(); ++k) {
+      ++curIt;
+
+      A.apply(p, q);
+
+      double pq = 0.0;
+
+      for(std::size_t i = 0; i < n; ++i) {
+        pq += p(i) * q(i);
+      }
+
+      const double alpha = rz / pq;
+      double rzNew = 0.0, rr = 0.0;
+
+      if constexpr (Preconditioner::pointwise) {
+        /* Update, preconditioning and both reductions in a single pass */
+        for(std::size_t i = 0; i < n; ++i) {
+          u(i) += alpha * p(i);
+          r(i) -= alpha * q(i);
+          z(i) = M.scale(i) * r(i);
+          rzNew += r(i) * z(i);
+          rr += r(i) * r(i);
+        }
+      } else {
+        for(std::size_t i = 0; i < n; ++i) {
+          u(i) += alpha * p(i);
+          r(i) -= alpha * q(i);
+          rr += r(i) * r(i);
+        }
+
+        M.apply(r, z);
+
+        for(std::size_t i = 0; i < n; ++i) {
+          rzNew += r(i) * z(i);
+        }
+      }
+
+      curRes = sqrt(rr); // update the residual
+      TELEMETRY(telemetry, residual(curIt, curRes));
+
+      const double beta = rzNew / rz;
+      rz = rzNew;
+
+      for(std::size_t i = 0; i < n; ++i) {
+        p(i) = z(i) + beta * p(i);
+      }
+    }
+
+    TELEMETRY(telemetry, end("iterate", curIt, curRes));
+    return converged();
+  }
+
+  bool converged() const override {
+    return started && curRes <= tolerance * initRes;
+  }
+
+  unsigned int iterations() const override {
+    return curIt;
+  }
+
+  bool failed() const override {
+    return started && !std::isfinite(curRes);
+  }
+
+  /* Return the current residual norm */
+  double residualNorm() const {
+    return curRes;
+  }
+
+  SolverSnapshot snapshot() const override {
+    SolverSnapshot state;
+    state.solver = "cg";
+    state.iterations = curIt;
+    state.problem = problemHash(A, b);
+    state.scalars = { initRes, curRes, rz };
+    state.addVector(u);
+
+    for(std::size_t k = 0; k < 3; ++k) {
+      state.addVector(workspace.vector(k));
+    }
+
+    return state;
+  }
+
+  bool resume(const SolverSnapshot& state) override {
+    if(!state.matches("cg", problemHash(A, b), 3, 4, n)) {
+      return false;
+    }
+
+    state.copyVector(0, u);
+
+    for(std::size_t k = 0; k < 3; ++k) {
+      state.copyVector(k + 1, workspace.vector(k));
+    }
+
+    workspace.reserve(4);
+    curIt = state.iterations;
+    initRes = state.scalars[0];
+    curRes = state.scalars[1];
+    rz = state.scalars[2];
+    started = true;
+    return true;
+  }
+};
+
+/* Preconditioned conjugate gradient solver, drawing all of its temporaries
+   from the given workspace, see CGStepper. Solves until the residual is
+   reduced by the given factor and returns the number of iterations required,
+   or SOLVE_FAILED if that takes more than maxIterations */
+template<typename T, class MatrixImpl, std::size_t n, class Preconditioner>
+unsigned int pcg(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n>& b,
+  Vector<T, n>& u,
+  Workspace<T, n>& workspace,
+  const Preconditioner& M,
+  double tolerance = 1.e-5,
+  SolverTelemetry *telemetry = nullptr,
+  unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+
+  CGStepper<T, MatrixImpl, n, Preconditioner> stepper(A, b, u, workspace, M, tolerance, telemetry);
+  return solveSteps(stepper, maxIterations);
+}
+
+/* Conjugate gradient solver with the Jacobi preconditioner, taking the
+   inverse diagonal from the workspace */
+template<typename T, class MatrixImpl, std::size_t n>
+unsigned int pcg(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n>& b,
+  Vector<T, n>& u,
+  Workspace<T, n>& workspace,
+  double tolerance = 1.e-5,
+  SolverTelemetry *telemetry = nullptr,
+  unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+
+  CGStepper<T, MatrixImpl, n> stepper(A, b, u, workspace, tolerance, telemetry);
+  return solveSteps(stepper, maxIterations);
+}
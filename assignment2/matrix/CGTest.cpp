@@ -0,0 +1,126 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "CG.h"
+#include "TestProblems.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// jacobiIts is the iteration count of the plain Jacobi solver (see SolverTest)
+template<size_t numPoints>
+void checkPoisson(unsigned int jacobiIts) {
+	const auto b = rhs<numPoints>();
+	const auto A = poissonStencil<numPoints>();
+	Workspace<double, numPoints> workspace;
+
+	Vector<double, numPoints> u(0.0);
+	unsigned int jacobiPcgIts = pcg(A, b, u, workspace);
+	checkConverged(A, b, u, 2.e-5);
+
+	u = Vector<double, numPoints>(0.0);
+	SSORPreconditioner<double, numPoints> ssor(A, 1.9);
+	unsigned int ssorPcgIts = pcg(A, b, u, workspace, ssor);
+	checkConverged(A, b, u, 2.e-5);
+
+	std::cout << "\t" << numPoints << " grid points: Jacobi " << jacobiIts << ", PCG (Jacobi) " << jacobiPcgIts
+	          << ", PCG (SSOR) " << ssorPcgIts << " iterations" << std::endl;
+	assert("CG terminates within the problem size" && jacobiPcgIts <= numPoints);
+	assert("SSOR preconditioning takes O(sqrt(N)) iterations" && ssorPcgIts * ssorPcgIts <= 2 * numPoints);
+	assert("far fewer iterations than Jacobi" && 20 * jacobiPcgIts < jacobiIts);
+}
+
+void test_poisson() {
+	TESTCASE("test_poisson");
+	checkPoisson<33>(743);
+	checkPoisson<49>(1676);
+	checkPoisson<65>(2982);
+	checkPoisson<113>(9142);
+	checkPoisson<129>(11941);
+	checkPoisson<193>(26874);
+}
+
+void test_full_matrix() {
+	TESTCASE("test_full_matrix");
+	constexpr size_t numPoints = 65;
+	const double hxSq = 1. / ((numPoints - 1) * (numPoints - 1));
+	Matrix<double, numPoints, numPoints> A(0.);
+	A(0, 0) = 1.;
+	for (size_t x = 1; x < numPoints - 1; ++x) {
+		A(x, x - 1) = 1. / hxSq;
+		A(x, x) = -2. / hxSq;
+		A(x, x + 1) = 1. / hxSq;
+	}
+	A(numPoints - 1, numPoints - 1) = 1.;
+
+	const auto b = rhs<numPoints>();
+	Workspace<double, numPoints> workspace;
+	Vector<double, numPoints> u(0.0), uStencil(0.0);
+	unsigned int numIts = pcg(A, b, u, workspace);
+	unsigned int numItsStencil = pcg(poissonStencil<numPoints>(), b, uStencil, workspace);
+	checkConverged(A, b, u, 2.e-5);
+	assert("matrix and stencil agree" && numIts == numItsStencil);
+}
+
+// SPD operator without boundary rows, preconditioned with the exact inverse
+void test_spd() {
+	TESTCASE("test_spd");
+	constexpr size_t n = 8;
+	Matrix<double, n, n> A(0.);
+	for (size_t i = 0; i < n; ++i) {
+		A(i, i) = 2. + i;
+	}
+	Vector<double, n> b([] (size_t i) { return 1. + i; });
+	Vector<double, n> u(0.0);
+	Workspace<double, n> workspace;
+	unsigned int numIts = pcg(A, b, u, workspace);
+	assert("diagonal system is solved by the preconditioner" && numIts <= 1);
+	for (size_t i = 0; i < n; ++i) {
+		assert("diagonal solution" && std::abs(u(i) - (1. + i) / (2. + i)) < 1e-12);
+	}
+}
+
+// solves that do not converge within the limit, or break down, are reported as failed
+void test_failure() {
+	TESTCASE("test_failure");
+	constexpr size_t n = 65;
+	const auto A = poissonStencil<n>();
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+	Vector<double, n> u(0.0);
+	assert("limit reached" && pcg(A, b, u, workspace, 1.e-5, nullptr, 5) == SOLVE_FAILED);
+
+	// a residual that is not finite never counts as converged
+	Vector<double, n> nan(b);
+	nan(n / 2) = std::nan("");
+	u = Vector<double, n>(0.0);
+	CGStepper<double, Stencil<double, n, n>, n> stepper(A, nan, u, workspace);
+	assert("not converged" && !stepper.step(STEP_ALL) && stepper.failed() && stepper.iterations() == 0);
+	u = Vector<double, n>(0.0);
+	assert("reported as failed" && pcg(A, nan, u, workspace) == SOLVE_FAILED);
+}
+
+int main() {
+	test_poisson();
+	test_full_matrix();
+	test_spd();
+	test_failure();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
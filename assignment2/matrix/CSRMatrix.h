@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Matrix.h"
+
+/* Sparse matrix in compressed sparse row format: the non-zero entries are
+   stored row by row together with their column index, and the entries of row
+   i are found at positions rowStart[i] to rowStart[i + 1] - 1. Products cost
+   O(number of non-zeros) */
+template<typename T, std::size_t nrows, std::size_t ncols>
+class CSRMatrix : public MatrixLike<T, CSRMatrix<T, nrows, ncols>, nrows, ncols> {
+private:
+  /* Position of the first entry of each row, plus the total count */
+  std::vector<std::size_t> rowStart;
+  /* Column index and value of each entry */
+  std::vector<std::size_t> columns;
+  std::vector<T> values;
+public:
+  /* CSRMatrix constructor, creating a matrix without entries */
+  CSRMatrix() : rowStart(nrows + 1, 0) {}
+
+  /* CSRMatrix constructor, storing the non-zero entries of a dense matrix */
+  explicit CSRMatrix(const Matrix<T, nrows, ncols>& m) : rowStart(nrows + 1, 0) {
+    for(std::size_t i = 0; i < nrows; ++i) {
+      for(std::size_t j = 0; j < ncols; ++j) {
+        if(m(i, j) != 0.0) {
+          columns.push_back(j);
+          values.push_back(m(i, j));
+        }
+      }
+
+      rowStart[i + 1] = values.size();
+    }
+  }
+
+  /* CSRMatrix constructor, taking the row starts (nrows + 1 of them, the
+     last one the number of entries) and the column index and value of each
+     entry */
+  CSRMatrix(std::vector<std::size_t> rowStart, std::vector<std::size_t> columns, std::vector<T> values)
+    : rowStart(std::move(rowStart)), columns(std::move(columns)), values(std::move(values)) {
+    assert(this->rowStart.size() == nrows + 1 && this->rowStart[nrows] == this->values.size() && "Row starts do not match");
+    assert(this->columns.size() == this->values.size() && "One column index per entry");
+  }
+
+  /* CSRMatrix destructor */
+  ~CSRMatrix() noexcept override {}
+
+  /* Return a square matrix with the given diagonal */
+  static CSRMatrix<T, nrows, ncols> diagonal(const Vector<T, nrows>& d) {
+    static_assert(nrows == ncols, "Only square matrices have a diagonal operator");
+
+    CSRMatrix<T, nrows, ncols> result;
+    result.columns.resize(nrows);
+    result.values.resize(nrows);
+
+    for(std::size_t i = 0; i < nrows; ++i) {
+      result.rowStart[i + 1] = i + 1;
+      result.columns[i] = i;
+      result.values[i] = d(i);
+    }
+
+    return result;
+  }
+
+  /* Return element value from the specified index, zero if not stored */
+  T operator()(std::size_t i, std::size_t j) const {
+    for(std::size_t k = rowStart[i]; k < rowStart[i + 1]; ++k) {
+      if(columns[k] == j) {
+        return values[k];
+      }
+    }
+
+    return 0.0;
+  }
+
+  /* Matrix-Vector product */
+  Vector<T, nrows> operator *(const Vector<T, nrows> &v) const {
+    /* Result vector */
+    Vector<T, nrows> result(0.0);
+    apply(v, result);
+    return result;
+  }
+
+  /* Matrix-Vector product written into an existing vector */
+  void apply(const Vector<T, nrows> &v, Vector<T, nrows> &result) const {
+    for(std::size_t i = 0; i < nrows; ++i) {
+      T sum = 0.0;
+
+      for(std::size_t k = rowStart[i]; k < rowStart[i + 1]; ++k) {
+        sum += values[k] * v(columns[k]);
+      }
+
+      result(i) = sum;
+    }
+  }
+
+  /* Returns the inverse diagonal of the matrix */
+  CSRMatrix<T, nrows, ncols> inverseDiagonal() const {
+    Vector<T, nrows> d(0.0);
+
+    for(std::size_t i = 0; i < nrows; ++i) {
+      const T diag = (*this)(i, i);
+      assert(diag != 0.0 && "Zero on the diagonal");
+      d(i) = 1.0 / diag;
+    }
+
+    return diagonal(d);
+  }
+
+  /* Return the position of the first entry of each row, plus the count */
+  const std::vector<std::size_t>& rowStarts() const {
+    return rowStart;
+  }
+
+  /* Return the column index of each entry */
+  const std::vector<std::size_t>& columnIndices() const {
+    return columns;
+  }
+
+  /* Return the value of each entry */
+  const std::vector<T>& entries() const {
+    return values;
+  }
+
+  /* Return the number of stored entries */
+  std::size_t nonZeros() const {
+    return values.size();
+  }
+
+  /* Return the number of rows */
+  std::size_t rows() const {
+    return nrows;
+  }
+
+  /* Return the number of columns */
+  std::size_t cols() const {
+    return ncols;
+  }
+};
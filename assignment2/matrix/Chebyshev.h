@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cmath>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "Spectrum.h"
+#include "Steppable.h"
+#include "Snapshot.h"
+#include "Telemetry.h"
+
+/* Resumable Chebyshev accelerated Jacobi solver drawing all of its
+   temporaries from the given workspace, see Steppable. Each iteration is a
+   Jacobi step whose corrections are combined by the three-term recurrence of
+   the Chebyshev polynomials for the interval holding the spectrum of D^-1 A,
+   which takes about sqrt(condition number) iterations instead of the
+   condition number of plain Jacobi. Like Jacobi, it only needs A * u and the
+   inverse diagonal: the residual norm of the stopping test is its only
+   reduction, there are no dot products in the recurrence. The bounds are
+   either given, in which case the largest eigenvalue must not be
+   underestimated, or estimated on the first step with Lanczos steps (see
+   tuneRelaxation). Given bounds that do not satisfy 0 < min <= max are
+   replaced by estimated ones, and if those do not either, as for
+   indefinite operators, the solve fails without iterating. A, b, u and the
+   workspace have to outlive the stepper, and the workspace must not be used
+   by other solves in the meantime.
+   Solves until the residual is reduced by the given factor, recording the
+   residuals and the phases in the telemetry if one is given. Its state is u
+   and the update with the bounds, the recurrence coefficients and the
+   residual norms, the residual is recomputed on resume */
+template<typename T, class MatrixImpl, std::size_t n>
+class ChebyshevStepper : public Steppable, public Checkpointable {
+private:
+  /* Problem and scratch storage */
+  const MatrixLike<T, MatrixImpl, n, n>& A;
+  const Vector<T, n>& b;
+  Vector<T, n>& u;
+  Workspace<T, n>& workspace;
+  double tolerance;
+  SolverTelemetry *telemetry;
+  /* Bounds of the spectrum of D^-1 A, and whether they still have to be estimated */
+  SpectralBounds bounds;
+  bool estimate;
+  /* Inverse diagonal, residual and update, taken from the workspace on the first step */
+  const Vector<T, n> *invDiag = nullptr;
+  Vector<T, n> *r = nullptr;
+  Vector<T, n> *d = nullptr;
+  /* Center and half width of the interval, and the recurrence coefficient */
+  double theta = 0.0, delta = 0.0, rho = 0.0;
+  /* Initial and current residual norm, and the iterations done */
+  double initRes = 0.0, curRes = 0.0;
+  unsigned int curIt = 0;
+
+  /* Check if the bounds give a Chebyshev interval, 0 < min <= max */
+  static bool validBounds(const SpectralBounds& bounds) {
+    return bounds.min > 0.0 && bounds.min <= bounds.max && std::isfinite(bounds.max);
+  }
+
+  /* Take the storage from the workspace and start the recurrence */
+  void setup() {
+    TELEMETRY(telemetry, begin("setup"));
+
+    if(estimate || !validBounds(bounds)) {
+      bounds = tuneRelaxation(A, workspace).chebyshev;
+      estimate = false;
+    }
+
+    theta = 0.5 * (bounds.max + bounds.min);
+    delta = 0.5 * (bounds.max - bounds.min);
+    rho = delta / theta;
+
+    invDiag = &workspace.inverseDiagonal(A);
+    r = &workspace.vector(0);
+    d = &workspace.vector(1);
+    initRes = residual(A, b, u, *r); // determine the initial residual
+    curRes = initRes;
+
+    /* Without an interval, the residual stands for the breakdown */
+    if(!validBounds(bounds)) {
+      curRes = std::nan("");
+    }
+
+    /* The first update is the Jacobi step for the center of the interval */
+    for(std::size_t i = 0; i < n; ++i) {
+      (*d)(i) = (*invDiag)(i) * (*r)(i) / theta;
+    }
+
+    TELEMETRY(telemetry, end("setup", 0, curRes));
+  }
+public:
+  /* ChebyshevStepper constructor for given bounds of the spectrum of D^-1 A,
+     the work starts with the first step */
+  ChebyshevStepper(
+    const MatrixLike<T, MatrixImpl, n, n>& A,
+    const Vector<T, n>& b,
+    Vector<T, n>& u,
+    Workspace<T, n>& workspace,
+    const SpectralBounds& bounds,
+    double tolerance = 1.e-5,
+    SolverTelemetry *telemetry = nullptr)
+    : A(A), b(b), u(u), workspace(workspace), tolerance(tolerance), telemetry(telemetry), bounds(bounds), estimate(false) {}
+
+  /* ChebyshevStepper constructor, estimating the bounds on the first step */
+  ChebyshevStepper(
+    const MatrixLike<T, MatrixImpl, n, n>& A,
+    const Vector<T, n>& b,
+    Vector<T, n>& u,
+    Workspace<T, n>& workspace,
+    double tolerance = 1.e-5,
+    SolverTelemetry *telemetry = nullptr)
+    : A(A), b(b), u(u), workspace(workspace), tolerance(tolerance), telemetry(telemetry), bounds{ 0.0, 0.0 }, estimate(true) {}
+
+  bool step(unsigned int count) override {
+    if(r == nullptr) {
+      setup();
+    }
+
+    TELEMETRY(telemetry, begin("iterate", curIt));
+
+    const Vector<T, n>& invD = *invDiag;
+    Vector<T, n>& res = *r;
+    Vector<T, n>& upd = *d;
+
+    for(unsigned int k = 0; k < count && !converged() && !failed(); ++k) {
+      ++curIt;
+
+      for(std::size_t i = 0; i < n; ++i) {
+        u(i) += upd(i);
+      }
+
+      curRes = residual(A, b, u, res); // update the residual
+      TELEMETRY(telemetry, residual(curIt, curRes));
+
+      /* Next update from the Chebyshev recurrence, which becomes the Jacobi
+         step for the center as the interval shrinks to a point */
+      const double nextRho = 1.0 / (2.0 * theta / delta - rho);
+      const double previous = nextRho * rho, current = (delta > 0.0) ? 2.0 * nextRho / delta : 1.0 / theta;
+
+      for(std::size_t i = 0; i < n; ++i) {
+        upd(i) = previous * upd(i) + current * invD(i) * res(i);
+      }
+
+      rho = nextRho;
+    }
+
+    TELEMETRY(telemetry, end("iterate", curIt, curRes));
+    return converged();
+  }
+
+  bool converged() const override {
+    return r != nullptr && curRes <= tolerance * initRes;
+  }
+
+  unsigned int iterations() const override {
+    return curIt;
+  }
+
+  bool failed() const override {
+    return r != nullptr && !std::isfinite(curRes);
+  }
+
+  /* Return the bounds in use, the estimated ones after the first step */
+  const SpectralBounds& spectralBounds() const {
+    return bounds;
+  }
+
+  /* Return the current residual norm */
+  double residualNorm() const {
+    return curRes;
+  }
+
+  SolverSnapshot snapshot() const override {
+    SolverSnapshot state;
+    state.solver = "chebyshev";
+    state.iterations = curIt;
+    state.problem = problemHash(A, b);
+    state.scalars = { initRes, curRes, theta, delta, rho, bounds.min, bounds.max };
+    state.addVector(u);
+    state.addVector(workspace.vector(1));
+    return state;
+  }
+
+  bool resume(const SolverSnapshot& state) override {
+    if(!state.matches("chebyshev", problemHash(A, b), 7, 2, n)) {
+      return false;
+    }
+
+    state.copyVector(0, u);
+    invDiag = &workspace.inverseDiagonal(A);
+    r = &workspace.vector(0);
+    d = &workspace.vector(1);
+    state.copyVector(1, *d);
+    residual(A, b, u, *r);
+    curIt = state.iterations;
+    initRes = state.scalars[0];
+    curRes = state.scalars[1];
+    theta = state.scalars[2];
+    delta = state.scalars[3];
+    rho = state.scalars[4];
+    bounds = { state.scalars[5], state.scalars[6] };
+    estimate = false;
+    return true;
+  }
+};
+
+/* Chebyshev accelerated Jacobi solver for given bounds of the spectrum of
+   D^-1 A, drawing all of its temporaries from the given workspace. Solves
+   until the residual is reduced by the given factor and returns the number
+   of iterations required, or SOLVE_FAILED if that takes more than
+   maxIterations or the bounds are unusable */
+template<typename T, class MatrixImpl, std::size_t n>
+unsigned int chebyshev(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n>& b,
+  Vector<T, n>& u,
+  Workspace<T, n>& workspace,
+  const SpectralBounds& bounds,
+  double tolerance = 1.e-5,
+  SolverTelemetry *telemetry = nullptr,
+  unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+
+  ChebyshevStepper<T, MatrixImpl, n> stepper(A, b, u, workspace, bounds, tolerance, telemetry);
+  return solveSteps(stepper, maxIterations);
+}
+
+/* Chebyshev accelerated Jacobi solver estimating the bounds, like above */
+template<typename T, class MatrixImpl, std::size_t n>
+unsigned int chebyshev(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n>& b,
+  Vector<T, n>& u,
+  Workspace<T, n>& workspace,
+  double tolerance = 1.e-5,
+  SolverTelemetry *telemetry = nullptr,
+  unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+
+  ChebyshevStepper<T, MatrixImpl, n> stepper(A, b, u, workspace, tolerance, telemetry);
+  return solveSteps(stepper, maxIterations);
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "Chebyshev.h"
+#include "TestProblems.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// jacobiIts is the iteration count of the plain Jacobi solver (see SolverTest)
+template<size_t numPoints>
+void checkPoisson(unsigned int jacobiIts) {
+	const auto A = poissonStencil<numPoints>();
+	const auto b = rhs<numPoints>();
+	Workspace<double, numPoints> workspace;
+
+	// the exact bounds of D^-1 A on the inner points, see SpectrumTest
+	const double c = cos(PI / (numPoints - 1));
+	const SpectralBounds exact = { 1. - c, 1. + c };
+	Vector<double, numPoints> u(0.0);
+	const unsigned int exactIts = chebyshev(A, b, u, workspace, exact);
+	checkConverged(A, b, u);
+
+	u = Vector<double, numPoints>(0.0);
+	ChebyshevStepper<double, Stencil<double, numPoints, numPoints>, numPoints> stepper(A, b, u, workspace);
+	stepper.step(STEP_ALL);
+	const unsigned int estimatedIts = stepper.iterations();
+	checkConverged(A, b, u);
+	assert("bounds estimated on the first step" && stepper.spectralBounds().max > exact.max);
+
+	std::cout << "\t" << numPoints << " grid points: Jacobi " << jacobiIts << ", Chebyshev " << exactIts
+	          << " (exact bounds), " << estimatedIts << " (estimated bounds) iterations" << std::endl;
+	// O(sqrt(condition number)), i.e. O(N) iterations instead of O(N^2)
+	assert("fewer iterations than Jacobi" && 3 * exactIts < jacobiIts && exactIts < 7 * numPoints);
+	// the estimate is exact here, the iterations lost are the price of widening the interval
+	assert("estimated bounds nearly as good" && estimatedIts <= exactIts + exactIts / 4);
+}
+
+void test_poisson() {
+	TESTCASE("test_poisson");
+	checkPoisson<33>(743);
+	checkPoisson<49>(1676);
+	checkPoisson<65>(2982);
+	checkPoisson<113>(9142);
+	checkPoisson<129>(11941);
+	checkPoisson<193>(26874);
+}
+
+// stepping in slices of any size gives the iterations and the solution of the blocking solver
+void test_slices() {
+	TESTCASE("test_slices");
+	constexpr size_t n = 65;
+	const auto A = poissonStencil<n>();
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+	Vector<double, n> blockingU(0.0);
+	const unsigned int its = chebyshev(A, b, blockingU, workspace);
+
+	for (unsigned int slice : { 1u, 7u, 1000u }) {
+		Vector<double, n> u(0.0);
+		ChebyshevStepper<double, Stencil<double, n, n>, n> stepper(A, b, u, workspace);
+		assert("nothing done before the first step" && !stepper.converged() && stepper.iterations() == 0);
+		while (!stepper.step(slice)) {}
+		assert("same iterations" && stepper.iterations() == its);
+		assert("same solution" && u == blockingU);
+	}
+}
+
+// unusable bounds are replaced by estimated ones, operators without usable bounds fail
+void test_bounds() {
+	TESTCASE("test_bounds");
+	constexpr size_t n = 65;
+	const auto A = poissonStencil<n>();
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+	Vector<double, n> u(0.0);
+	const unsigned int estimatedIts = chebyshev(A, b, u, workspace);
+	for (SpectralBounds bounds : { SpectralBounds{ 0., 0. }, SpectralBounds{ -1., 2. }, SpectralBounds{ 2., 1. },
+			SpectralBounds{ 0.5, std::nan("") }, SpectralBounds{ 0.5, INFINITY } }) {
+		u = Vector<double, n>(0.0);
+		assert("bounds estimated instead" && chebyshev(A, b, u, workspace, bounds) == estimatedIts);
+	}
+	u = Vector<double, n>(0.0);
+	assert("limit reached" && chebyshev(A, b, u, workspace, 1.e-5, nullptr, 10) == SOLVE_FAILED);
+
+	// an interval of a single point is the Jacobi step, exact for D^-1 A = I
+	Matrix<double, n, n> diagonal([] (size_t i, size_t j) { return (i == j) ? 1. + i : 0.; });
+	u = Vector<double, n>(0.0);
+	assert("one iteration" && chebyshev(diagonal, b, u, workspace, SpectralBounds{ 1., 1. }) == 1);
+	checkConverged(diagonal, b, u);
+
+	// the spectrum of D^-1 A has both signs
+	Matrix<double, n, n> indefinite([] (size_t i, size_t j) { return (i == j) ? 1. : (i == j + 1 || j == i + 1) ? 3. : 0.; });
+	u = Vector<double, n>(0.0);
+	ChebyshevStepper<double, Matrix<double, n, n>, n> stepper(indefinite, b, u, workspace);
+	assert("failed without iterating" && !stepper.step(STEP_ALL) && stepper.failed() && stepper.iterations() == 0);
+	assert("reported as failed" && chebyshev(indefinite, b, u, workspace) == SOLVE_FAILED);
+}
+
+int main() {
+	test_poisson();
+	test_slices();
+	test_bounds();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Hash.h"
+#include "Snapshot.h"
+#include "Steppable.h"
+
+/* Snapshot files are binary, in the byte order of the machine that wrote
+   them: the magic "ADVPTSNP", the format version, the solver name (length
+   and characters), the iterations, the problem hash, the scalars and the
+   vectors (each as a count followed by its elements as double), and a
+   checksum of all of the preceding bytes. Integers are 32 bit, counts and
+   the hash 64 bit */
+constexpr char SNAPSHOT_MAGIC[8] = { 'A', 'D', 'V', 'P', 'T', 'S', 'N', 'P' };
+constexpr std::uint32_t SNAPSHOT_VERSION = 2;
+
+/* Appends values to a snapshot file and keeps the checksum of everything
+   written */
+class SnapshotOutput {
+private:
+  std::ofstream out;
+  std::uint64_t hash = HASH_OFFSET;
+public:
+  SnapshotOutput(const std::string& path) : out(path, std::ios::binary | std::ios::trunc) {}
+
+  void bytes(const void *data, std::size_t size) {
+    hash = hashBytes(data, size, hash);
+    out.write(static_cast<const char *>(data), size);
+  }
+
+  template<typename V>
+  void value(V v) {
+    bytes(&v, sizeof(V));
+  }
+
+  void doubles(const std::vector<double>& values) {
+    value<std::uint64_t>(values.size());
+    bytes(values.data(), values.size() * sizeof(double));
+  }
+
+  /* Write the checksum, returns false if any of the writes failed */
+  bool finish() {
+    const std::uint64_t checksum = hash;
+    out.write(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+    out.close();
+    return !out.fail();
+  }
+};
+
+/* Reads values from a snapshot file, checking them against the checksum */
+class SnapshotInput {
+private:
+  std::ifstream in;
+  std::uint64_t hash = HASH_OFFSET;
+public:
+  SnapshotInput(const std::string& path) : in(path, std::ios::binary) {}
+
+  bool bytes(void *data, std::size_t size) {
+    if(!in.read(static_cast<char *>(data), size)) {
+      return false;
+    }
+
+    hash = hashBytes(data, size, hash);
+    return true;
+  }
+
+  template<typename V>
+  bool value(V& v) {
+    return bytes(&v, sizeof(V));
+  }
+
+  /* Counts are checked against the remaining size of the file before
+     anything is allocated, so a corrupt count can not exhaust the memory */
+  bool doubles(std::vector<double>& values) {
+    std::uint64_t count = 0;
+
+    if(!value(count) || count > remaining() / sizeof(double)) {
+      return false;
+    }
+
+    values.resize(count);
+    return bytes(values.data(), count * sizeof(double));
+  }
+
+  /* Return the number of bytes left in the file */
+  std::uint64_t remaining() {
+    const std::streampos position = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streampos end = in.tellg();
+    in.seekg(position);
+    return (position < 0 || end < position) ? 0 : static_cast<std::uint64_t>(end - position);
+  }
+
+  /* Check the checksum and that nothing follows it */
+  bool finish() {
+    const std::uint64_t expected = hash;
+    std::uint64_t checksum = 0;
+
+    if(!in.read(reinterpret_cast<char *>(&checksum), sizeof(checksum))) {
+      return false;
+    }
+
+    return checksum == expected && in.peek() == std::ifstream::traits_type::eof();
+  }
+};
+
+/* Write the snapshot to the given file, returns false if it could not be
+   written. The file is written under a temporary name and renamed when
+   complete, so a crash during the write leaves the previous snapshot */
+inline bool writeSnapshot(const std::string& path, const SolverSnapshot& state) {
+  const std::string temporary = path + ".tmp";
+  SnapshotOutput out(temporary);
+
+  out.bytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  out.value<std::uint32_t>(SNAPSHOT_VERSION);
+  out.value<std::uint32_t>(state.solver.size());
+  out.bytes(state.solver.data(), state.solver.size());
+  out.value<std::uint32_t>(state.iterations);
+  out.value<std::uint64_t>(state.problem);
+  out.doubles(state.scalars);
+  out.value<std::uint64_t>(state.vectors.size());
+
+  for(const std::vector<double>& v : state.vectors) {
+    out.doubles(v);
+  }
+
+  if(!out.finish()) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+
+  return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+/* Read a snapshot from the given file, returns false if it is missing,
+   truncated, corrupt or of another format version */
+inline bool readSnapshot(const std::string& path, SolverSnapshot& state) {
+  SnapshotInput in(path);
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  std::uint32_t version = 0, length = 0;
+
+  if(!in.bytes(magic, sizeof(magic)) || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+     !in.value(version) || version != SNAPSHOT_VERSION || !in.value(length) || length > in.remaining()) {
+    return false;
+  }
+
+  SolverSnapshot result;
+  result.solver.resize(length);
+  std::uint64_t count = 0;
+
+  if(!in.bytes(&result.solver[0], length) || !in.value(result.iterations) || !in.value(result.problem) ||
+     !in.doubles(result.scalars) || !in.value(count) || count > in.remaining() / sizeof(std::uint64_t)) {
+    return false;
+  }
+
+  result.vectors.resize(count);
+
+  for(std::vector<double>& v : result.vectors) {
+    if(!in.doubles(v)) {
+      return false;
+    }
+  }
+
+  if(!in.finish()) {
+    return false;
+  }
+
+  state = std::move(result);
+  return true;
+}
+
+/* Writes snapshots to a file on a background thread, so a solver only pays
+   for taking the snapshot, not for the IO. Only the latest snapshot is kept:
+   one handed over while the previous one is still being written replaces the
+   one waiting, as the older state is of no use once a newer one exists */
+class CheckpointWriter {
+private:
+  std::string path;
+  /* Snapshot waiting to be written, and whether there is one */
+  SolverSnapshot pending;
+  bool hasPending = false, writing = false, stopping = false;
+  /* Snapshots written, and whether the last write failed */
+  unsigned int count = 0;
+  bool failed = false;
+  /* Guards the state above, with the conditions for work and for idle */
+  std::mutex mutex;
+  std::condition_variable work, idle;
+  std::thread worker;
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(true) {
+      work.wait(lock, [this] { return hasPending || stopping; });
+
+      if(!hasPending) {
+        return;
+      }
+
+      SolverSnapshot state = std::move(pending);
+      hasPending = false;
+      writing = true;
+      lock.unlock();
+
+      const bool ok = writeSnapshot(path, state);
+
+      lock.lock();
+      writing = false;
+      failed = !ok;
+      count += ok ? 1 : 0;
+      idle.notify_all();
+    }
+  }
+public:
+  CheckpointWriter(const std::string& path) : path(path), worker(&CheckpointWriter::run, this) {}
+
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  /* Writes the pending snapshot before stopping */
+  ~CheckpointWriter() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+
+    work.notify_one();
+    worker.join();
+  }
+
+  /* Hand over a snapshot to be written, returns without waiting for the IO */
+  void write(SolverSnapshot state) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending = std::move(state);
+      hasPending = true;
+    }
+
+    work.notify_one();
+  }
+
+  /* Wait until the last snapshot handed over is written, returns false if
+     writing it failed */
+  bool flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return !hasPending && !writing; });
+    return !failed;
+  }
+
+  /* Return the number of snapshots written so far */
+  unsigned int written() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+  }
+
+  const std::string& file() const {
+    return path;
+  }
+};
+
+/* Solve with the given stepper, handing a snapshot to the writer every
+   interval iterations and once converged, and wait for the last one to be
+   written. Returns the number of iterations of the solve, or SOLVE_FAILED if
+   it did not converge within maxIterations more iterations, stopped making
+   progress or broke down. The state of a broken down solve is not written,
+   the last snapshot stays the one before, from which it can be retried */
+template<class Stepper>
+unsigned int checkpointedSolve(Stepper& stepper, CheckpointWriter& writer, unsigned int interval,
+                               unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+  const unsigned int start = stepper.iterations();
+  unsigned int before = start;
+
+  while(!stepper.step(std::min(interval, maxIterations - (before - start)))) {
+    if(stepper.failed()) {
+      writer.flush();
+      return SOLVE_FAILED;
+    }
+
+    writer.write(stepper.snapshot());
+
+    if(stepper.iterations() - start >= maxIterations || stepper.iterations() == before) {
+      writer.flush();
+      return SOLVE_FAILED;
+    }
+
+    before = stepper.iterations();
+  }
+
+  writer.write(stepper.snapshot());
+  writer.flush();
+  return stepper.iterations();
+}
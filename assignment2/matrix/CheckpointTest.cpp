@@ -0,0 +1,248 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include "Vector.h"
+#include "Stencil.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "CG.h"
+#include "Chebyshev.h"
+#include "Krylov.h"
+#include "Checkpoint.h"
+#include "TestProblems.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+const std::string path = "CheckpointTest.snapshot";
+
+// a solve resumed from a snapshot written halfway, with a fresh stepper and workspace,
+// ends with the iterations and the solution of the uninterrupted one
+template<class Stepper, size_t numPoints>
+void checkResume(const char *name, const Stencil<double, numPoints, numPoints>& A, const Vector<double, numPoints>& b, unsigned int expectedIts) {
+	Workspace<double, numPoints> workspace;
+	Vector<double, numPoints> expected(0.0);
+	Stepper full(A, b, expected, workspace);
+	full.step(STEP_ALL);
+	const unsigned int its = full.iterations();
+	assert("iterations of the blocking solver" && (expectedIts == 0 || its == expectedIts));
+
+	Vector<double, numPoints> u(0.0);
+	{
+		Stepper first(A, b, u, workspace);
+		first.step(its / 2);
+		assert("snapshot written" && writeSnapshot(path, first.snapshot()));
+	}
+
+	SolverSnapshot state;
+	assert("snapshot read" && readSnapshot(path, state));
+	assert("iterations stored" && state.iterations == its / 2);
+
+	Workspace<double, numPoints> other;
+	Vector<double, numPoints> resumed(0.0);
+	Stepper second(A, b, resumed, other);
+	assert("resumed" && second.resume(state));
+	assert("state restored" && second.iterations() == its / 2 && resumed == u);
+	second.step(STEP_ALL);
+	std::cout << "\t" << name << ": resumed at " << its / 2 << " of " << its << " iterations" << std::endl;
+	assert("same iterations" && second.iterations() == its);
+	assert("same solution" && resumed == expected);
+}
+
+void test_resume() {
+	TESTCASE("test_resume");
+	constexpr size_t n = 129;
+	const auto A = poissonStencil<n>();
+	const auto b = rhs<n>();
+	checkResume<JacobiStepper<double, Stencil<double, n, n>, n>>("Jacobi", A, b, 11941);
+	checkResume<CGStepper<double, Stencil<double, n, n>, n>>("CG", A, b, 0);
+	checkResume<ChebyshevStepper<double, Stencil<double, n, n>, n>>("Chebyshev", A, b, 0);
+
+	// -u'' + 20 u' with the convection term upwinded, snapshots are taken in the middle of a GMRES cycle
+	const double hx = 1. / (n - 1), hxSq = hx * hx;
+	const Stencil<double, n, n> C({ { 0, 1. } }, { { -1, -1. / hxSq - 20. / hx },{ 0, 2. / hxSq + 20. / hx },{ 1, -1. / hxSq } });
+	checkResume<GMRESStepper<double, Stencil<double, n, n>, n>>("GMRES", C, b, 0);
+	checkResume<BiCGSTABStepper<double, Stencil<double, n, n>, n>>("BiCGSTAB", C, b, 0);
+	std::remove(path.c_str());
+}
+
+// snapshots of another solver, problem or size are refused and leave u alone
+void test_mismatch() {
+	TESTCASE("test_mismatch");
+	constexpr size_t n = 65;
+	const auto A = poissonStencil<n>();
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+	Vector<double, n> u(0.0);
+	JacobiStepper<double, Stencil<double, n, n>, n> first(A, b, u, workspace);
+	first.step(100);
+	const SolverSnapshot state = first.snapshot();
+
+	const Vector<double, n> start(1.0);
+	Vector<double, n> resumed(start);
+	const Stencil<double, n, n> otherA({ { 0, 1. } }, { { -1, -1. },{ 0, 2. },{ 1, -1. } });
+	JacobiStepper<double, Stencil<double, n, n>, n> otherOperator(otherA, b, resumed, workspace);
+	assert("other operator refused" && !otherOperator.resume(state) && resumed == start);
+
+	Vector<double, n> otherB(b);
+	otherB(n / 2) += 1.;
+	JacobiStepper<double, Stencil<double, n, n>, n> otherRhs(A, otherB, resumed, workspace);
+	assert("other right-hand side refused" && !otherRhs.resume(state) && resumed == start);
+
+	CGStepper<double, Stencil<double, n, n>, n> otherSolver(A, b, resumed, workspace);
+	assert("other solver refused" && !otherSolver.resume(state) && resumed == start);
+
+	constexpr size_t m = 33;
+	const auto smallA = poissonStencil<m>();
+	const auto smallB = rhs<m>();
+	Workspace<double, m> smallWorkspace;
+	const Vector<double, m> zero(0.0);
+	Vector<double, m> small(zero);
+	JacobiStepper<double, Stencil<double, m, m>, m> otherSize(smallA, smallB, small, smallWorkspace);
+	assert("other size refused" && !otherSize.resume(state) && small == zero);
+
+	JacobiStepper<double, Stencil<double, n, n>, n> same(A, b, resumed, workspace);
+	assert("same problem resumed" && same.resume(state) && resumed == u && same.iterations() == 100);
+}
+
+// the background writer leaves the snapshot of the converged solve
+void test_writer() {
+	TESTCASE("test_writer");
+	constexpr size_t n = 65;
+	const auto A = poissonStencil<n>();
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+
+	Vector<double, n> u(0.0);
+	JacobiStepper<double, Stencil<double, n, n>, n> stepper(A, b, u, workspace);
+	unsigned int its = 0;
+	{
+		CheckpointWriter writer(path);
+		its = checkpointedSolve(stepper, writer, 100);
+		assert("last snapshot written" && writer.written() >= 1);
+	}
+	assert("iterations of the blocking solver" && its == 2982);
+
+	SolverSnapshot state;
+	assert("snapshot read" && readSnapshot(path, state));
+	assert("final state" && state.solver == "jacobi" && state.iterations == its);
+	Vector<double, n> stored(0.0);
+	state.copyVector(0, stored);
+	assert("final solution" && stored == u);
+
+	// snapshots handed over faster than they are written: the last one wins
+	{
+		CheckpointWriter writer(path);
+		for (unsigned int k = 1; k <= 200; ++k) {
+			SolverSnapshot quick;
+			quick.solver = "quick";
+			quick.iterations = k;
+			quick.scalars = { (double)k };
+			writer.write(quick);
+		}
+		assert("flushed" && writer.flush());
+		assert("some writes skipped or all done" && writer.written() >= 1 && writer.written() <= 200);
+	}
+	assert("snapshot read" && readSnapshot(path, state));
+	assert("latest snapshot kept" && state.solver == "quick" && state.iterations == 200 && state.scalars[0] == 200.);
+	std::remove(path.c_str());
+}
+
+// solves that break down or exceed the limit end as failed, a broken down state is not written
+void test_failed() {
+	TESTCASE("test_failed");
+	constexpr size_t n = 65;
+	const auto A = poissonStencil<n>();
+	Vector<double, n> b = rhs<n>();
+	Workspace<double, n> workspace;
+	std::remove(path.c_str());
+
+	Vector<double, n> u(0.0);
+	{
+		JacobiStepper<double, Stencil<double, n, n>, n> limited(A, b, u, workspace);
+		CheckpointWriter writer(path);
+		assert("limit reached" && checkpointedSolve(limited, writer, 100, 250) == SOLVE_FAILED);
+		assert("state at the limit written" && writer.written() >= 1 && limited.iterations() == 250);
+	}
+
+	SolverSnapshot state;
+	assert("snapshot read" && readSnapshot(path, state) && state.iterations == 250);
+	{
+		Vector<double, n> resumed(0.0);
+		JacobiStepper<double, Stencil<double, n, n>, n> retried(A, b, resumed, workspace);
+		assert("resumed" && retried.resume(state));
+		CheckpointWriter writer(path);
+		assert("retry converges" && checkpointedSolve(retried, writer, 100) == 2982);
+	}
+
+	std::remove(path.c_str());
+	b(n / 2) = std::nan("");
+	u = Vector<double, n>(0.0);
+	{
+		JacobiStepper<double, Stencil<double, n, n>, n> broken(A, b, u, workspace);
+		CheckpointWriter writer(path);
+		assert("broken down" && checkpointedSolve(broken, writer, 100) == SOLVE_FAILED && broken.failed());
+		assert("nothing written" && writer.written() == 0);
+	}
+	assert("no snapshot" && !readSnapshot(path, state));
+}
+
+// missing, truncated and corrupt files are rejected and leave the snapshot alone
+void test_corrupt() {
+	TESTCASE("test_corrupt");
+	SolverSnapshot state;
+	state.solver = "jacobi";
+	state.iterations = 7;
+	state.problem = 0x0123456789abcdefull;
+	state.scalars = { 1., 2. };
+	state.vectors = { { 3., 4., 5. } };
+	assert("written" && writeSnapshot(path, state));
+
+	std::ifstream in(path, std::ios::binary);
+	const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	in.close();
+
+	SolverSnapshot read;
+	assert("read back" && readSnapshot(path, read) && read.solver == state.solver && read.iterations == 7 &&
+	       read.problem == state.problem && read.scalars == state.scalars && read.vectors == state.vectors);
+
+	for (size_t length : { (size_t)0, (size_t)5, contents.size() / 2, contents.size() - 1 }) {
+		std::ofstream(path, std::ios::binary).write(contents.data(), length);
+		assert("truncated rejected" && !readSnapshot(path, read) && read.iterations == 7);
+	}
+
+	for (size_t position : { (size_t)3, (size_t)20, contents.size() - 12, contents.size() - 1 }) {
+		std::string damaged = contents;
+		damaged[position] ^= 0x10;
+		std::ofstream(path, std::ios::binary).write(damaged.data(), damaged.size());
+		assert("corrupt rejected" && !readSnapshot(path, read) && read.iterations == 7);
+	}
+
+	std::remove(path.c_str());
+	assert("missing rejected" && !readSnapshot(path, read));
+}
+
+int main() {
+	test_resume();
+	test_mismatch();
+	test_writer();
+	test_failed();
+	test_corrupt();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <vector>
+#include "../../common/CpuDispatch.h"
+#include "Kernels.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+double measureTime(std::function<void( )> toMeasure) {
+	std::chrono::time_point<std::chrono::steady_clock> start, end;
+	start = std::chrono::steady_clock::now( );
+	toMeasure( );
+	end = std::chrono::steady_clock::now( );
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count( );
+}
+
+// the levels the CPU supports, the baseline first
+std::vector<IsaLevel> supportedLevels() {
+	std::vector<IsaLevel> levels;
+	for (IsaLevel level : { IsaLevel::SSE2, IsaLevel::AVX2, IsaLevel::AVX512 }) {
+		if (level <= detect_isa_level()) {
+			levels.push_back(level);
+		}
+	}
+	return levels;
+}
+
+void test_selection() {
+	TESTCASE("test_selection");
+	std::cout << "\tdetected " << isa_name(detect_isa_level()) << ", using " << isa_name(isa_level()) << std::endl;
+	assert("override selects a lower level" && select_isa_level("sse2", IsaLevel::AVX512) == IsaLevel::SSE2);
+	assert("override can not exceed the CPU" && select_isa_level("avx512", IsaLevel::AVX2) == IsaLevel::AVX2);
+	assert("unknown override is ignored" && select_isa_level("neon", IsaLevel::AVX2) == IsaLevel::AVX2);
+	assert("no override" && select_isa_level(nullptr, IsaLevel::AVX512) == IsaLevel::AVX512);
+	assert("selected level is supported" && isa_level() <= detect_isa_level());
+}
+
+// every build the CPU supports gives exactly the same result
+void test_identical_results() {
+	TESTCASE("test_identical_results");
+	constexpr size_t rows = 37, cols = 53;
+	std::vector<double> a(rows * cols), x(cols + 2), y(cols + 2);
+	for (size_t i = 0; i < a.size(); ++i) {
+		a[i] = std::sin(0.1 * i);
+	}
+	for (size_t i = 0; i < x.size(); ++i) {
+		x[i] = std::cos(0.7 * i) / 3.;
+	}
+	std::vector<std::pair<int, double>> entries{ { 1, 0.7 }, { -1, 1.1 }, { 0, -2.3 }, { 2, 0.1 } };
+
+	// lengths below, at and above the number of partial sums
+	for (size_t n : { 0, 1, 7, 8, 9, 53 }) {
+		double expected = dotKernel(a.data(), x.data(), n, IsaLevel::SSE2);
+		double naive = 0.0;
+		for (size_t i = 0; i < n; ++i) {
+			naive += a[i] * x[i];
+		}
+		assert("dot product" && std::abs(expected - naive) < 1e-12);
+		for (IsaLevel level : supportedLevels()) {
+			assert("identical dot products" && dotKernel(a.data(), x.data(), n, level) == expected);
+		}
+	}
+
+	std::vector<double> expected(rows), result(rows);
+	matvecKernel(a.data(), x.data(), expected.data(), rows, cols, IsaLevel::SSE2);
+	for (IsaLevel level : supportedLevels()) {
+		matvecKernel(a.data(), x.data(), result.data(), rows, cols, level);
+		assert("identical matrix-vector products" && result == expected);
+	}
+
+	std::vector<double> expectedStencil(cols + 2, 0.0);
+	stencilKernel(x.data(), expectedStencil.data(), 1, cols, entries.data(), entries.size(), IsaLevel::SSE2);
+	for (size_t i = 1; i < cols; ++i) {
+		double sum = 0.0;
+		for (auto elem : entries) {
+			sum += x[i + elem.first] * elem.second;
+		}
+		assert("stencil sums in entry order" && expectedStencil[i] == sum);
+	}
+	for (IsaLevel level : supportedLevels()) {
+		std::fill(y.begin(), y.end(), 0.0);
+		stencilKernel(x.data(), y.data(), 1, cols, entries.data(), entries.size(), level);
+		assert("identical stencil applications" && y == expectedStencil);
+	}
+}
+
+void test_speed() {
+	TESTCASE("test_speed");
+	constexpr size_t n = 512, repetitions = 200;
+	std::vector<double> a(n * n, 0.5), x(n, 1.0), y(n);
+	for (IsaLevel level : supportedLevels()) {
+		double time = measureTime([&] {
+			for (size_t r = 0; r < repetitions; ++r) {
+				matvecKernel(a.data(), x.data(), y.data(), n, n, level);
+			}
+		});
+		std::cout << "\t" << isa_name(level) << ": " << n << " x " << n << " matrix-vector product in " << time / repetitions * 1e6 << " microseconds" << std::endl;
+	}
+}
+
+int main() {
+	test_selection();
+	test_identical_results();
+	test_speed();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,482 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "Stencil.h"
+#include "Kernels.h"
+#include "Steppable.h"
+
+/* Distributed-memory versions of the stencil solvers. The grid is a number of
+   lines of width points each (width 1 for a 1-D grid, nx for an nx x ny 2-D
+   grid stored line by line), split into contiguous blocks of lines, one per
+   MPI rank. Every rank keeps its lines plus a few ghost lines on each side,
+   which are refreshed from the neighbouring ranks before the stencil reads
+   them. Run the programs with `mpirun -np k` */
+
+/* MPI datatype of T */
+template<typename T>
+MPI_Datatype mpiType();
+
+template<>
+inline MPI_Datatype mpiType<double>() {
+  return MPI_DOUBLE;
+}
+
+template<>
+inline MPI_Datatype mpiType<float>() {
+  return MPI_FLOAT;
+}
+
+/* Block decomposition of a grid among the ranks of a communicator. Local
+   vectors hold halo ghost lines, the owned lines, and another halo ghost
+   lines, the ghosts beyond the ends of the grid stay zero */
+template<typename T>
+class DistributedGrid {
+private:
+  /* Communicator, rank of this process and number of ranks */
+  MPI_Comm comm;
+  int rank_, ranks_;
+  /* Points per line, lines of the whole grid and ghost lines per side */
+  std::size_t width_, lines_, halo_;
+  /* First global line owned by this rank and number of owned lines */
+  std::size_t first, count;
+  /* Ranks owning the previous and the next lines, MPI_PROC_NULL at the
+     ends of the grid so that exchanges with them do nothing */
+  int previous, next;
+  /* Requests of the running ghost exchange */
+  mutable MPI_Request requests[4];
+public:
+  /* DistributedGrid constructor. Every rank has to own at least halo lines,
+     so that ghosts only come from the direct neighbours */
+  DistributedGrid(MPI_Comm comm, std::size_t width, std::size_t lines, std::size_t halo = 1)
+    : comm(comm), width_(width), lines_(lines), halo_(halo) {
+
+    MPI_Comm_rank(comm, &rank_);
+    MPI_Comm_size(comm, &ranks_);
+
+    /* The first lines % ranks ranks own one more line than the others */
+    const std::size_t ranks = ranks_, rank = rank_;
+    count = lines / ranks + (rank < lines % ranks ? 1 : 0);
+    first = rank * (lines / ranks) + std::min(rank, lines % ranks);
+    assert(count >= halo && count > 0 && "Too many ranks for the grid");
+
+    previous = (rank_ > 0) ? rank_ - 1 : MPI_PROC_NULL;
+    next = (rank_ + 1 < ranks_) ? rank_ + 1 : MPI_PROC_NULL;
+  }
+
+  /* The grid is referenced by the operators, so it can not be copied */
+  DistributedGrid(const DistributedGrid&) = delete;
+  DistributedGrid& operator=(const DistributedGrid&) = delete;
+
+  /* Return the communicator */
+  MPI_Comm communicator() const {
+    return comm;
+  }
+
+  /* Return the rank of this process */
+  int rank() const {
+    return rank_;
+  }
+
+  /* Return the number of ranks */
+  int ranks() const {
+    return ranks_;
+  }
+
+  /* Return the number of points per line */
+  std::size_t width() const {
+    return width_;
+  }
+
+  /* Return the number of lines of the whole grid */
+  std::size_t lines() const {
+    return lines_;
+  }
+
+  /* Return the number of ghost lines per side */
+  std::size_t halo() const {
+    return halo_;
+  }
+
+  /* Return the first global line owned by this rank */
+  std::size_t firstLine() const {
+    return first;
+  }
+
+  /* Return the number of lines owned by this rank */
+  std::size_t ownedLines() const {
+    return count;
+  }
+
+  /* Return the local index of the first owned point */
+  std::size_t begin() const {
+    return halo_ * width_;
+  }
+
+  /* Return the local index after the last owned point */
+  std::size_t end() const {
+    return (halo_ + count) * width_;
+  }
+
+  /* Return the size of local vectors, including the ghost lines */
+  std::size_t localSize() const {
+    return (count + 2 * halo_) * width_;
+  }
+
+  /* Return the global index of the point at local index k */
+  std::size_t global(std::size_t k) const {
+    return first * width_ + k - begin();
+  }
+
+  /* Return a local vector filled with the given value, with zero ghosts */
+  std::vector<T> vector(T value = 0.0) const {
+    std::vector<T> v(localSize(), 0.0);
+    std::fill(v.begin() + begin(), v.begin() + end(), value);
+    return v;
+  }
+
+  /* Return a local vector with the owned points set to f(global index) */
+  template<class Function>
+  std::vector<T> vector(Function f) const {
+    std::vector<T> v(localSize(), 0.0);
+
+    for(std::size_t k = begin(); k < end(); ++k) {
+      v[k] = f(global(k));
+    }
+
+    return v;
+  }
+
+  /* Start refreshing the ghost lines of v from the neighbours, v must not be
+     touched until finishExchange returns */
+  void startExchange(std::vector<T>& v) const {
+    const int size = halo_ * width_;
+    T *data = v.data();
+
+    MPI_Irecv(data, size, mpiType<T>(), previous, 0, comm, &requests[0]);
+    MPI_Irecv(data + end(), size, mpiType<T>(), next, 1, comm, &requests[1]);
+    MPI_Isend(data + begin(), size, mpiType<T>(), previous, 1, comm, &requests[2]);
+    MPI_Isend(data + end() - size, size, mpiType<T>(), next, 0, comm, &requests[3]);
+  }
+
+  /* Wait for the ghost exchange started last */
+  void finishExchange() const {
+    MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+  }
+
+  /* Refresh the ghost lines of v */
+  void exchange(std::vector<T>& v) const {
+    startExchange(v);
+    finishExchange();
+  }
+
+  /* Sum the given values over all ranks, in place */
+  void sum(double *values, int size) const {
+    MPI_Allreduce(MPI_IN_PLACE, values, size, MPI_DOUBLE, MPI_SUM, comm);
+  }
+
+  /* Return the sum of the given value over all ranks */
+  double sum(double value) const {
+    sum(&value, 1);
+    return value;
+  }
+
+  /* Return the owned points of all ranks as one vector on rank root, the
+     other ranks get an empty vector */
+  std::vector<T> gather(const std::vector<T>& v, int root = 0) const {
+    std::vector<int> counts(ranks_), displacements(ranks_);
+    const int size = count * width_;
+
+    MPI_Gather(&size, 1, MPI_INT, counts.data(), 1, MPI_INT, root, comm);
+
+    for(int r = 1; r < ranks_; ++r) {
+      displacements[r] = displacements[r - 1] + counts[r - 1];
+    }
+
+    std::vector<T> result((rank_ == root) ? lines_ * width_ : 0);
+    MPI_Gatherv(v.data() + begin(), size, mpiType<T>(), result.data(), counts.data(), displacements.data(), mpiType<T>(), root, comm);
+    return result;
+  }
+};
+
+/* Stencil on a DistributedGrid. The offsets of the entries are distances in
+   the grid stored line by line (+-1 for the neighbours within a line, +-width
+   for the ones in the neighbouring lines) and have to stay within the halo.
+   The boundary entries are applied to the first and last line and, on 2-D
+   grids, to the first and last point of every line, the inner entries to the
+   other points. Products start the ghost exchange, apply the stencil to the
+   lines that only read owned points while the ghosts are in flight, and the
+   lines next to the ghosts once they arrived */
+template<typename T>
+class DistributedStencil {
+private:
+  /* Grid the stencil works on */
+  const DistributedGrid<T>& grid;
+  /* Entries of the boundary and the inner points */
+  std::vector<StencilEntry<T> > boundaryStencil, innerStencil;
+
+  /* Return y = sum coefficient * x[k + offset] over the given entries */
+  static T applyAt(const std::vector<StencilEntry<T> >& entries, const T *x, std::size_t k) {
+    T sum = 0.0;
+
+    for(auto elem : entries) {
+      sum += elem.second * x[k + elem.first];
+    }
+
+    return sum;
+  }
+
+  /* Return the diagonal coefficient of the given entries */
+  static T diagonal(const std::vector<StencilEntry<T> >& entries) {
+    T sum = 0.0;
+
+    for(auto elem : entries) {
+      if(elem.first == 0) {
+        sum += elem.second;
+      }
+    }
+
+    return sum;
+  }
+
+  /* Check that the offsets of the entries stay within the ghost lines */
+  void checkReach(const std::vector<StencilEntry<T> >& entries) const {
+    for(auto elem : entries) {
+      assert((std::size_t)std::abs(elem.first) <= grid.halo() * grid.width() && "Stencil reaches beyond the ghost lines");
+    }
+  }
+
+  /* Apply the stencil to the local lines [firstLine, lastLine), counted from
+     the first owned line */
+  void applyLines(const T *x, T *y, std::size_t firstLine, std::size_t lastLine) const {
+    const std::size_t width = grid.width();
+    std::size_t line = firstLine;
+
+    while(line < lastLine) {
+      const std::size_t globalLine = grid.firstLine() + line;
+      const std::size_t start = grid.begin() + line * width;
+
+      if(globalLine == 0 || globalLine == grid.lines() - 1) {
+        /* Boundary line */
+        for(std::size_t k = start; k < start + width; ++k) {
+          y[k] = applyAt(boundaryStencil, x, k);
+        }
+
+        ++line;
+      } else if(width == 1) {
+        /* 1-D grid, all inner points up to the next boundary line in one go */
+        const std::size_t stop = std::min(lastLine, grid.lines() - 1 - grid.firstLine());
+        stencilKernel(x, y, start, grid.begin() + stop, innerStencil.data(), innerStencil.size());
+        line = stop;
+      } else {
+        /* Inner line of a 2-D grid, with a boundary point on either end */
+        y[start] = applyAt(boundaryStencil, x, start);
+        stencilKernel(x, y, start + 1, start + width - 1, innerStencil.data(), innerStencil.size());
+        y[start + width - 1] = applyAt(boundaryStencil, x, start + width - 1);
+        ++line;
+      }
+    }
+  }
+public:
+  /* DistributedStencil constructor */
+  DistributedStencil(const DistributedGrid<T>& grid, const std::vector<StencilEntry<T> >& boundaryEntries, const std::vector<StencilEntry<T> >& innerEntries)
+    : grid(grid), boundaryStencil(boundaryEntries), innerStencil(innerEntries) {
+
+    checkReach(boundaryStencil);
+    checkReach(innerStencil);
+  }
+
+  /* DistributedStencil constructor, distributing a 1-D Stencil */
+  template<std::size_t n>
+  DistributedStencil(const DistributedGrid<T>& grid, const Stencil<T, n, n>& s)
+    : DistributedStencil(grid, s.boundaryEntries(), s.innerEntries()) {
+
+    assert(grid.width() == 1 && grid.lines() == n && "Stencil does not match the grid");
+  }
+
+  /* Return the grid */
+  const DistributedGrid<T>& distribution() const {
+    return grid;
+  }
+
+  /* Stencil application y = A * x on the owned points, refreshing the ghost
+     lines of x first */
+  void apply(std::vector<T>& x, std::vector<T>& y) const {
+    const std::size_t halo = grid.halo(), lines = grid.ownedLines();
+
+    grid.startExchange(x);
+
+    /* Lines far enough from the ghosts overlap with the exchange */
+    if(lines > 2 * halo) {
+      applyLines(x.data(), y.data(), halo, lines - halo);
+    }
+
+    grid.finishExchange();
+
+    if(lines > 2 * halo) {
+      applyLines(x.data(), y.data(), 0, halo);
+      applyLines(x.data(), y.data(), lines - halo, lines);
+    } else {
+      applyLines(x.data(), y.data(), 0, lines);
+    }
+  }
+
+  /* Return the inverse diagonal as a local vector */
+  std::vector<T> inverseDiagonal() const {
+    const T boundary = 1.0 / diagonal(boundaryStencil), inner = 1.0 / diagonal(innerStencil);
+    const std::size_t width = grid.width();
+
+    return grid.vector([&] (std::size_t k) {
+      const std::size_t line = k / width, point = k % width;
+      const bool isBoundary = (line == 0 || line == grid.lines() - 1 || (width > 1 && (point == 0 || point == width - 1)));
+      return isBoundary ? boundary : inner;
+    });
+  }
+};
+
+/* Computes r = b - A * u on the owned points and returns the L2 norm of r
+   over all ranks */
+template<typename T>
+double distributedResidual(
+  const DistributedStencil<T>& A,
+  const std::vector<T>& b,
+  std::vector<T>& u,
+  std::vector<T>& r) {
+
+  const DistributedGrid<T>& grid = A.distribution();
+  A.apply(u, r);
+
+  double sum = 0.0;
+
+  for(std::size_t k = grid.begin(); k < grid.end(); ++k) {
+    r[k] = b[k] - r[k];
+    sum += r[k] * r[k];
+  }
+
+  return sqrt(grid.sum(sum));
+}
+
+/* Distributed Jacobi solver, iterating like jacobi() in Jacobi.h. u and b are
+   local vectors of the grid of A. Solves until the residual is reduced by the
+   given factor and returns the number of iterations required, or
+   SOLVE_FAILED if that takes more than maxIterations or the residual is no
+   longer finite. The residual comes from a global reduction, so all ranks
+   return the same */
+template<typename T>
+unsigned int distributedJacobi(
+  const DistributedStencil<T>& A,
+  const std::vector<T>& b,
+  std::vector<T>& u,
+  double tolerance = 1.e-5,
+  unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+
+  const DistributedGrid<T>& grid = A.distribution();
+  const std::vector<T> invDiag = A.inverseDiagonal();
+  std::vector<T> r = grid.vector();
+
+  double initRes = distributedResidual(A, b, u, r); // determine the initial residual
+  double curRes = initRes;
+
+  unsigned int curIt = 0; // store the current iteration index
+
+  while(curRes > tolerance * initRes && std::isfinite(curRes) && curIt < maxIterations) {
+    ++curIt;
+
+    /* Jacobi step */
+    for(std::size_t k = grid.begin(); k < grid.end(); ++k) {
+      u[k] += invDiag[k] * r[k];
+    }
+
+    curRes = distributedResidual(A, b, u, r); // update the residual
+  }
+
+  /* A residual that is not finite fails both comparisons */
+  return (curRes <= tolerance * initRes) ? curIt : SOLVE_FAILED;
+}
+
+/* Distributed conjugate gradient solver with the Jacobi preconditioner,
+   iterating like pcg() in CG.h. Every iteration takes one stencil
+   application with its ghost exchange and two global reductions, one for
+   p * Ap and one for both r * z and r * r. Solves until the residual is
+   reduced by the given factor and returns the number of iterations required,
+   or SOLVE_FAILED, like distributedJacobi() */
+template<typename T>
+unsigned int distributedCG(
+  const DistributedStencil<T>& A,
+  const std::vector<T>& b,
+  std::vector<T>& u,
+  double tolerance = 1.e-5,
+  unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+
+  const DistributedGrid<T>& grid = A.distribution();
+  const std::vector<T> invDiag = A.inverseDiagonal();
+  std::vector<T> r = grid.vector(), p = grid.vector(), q = grid.vector();
+  const std::size_t first = grid.begin(), last = grid.end();
+
+  double initRes = distributedResidual(A, b, u, r); // determine the initial residual
+  double curRes = initRes;
+
+  /* Satisfy the rows that only have a diagonal entry with a Jacobi step, see
+     pcg() */
+  for(std::size_t k = first; k < last; ++k) {
+    u[k] += invDiag[k] * r[k];
+  }
+
+  curRes = distributedResidual(A, b, u, r);
+
+  double rz = 0.0;
+
+  for(std::size_t k = first; k < last; ++k) {
+    p[k] = invDiag[k] * r[k];
+    rz += r[k] * p[k];
+  }
+
+  rz = grid.sum(rz);
+
+  unsigned int curIt = 0; // store the current iteration index
+
+  while(curRes > tolerance * initRes && std::isfinite(curRes) && curIt < maxIterations) {
+    ++curIt;
+
+    A.apply(p, q);
+
+    double pq = 0.0;
+
+    for(std::size_t k = first; k < last; ++k) {
+      pq += p[k] * q[k];
+    }
+
+    const double alpha = rz / grid.sum(pq);
+
+    /* Update, preconditioning and both local reductions in a single pass,
+       the preconditioned residual is formed again when updating p */
+    double sums[2] = { 0.0, 0.0 };
+
+    for(std::size_t k = first; k < last; ++k) {
+      u[k] += alpha * p[k];
+      r[k] -= alpha * q[k];
+      const T z = invDiag[k] * r[k];
+      sums[0] += r[k] * z;
+      sums[1] += r[k] * r[k];
+    }
+
+    grid.sum(sums, 2);
+    curRes = sqrt(sums[1]); // update the residual
+
+    const double beta = sums[0] / rz;
+    rz = sums[0];
+
+    for(std::size_t k = first; k < last; ++k) {
+      p[k] = invDiag[k] * r[k] + beta * p[k];
+    }
+  }
+
+  /* A residual that is not finite fails both comparisons */
+  return (curRes <= tolerance * initRes) ? curIt : SOLVE_FAILED;
+}
@@ -0,0 +1,168 @@
+#include <mpi.h>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "Vector.h"
+#include "Stencil.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "CG.h"
+#include "Distributed.h"
+#include "TestProblems.h"
+
+// run with any number of ranks, e.g. mpirun -np 4 ./DistributedTest
+
+using std::size_t;
+
+int rank = 0;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		if (rank == 0) std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		MPI_Barrier(MPI_COMM_WORLD);
+		if (rank == 0) std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// ghost lines hold the owned points of the neighbours, and zeros beyond the grid
+void test_exchange() {
+	TESTCASE("test_exchange");
+	int ranks;
+	MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+	for (size_t halo : { 1, 2 }) {
+		const size_t width = 3, lines = 2 * ranks * halo + 1;
+		DistributedGrid<double> grid(MPI_COMM_WORLD, width, lines, halo);
+		std::vector<double> v = grid.vector([] (size_t g) { return g + 1.; });
+		grid.exchange(v);
+		for (size_t k = 0; k < grid.localSize(); ++k) {
+			// global index of the point, possibly outside of the grid
+			const long g = (long)(grid.firstLine() * width + k) - (long)(halo * width);
+			const double expected = (g < 0 || g >= (long)(lines * width)) ? 0. : g + 1.;
+			assert("ghost exchanged" && v[k] == expected);
+		}
+		std::vector<double> all = grid.gather(v);
+		for (size_t g = 0; g < all.size(); ++g) {
+			assert("gathered in order" && all[g] == g + 1.);
+		}
+		assert("gathered on the root only" && all.size() == ((rank == 0) ? lines * width : 0));
+	}
+}
+
+// same iterations as the sequential solvers, and the same solution
+template<size_t numPoints>
+void checkPoisson1D() {
+	const auto A = poissonStencil<numPoints>();
+	Vector<double, numPoints> b([] (size_t x) { return rhs(x, numPoints); });
+	Workspace<double, numPoints> workspace;
+
+	DistributedGrid<double> grid(MPI_COMM_WORLD, 1, numPoints);
+	DistributedStencil<double> distributedA(grid, A);
+	std::vector<double> distributedB = grid.vector([] (size_t x) { return rhs(x, numPoints); });
+
+	for (bool cg : { false, true }) {
+		Vector<double, numPoints> u(0.0);
+		unsigned int its = cg ? pcg(A, b, u, workspace) : jacobi(A, b, u, workspace);
+
+		std::vector<double> distributedU = grid.vector();
+		unsigned int distributedIts = cg ? distributedCG(distributedA, distributedB, distributedU) : distributedJacobi(distributedA, distributedB, distributedU);
+
+		// the sums are formed in a different order, which may decide the last iteration
+		assert("same iterations as the sequential solver" && distributedIts + 1 >= its && distributedIts <= its + 1);
+
+		std::vector<double> all = grid.gather(distributedU);
+		if (rank == 0) {
+			std::cout << "\t" << numPoints << " grid points: " << (cg ? "CG " : "Jacobi ") << distributedIts
+			          << " iterations, sequential " << its << std::endl;
+			for (size_t x = 0; x < numPoints; ++x) {
+				assert("same solution" && std::abs(all[x] - u(x)) <= 1.e-4 * (1. + std::abs(u(x))));
+			}
+		}
+	}
+}
+
+void test_poisson_1d() {
+	TESTCASE("test_poisson_1d");
+	checkPoisson1D<33>();
+	checkPoisson1D<65>();
+	checkPoisson1D<129>();
+}
+
+// 5-point Laplacian on an nx x ny grid with Dirichlet boundaries: the
+// decomposition must not change the iterations or the solution
+void test_poisson_2d() {
+	TESTCASE("test_poisson_2d");
+	const size_t nx = 17, ny = 23;
+	const double h = 1. / (nx - 1), hSq = h * h;
+	const std::vector<StencilEntry<double>> boundary = { { 0, 1. } };
+	const std::vector<StencilEntry<double>> inner = { { -(int)nx, 1. / hSq }, { -1, 1. / hSq }, { 0, -4. / hSq }, { 1, 1. / hSq }, { (int)nx, 1. / hSq } };
+	auto f = [nx] (size_t g) { return sin(PI * (g % nx) / (nx - 1.)) * cos(0.3 * (g / nx)); };
+
+	DistributedGrid<double> grid(MPI_COMM_WORLD, nx, ny), single(MPI_COMM_SELF, nx, ny);
+	DistributedStencil<double> A(grid, boundary, inner), singleA(single, boundary, inner);
+	const std::vector<double> b = grid.vector(f), singleB = single.vector(f);
+
+	for (bool cg : { false, true }) {
+		std::vector<double> u = grid.vector(), singleU = single.vector();
+		unsigned int its = cg ? distributedCG(A, b, u) : distributedJacobi(A, b, u);
+		unsigned int singleIts = cg ? distributedCG(singleA, singleB, singleU) : distributedJacobi(singleA, singleB, singleU);
+		assert("same iterations as on one rank" && its + 1 >= singleIts && its <= singleIts + 1);
+
+		// the residual computed on the gathered solution is reduced as requested
+		std::vector<double> zero = grid.vector(), r = grid.vector();
+		const double initRes = distributedResidual(A, b, zero, r), finalRes = distributedResidual(A, b, u, r);
+		assert("residual reduced" && finalRes <= 2.e-5 * initRes);
+
+		std::vector<double> all = grid.gather(u);
+		if (rank == 0) {
+			std::cout << "\t" << nx << " x " << ny << " grid points: " << (cg ? "CG " : "Jacobi ") << its
+			          << " iterations, one rank " << singleIts << std::endl;
+			for (size_t g = 0; g < nx * ny; ++g) {
+				const size_t k = single.begin() + g;
+				assert("same solution as on one rank" && std::abs(all[g] - singleU[k]) <= 1.e-4 * (1. + std::abs(singleU[k])));
+			}
+		}
+	}
+}
+
+// solves that do not converge within the limit, or whose residual is not finite, fail on all ranks
+void test_failure() {
+	TESTCASE("test_failure");
+	constexpr size_t numPoints = 65;
+	DistributedGrid<double> grid(MPI_COMM_WORLD, 1, numPoints);
+	DistributedStencil<double> A(grid, poissonStencil<numPoints>());
+	std::vector<double> b = grid.vector([] (size_t x) { return rhs(x, numPoints); });
+
+	for (bool cg : { false, true }) {
+		std::vector<double> u = grid.vector();
+		unsigned int its = cg ? distributedCG(A, b, u, 1.e-5, 5) : distributedJacobi(A, b, u, 1.e-5, 5);
+		assert("limit reached" && its == SOLVE_FAILED);
+	}
+
+	// the point lies on one rank only, the reduction carries it to all others
+	std::vector<double> nan = grid.vector([] (size_t x) { return (x == numPoints / 2) ? std::nan("") : rhs(x, numPoints); });
+	for (bool cg : { false, true }) {
+		std::vector<double> u = grid.vector();
+		unsigned int its = cg ? distributedCG(A, nan, u) : distributedJacobi(A, nan, u);
+		assert("not finite" && its == SOLVE_FAILED);
+	}
+}
+
+int main(int argc, char **argv) {
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	test_exchange();
+	test_poisson_1d();
+	test_poisson_2d();
+	test_failure();
+	if (rank == 0) std::cout << "all tests finished without assertion errors" << std::endl;
+	MPI_Finalize();
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <vector>
+
+#define PI_FFT 3.141592653589793238462643383279502884
+
+/* Complex discrete Fourier transform of a fixed length,
+   X_k = sum_j x_j exp(-2 pi i j k / n). Lengths whose prime factors are all
+   small go through a recursive mixed-radix Cooley-Tukey transform, other
+   lengths through Bluestein's algorithm on top of a power-of-two transform,
+   so every length costs O(n log n). The twiddle factors are computed once
+   per object, which can then be used for any number of transforms */
+template<typename T>
+class FFT {
+private:
+  /* Largest prime factor handled by the mixed-radix recursion */
+  static constexpr std::size_t max_radix = 32;
+
+  /* Transform length */
+  std::size_t n;
+  /* Twiddle factors exp(-2 pi i j / n) */
+  std::vector<std::complex<T>> twiddles;
+  /* Radix used on each level of the recursion */
+  std::vector<std::size_t> radices;
+
+  /* Bluestein's algorithm: power-of-two transform used for the convolution,
+     the chirp exp(pi i j^2 / n) and the transform of the padded chirp */
+  std::unique_ptr<FFT<T>> convolution;
+  std::vector<std::complex<T>> chirp, chirp_transform;
+
+  /* Scratch buffers, so transforms do not allocate */
+  mutable std::vector<std::complex<T>> scratch, convolution_scratch;
+
+  /* Return the smallest prime factor of m */
+  static std::size_t smallestFactor(std::size_t m) {
+    for(std::size_t p = 2; p * p <= m; ++p) {
+      if(m % p == 0) {
+        return p;
+      }
+    }
+
+    return m;
+  }
+
+  /* Transform of length len of the elements in[0], in[stride], ..., written
+     contiguously to out, using the radices from the given level on */
+  void transform(const std::complex<T> *in, std::size_t stride, std::complex<T> *out, std::size_t len, std::size_t level) const {
+    if(len == 1) {
+      out[0] = in[0];
+      return;
+    }
+
+    const std::size_t p = radices[level];
+    const std::size_t m = len / p;
+    /* Twiddle exp(-2 pi i e / len) is twiddles[e * step] */
+    const std::size_t step = n / len;
+
+    /* Decimation in time: transform the p interleaved subsequences */
+    for(std::size_t r = 0; r < p; ++r) {
+      transform(in + r * stride, stride * p, out + r * m, m, level + 1);
+    }
+
+    /* Combine them with a length p transform for each output index k */
+    std::array<std::complex<T>, max_radix> t;
+
+    for(std::size_t k = 0; k < m; ++k) {
+      for(std::size_t r = 0; r < p; ++r) {
+        t[r] = out[r * m + k] * twiddles[(r * k % len) * step];
+      }
+
+      for(std::size_t q = 0; q < p; ++q) {
+        std::complex<T> sum = t[0];
+
+        for(std::size_t r = 1; r < p; ++r) {
+          sum += t[r] * twiddles[(r * q % p) * m * step];
+        }
+
+        out[k + q * m] = sum;
+      }
+    }
+  }
+public:
+  /* FFT constructor, preparing transforms of the given length */
+  explicit FFT(std::size_t length) : n(length), twiddles(length), scratch(length) {
+    for(std::size_t j = 0; j < n; ++j) {
+      twiddles[j] = std::polar<T>(1.0, -2.0 * PI_FFT * j / n);
+    }
+
+    /* Split the length into its prime factors */
+    bool smooth = true;
+
+    for(std::size_t m = n; m > 1;) {
+      std::size_t p = smallestFactor(m);
+      smooth = smooth && p <= max_radix;
+      radices.push_back(p);
+      m /= p;
+    }
+
+    if(smooth) {
+      return;
+    }
+
+    /* Bluestein's algorithm: the transform becomes a convolution with the
+       chirp, which is carried out with a power-of-two transform */
+    std::size_t len = 1;
+
+    while(len < 2 * n - 1) {
+      len *= 2;
+    }
+
+    convolution.reset(new FFT<T>(len));
+    chirp.resize(n);
+    chirp_transform.assign(len, 0.0);
+    convolution_scratch.resize(len);
+
+    for(std::size_t j = 0; j < n; ++j) {
+      /* j^2 is reduced modulo 2n to keep the argument accurate */
+      chirp[j] = std::polar<T>(1.0, PI_FFT * ((j * j) % (2 * n)) / n);
+    }
+
+    chirp_transform[0] = chirp[0];
+
+    for(std::size_t j = 1; j < n; ++j) {
+      chirp_transform[j] = chirp[j];
+      chirp_transform[len - j] = chirp[j];
+    }
+
+    convolution->forward(chirp_transform.data());
+  }
+
+  /* Return the transform length */
+  std::size_t size() const {
+    return n;
+  }
+
+  /* Forward transform of the n elements of x, in place */
+  void forward(std::complex<T> *x) const {
+    if(!convolution) {
+      std::copy(x, x + n, scratch.begin());
+      transform(scratch.data(), 1, x, n, 0);
+      return;
+    }
+
+    /* Bluestein: x_j conj(w_j) convolved with w, times conj(w_k) */
+    const std::size_t len = convolution->size();
+    std::fill(convolution_scratch.begin(), convolution_scratch.end(), 0.0);
+
+    for(std::size_t j = 0; j < n; ++j) {
+      convolution_scratch[j] = x[j] * std::conj(chirp[j]);
+    }
+
+    convolution->forward(convolution_scratch.data());
+
+    for(std::size_t j = 0; j < len; ++j) {
+      convolution_scratch[j] *= chirp_transform[j];
+    }
+
+    convolution->inverse(convolution_scratch.data());
+
+    for(std::size_t k = 0; k < n; ++k) {
+      x[k] = convolution_scratch[k] * std::conj(chirp[k]);
+    }
+  }
+
+  /* Inverse transform of the n elements of x (including the 1 / n factor),
+     in place */
+  void inverse(std::complex<T> *x) const {
+    for(std::size_t j = 0; j < n; ++j) {
+      x[j] = std::conj(x[j]);
+    }
+
+    forward(x);
+
+    for(std::size_t j = 0; j < n; ++j) {
+      x[j] = std::conj(x[j]) / (T)n;
+    }
+  }
+};
+
+/* Type-I discrete sine transform of length m,
+   X_k = sum_j x_j sin(pi (j + 1) (k + 1) / (m + 1)), computed through a
+   complex transform of the odd extension of length 2 (m + 1). Applying it
+   twice gives (m + 1) / 2 times the input */
+template<typename T>
+class DST {
+private:
+  /* Transform length */
+  std::size_t m;
+  /* Transform of the odd extension */
+  FFT<T> fft;
+  /* Odd extension of the input */
+  mutable std::vector<std::complex<T>> extension;
+public:
+  /* DST constructor, preparing transforms of the given length */
+  explicit DST(std::size_t length) : m(length), fft(2 * (length + 1)), extension(2 * (length + 1)) {}
+
+  /* Return the transform length */
+  std::size_t size() const {
+    return m;
+  }
+
+  /* Transform of the elements x[0], x[stride], ..., x[(m - 1) * stride], in
+     place */
+  void transform(T *x, std::size_t stride = 1) const {
+    const std::size_t len = 2 * (m + 1);
+    extension[0] = 0.0;
+    extension[m + 1] = 0.0;
+
+    for(std::size_t j = 0; j < m; ++j) {
+      extension[j + 1] = x[j * stride];
+      extension[len - 1 - j] = -x[j * stride];
+    }
+
+    fft.forward(extension.data());
+
+    /* The transform of the odd extension is -2i times the sine transform */
+    for(std::size_t k = 0; k < m; ++k) {
+      x[k * stride] = -extension[k + 1].imag() / 2.0;
+    }
+  }
+};
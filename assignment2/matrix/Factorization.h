@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "Vector.h"
+#include "Matrix.h"
+#include "../../common/BlockedFactorization.h"
+
+/* LU factorization with partial pivoting, P * A = L * U, of a dense matrix.
+   The factorization is blocked (right-looking): a panel of columns is
+   factorized, the corresponding rows of U are computed, and the trailing
+   matrix is updated block by block, optionally split among threads (see
+   factorize_lu). It costs O(N^3) once, after which every solve costs
+   O(N^2), so systems with many right-hand sides only pay for the
+   factorization once. A singular matrix is reported by failed() */
+template<typename T, std::size_t n>
+class DenseLU {
+private:
+  /* L (unit diagonal, below) and U (on and above the diagonal), row-major.
+     Kept on the heap, as large matrices would not fit on the stack */
+  std::vector<T> lu;
+  /* Row i of the factors corresponds to row pivots[i] of the matrix */
+  std::array<std::size_t, n> pivots;
+  /* Number of row exchanges, for the sign of the determinant */
+  std::size_t exchanges = 0;
+  /* Whether the matrix turned out to be singular */
+  bool singular = false;
+public:
+  /* DenseLU constructor, factorizing the given matrix using the given number
+     of threads for the trailing updates */
+  explicit DenseLU(const Matrix<T, n, n>& A, unsigned threads = 1) : lu(A.values().begin(), A.values().end()) {
+    singular = !factorize_lu(lu.data(), n, pivots.data(), exchanges, threads);
+  }
+
+  /* Check if the factorization failed because the matrix is singular, the
+     factors can not be used then */
+  bool failed() const {
+    return singular;
+  }
+
+  /* Solves A * u = b with the stored factors, returns false and leaves u
+     alone if the factorization failed */
+  bool solve(const Vector<T, n>& b, Vector<T, n>& u) const {
+    if(singular) {
+      return false;
+    }
+
+    /* Forward substitution with L, on the permuted right-hand side. The
+       permuted entries are gathered first, so b and u may be the same */
+    std::array<T, n> y;
+
+    for(std::size_t i = 0; i < n; ++i) {
+      y[i] = b(pivots[i]);
+    }
+
+    for(std::size_t i = 0; i < n; ++i) {
+      T sum = y[i];
+
+      for(std::size_t j = 0; j < i; ++j) {
+        sum -= lu[i * n + j] * y[j];
+      }
+
+      y[i] = sum;
+    }
+
+    /* Backward substitution with U */
+    for(std::size_t i = n; i-- > 0;) {
+      T sum = y[i];
+
+      for(std::size_t j = i + 1; j < n; ++j) {
+        sum -= lu[i * n + j] * u(j);
+      }
+
+      u(i) = sum / lu[i * n + i];
+    }
+
+    return true;
+  }
+
+  /* Solves A * X = B for all columns of B at once, the factorization must
+     not have failed */
+  template<std::size_t m>
+  Matrix<T, n, m> solve(const Matrix<T, n, m>& B) const {
+    assert(!singular && "Solve with a failed LU factorization");
+    Matrix<T, n, m> X(0.0);
+
+    /* Permute the rows of B */
+    for(std::size_t i = 0; i < n; ++i) {
+      for(std::size_t j = 0; j < m; ++j) {
+        X(i, j) = B(pivots[i], j);
+      }
+    }
+
+    /* Forward substitution with L, a whole row of right-hand sides at once */
+    for(std::size_t i = 0; i < n; ++i) {
+      for(std::size_t p = 0; p < i; ++p) {
+        const T factor = lu[i * n + p];
+
+        for(std::size_t j = 0; j < m; ++j) {
+          X(i, j) -= factor * X(p, j);
+        }
+      }
+    }
+
+    /* Backward substitution with U */
+    for(std::size_t i = n; i-- > 0;) {
+      for(std::size_t p = i + 1; p < n; ++p) {
+        const T factor = lu[i * n + p];
+
+        for(std::size_t j = 0; j < m; ++j) {
+          X(i, j) -= factor * X(p, j);
+        }
+      }
+
+      for(std::size_t j = 0; j < m; ++j) {
+        X(i, j) /= lu[i * n + i];
+      }
+    }
+
+    return X;
+  }
+
+  /* Return the determinant of the factorized matrix */
+  T determinant() const {
+    if(singular) {
+      return 0.0;
+    }
+
+    T det = (exchanges % 2 == 0) ? 1.0 : -1.0;
+
+    for(std::size_t i = 0; i < n; ++i) {
+      det *= lu[i * n + i];
+    }
+
+    return det;
+  }
+
+  /* Return the row permutation, row i of L * U is row permutation()[i] of A */
+  const std::array<std::size_t, n>& permutation() const {
+    return pivots;
+  }
+};
+
+/* Cholesky factorization A = L * L^T of a symmetric positive definite dense
+   matrix, of which only the lower triangle is read. Blocked like DenseLU, at
+   half of its cost and without pivoting (see factorize_cholesky). A matrix
+   that is not positive definite is reported by failed() */
+template<typename T, std::size_t n>
+class DenseCholesky {
+private:
+  /* L in the lower triangle, row-major, the upper triangle is not used */
+  std::vector<T> l;
+  /* Whether the matrix turned out not to be positive definite */
+  bool indefinite = false;
+public:
+  /* DenseCholesky constructor, factorizing the given matrix using the given
+     number of threads for the trailing updates. The matrix must be
+     symmetric */
+  explicit DenseCholesky(const Matrix<T, n, n>& A, unsigned threads = 1) : l(A.values().begin(), A.values().end()) {
+    indefinite = !factorize_cholesky(l.data(), n, threads);
+  }
+
+  /* Check if the factorization failed because the matrix is not positive
+     definite, the factor can not be used then */
+  bool failed() const {
+    return indefinite;
+  }
+
+  /* Solves A * u = b with the stored factor, b and u may be the same.
+     Returns false and leaves u alone if the factorization failed */
+  bool solve(const Vector<T, n>& b, Vector<T, n>& u) const {
+    if(indefinite) {
+      return false;
+    }
+
+    /* Forward substitution with L */
+    for(std::size_t i = 0; i < n; ++i) {
+      T sum = b(i);
+
+      for(std::size_t j = 0; j < i; ++j) {
+        sum -= l[i * n + j] * u(j);
+      }
+
+      u(i) = sum / l[i * n + i];
+    }
+
+    /* Backward substitution with L^T, column i of L^T is row i of L */
+    for(std::size_t i = n; i-- > 0;) {
+      u(i) /= l[i * n + i];
+
+      for(std::size_t j = 0; j < i; ++j) {
+        u(j) -= l[i * n + j] * u(i);
+      }
+    }
+
+    return true;
+  }
+
+  /* Solves A * X = B for all columns of B at once, the factorization must
+     not have failed */
+  template<std::size_t m>
+  Matrix<T, n, m> solve(const Matrix<T, n, m>& B) const {
+    assert(!indefinite && "Solve with a failed Cholesky factorization");
+    Matrix<T, n, m> X(B);
+
+    /* Forward substitution with L */
+    for(std::size_t i = 0; i < n; ++i) {
+      for(std::size_t p = 0; p < i; ++p) {
+        const T factor = l[i * n + p];
+
+        for(std::size_t j = 0; j < m; ++j) {
+          X(i, j) -= factor * X(p, j);
+        }
+      }
+
+      for(std::size_t j = 0; j < m; ++j) {
+        X(i, j) /= l[i * n + i];
+      }
+    }
+
+    /* Backward substitution with L^T */
+    for(std::size_t i = n; i-- > 0;) {
+      for(std::size_t j = 0; j < m; ++j) {
+        X(i, j) /= l[i * n + i];
+      }
+
+      for(std::size_t p = 0; p < i; ++p) {
+        const T factor = l[i * n + p];
+
+        for(std::size_t j = 0; j < m; ++j) {
+          X(p, j) -= factor * X(i, j);
+        }
+      }
+    }
+
+    return X;
+  }
+};
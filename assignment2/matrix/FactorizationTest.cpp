@@ -0,0 +1,202 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Factorization.h"
+#include "Jacobi.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+double measureTime(std::function<void( )> toMeasure) {
+	std::chrono::time_point<std::chrono::steady_clock> start, end;
+	start = std::chrono::steady_clock::now( );
+	toMeasure( );
+	end = std::chrono::steady_clock::now( );
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count( );
+}
+
+bool almostEqual(double a, double b, double epsilon = 1e-10) {
+	return std::abs(a - b) <= epsilon * std::max(1.0, std::abs(b));
+}
+
+// regular matrix which needs pivoting, shifted by the given diagonal
+template<size_t n>
+std::unique_ptr<Matrix<double, n, n>> general(double diagonal) {
+	std::unique_ptr<Matrix<double, n, n>> A(new Matrix<double, n, n>(0.0));
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			(*A)(i, j) = std::sin(0.1 + 0.37 * i + 1.3 * j + 0.71 * i * j / n) + (i == j ? diagonal : 0.0);
+		}
+	}
+	return A;
+}
+
+template<size_t n>
+void checkLU() {
+	auto A = general<n>(0.5);
+	Vector<double, n> x([] (size_t i) { return std::cos(0.3 * i); }), u(0.0);
+	Vector<double, n> b = *A * x;
+
+	DenseLU<double, n> lu(*A);
+	lu.solve(b, u);
+	for (size_t i = 0; i < n; ++i) {
+		assert("LU solve" && almostEqual(u(i), x(i), 1e-8));
+	}
+
+	// several right-hand sides at once
+	Matrix<double, n, 3> X(0.0);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < 3; ++j) {
+			X(i, j) = std::sin(0.2 * i + j);
+		}
+	}
+	Matrix<double, n, 3> Y = lu.solve(*A * X);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < 3; ++j) {
+			assert("LU solve for several right-hand sides" && almostEqual(Y(i, j), X(i, j), 1e-8));
+		}
+	}
+
+	// the parallel update performs the same operations on every entry
+	DenseLU<double, n> parallel(*A, 4);
+	Vector<double, n> v(0.0);
+	parallel.solve(b, v);
+	assert("parallel factorization" && u == v);
+}
+
+template<size_t n>
+void checkCholesky() {
+	// B * B^T + n * I is symmetric positive definite
+	auto B = general<n>(0.0);
+	std::unique_ptr<Matrix<double, n, n>> A(new Matrix<double, n, n>(0.0));
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			double sum = (i == j) ? n : 0.0;
+			for (size_t k = 0; k < n; ++k) {
+				sum += (*B)(i, k) * (*B)(j, k);
+			}
+			(*A)(i, j) = sum;
+		}
+	}
+
+	Vector<double, n> x([] (size_t i) { return std::cos(0.3 * i); }), u(0.0);
+	Vector<double, n> b = *A * x;
+	DenseCholesky<double, n> chol(*A);
+	chol.solve(b, u);
+	for (size_t i = 0; i < n; ++i) {
+		assert("Cholesky solve" && almostEqual(u(i), x(i), 1e-8));
+	}
+
+	Matrix<double, n, 2> X(0.0);
+	for (size_t i = 0; i < n; ++i) {
+		X(i, 0) = x(i);
+		X(i, 1) = 1.0;
+	}
+	Matrix<double, n, 2> Y = chol.solve(*A * X);
+	for (size_t i = 0; i < n; ++i) {
+		assert("Cholesky solve for several right-hand sides" && almostEqual(Y(i, 0), x(i), 1e-8) && almostEqual(Y(i, 1), 1.0, 1e-8));
+	}
+
+	DenseCholesky<double, n> parallel(*A, 3);
+	Vector<double, n> v(0.0);
+	parallel.solve(b, v);
+	assert("parallel factorization" && u == v);
+}
+
+// sizes below, at and above the block size
+void test_lu() {
+	TESTCASE("test_lu");
+	checkLU<1>();
+	checkLU<7>();
+	checkLU<64>();
+	checkLU<65>();
+	checkLU<200>();
+
+	Matrix<double, 3, 3> A(std::array<double, 9>{{ 0., 2., 0., 3., 0., 0., 0., 0., 4. }});
+	DenseLU<double, 3> lu(A);
+	assert("pivoting around a zero diagonal" && almostEqual(lu.determinant(), -24.0));
+	assert("permutation" && lu.permutation()[0] == 1 && lu.permutation()[1] == 0);
+	assert("regular" && !lu.failed());
+
+	// singular matrices are reported, the solve leaves u alone
+	Matrix<double, 3, 3> S(std::array<double, 9>{{ 1., 2., 3., 2., 4., 6., 0., 0., 1. }});
+	DenseLU<double, 3> singular(S);
+	Vector<double, 3> b(1.0), u(7.0);
+	assert("singular" && singular.failed() && singular.determinant() == 0.0);
+	assert("no solution" && !singular.solve(b, u) && u(0) == 7.);
+}
+
+void test_cholesky() {
+	TESTCASE("test_cholesky");
+	checkCholesky<1>();
+	checkCholesky<3>();
+	checkCholesky<64>();
+	checkCholesky<130>();
+
+	// matrices that are not positive definite are reported
+	Matrix<double, 2, 2> A(std::array<double, 4>{{ 1., 2., 2., 1. }});
+	DenseCholesky<double, 2> chol(A);
+	Vector<double, 2> b(1.0), u(7.0);
+	assert("indefinite" && chol.failed() && !chol.solve(b, u) && u(0) == 7.);
+	Matrix<double, 2, 2> B(std::array<double, 4>{{ 2., 1., 1., 2. }});
+	const DenseCholesky<double, 2> definite(B);
+	assert("positive definite" && !definite.failed());
+}
+
+// one factorization against a Jacobi solve per right-hand side
+void test_many_rhs() {
+	TESTCASE("test_many_rhs");
+	constexpr size_t n = 150;
+	constexpr size_t count = 10;
+	auto A = general<n>(2.0 * n);
+	Workspace<double, n> workspace;
+	Vector<double, n> b(0.0), u(0.0), v(0.0);
+
+	double jacobiTime = measureTime([&] {
+		for (size_t k = 0; k < count; ++k) {
+			b = Vector<double, n>([k] (size_t i) { return std::sin(0.1 * i * (k + 1)); });
+			u = Vector<double, n>(0.0);
+			jacobi(*A, b, u, workspace, 1e-12);
+		}
+	});
+
+	double luTime = measureTime([&] {
+		DenseLU<double, n> lu(*A);
+		for (size_t k = 0; k < count; ++k) {
+			b = Vector<double, n>([k] (size_t i) { return std::sin(0.1 * i * (k + 1)); });
+			lu.solve(b, v);
+		}
+	});
+
+	for (size_t i = 0; i < n; ++i) {
+		assert("Jacobi and LU agree" && almostEqual(u(i), v(i), 1e-8));
+	}
+	std::cout << "\t" << count << " right-hand sides: Jacobi " << jacobiTime * 1e3 << " ms, LU " << luTime * 1e3 << " ms" << std::endl;
+}
+
+int main() {
+	test_lu();
+	test_cholesky();
+	test_many_rhs();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
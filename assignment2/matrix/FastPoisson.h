@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cmath>
+
+#include "Vector.h"
+#include "Stencil.h"
+#include "FFT.h"
+
+#define PI_POISSON 3.141592653589793238462643383279502884
+
+/* Constant coefficients of a stencil of the form
+     boundary rows: { 0, boundary }
+     inner rows:    { -1, offDiagonal }, { 0, diagonal }, { 1, offDiagonal }
+   i.e. a Dirichlet problem for the 1-D Laplacian (possibly shifted and
+   scaled), which the sine transform diagonalizes. The inner operator
+   tridiag(a, d, a) of m = n - 2 rows has the eigenvalues
+   d + 2 a cos(pi k / (m + 1)) for k = 1..m, none of which may vanish */
+template<typename T>
+struct PoissonCoefficients {
+  T boundary, diagonal, offDiagonal;
+};
+
+/* Return the k-th eigenvalue (counting from 0) of the inner operator of the
+   coefficients for n grid points */
+template<typename T>
+T poissonEigenvalue(const PoissonCoefficients<T>& coefficients, std::size_t k, std::size_t n) {
+  return coefficients.diagonal + 2.0 * coefficients.offDiagonal * cos(PI_POISSON * (k + 1) / (n - 1));
+}
+
+/* Check whether the stencil has the form above and is regular, and return
+   its coefficients. Eigenvalues that vanish up to rounding would make the
+   solve divide by (almost) zero, so such stencils are rejected */
+template<typename T, std::size_t n>
+bool poissonCoefficients(const Stencil<T, n, n>& A, PoissonCoefficients<T>& coefficients) {
+  T boundary = 0.0, lower = 0.0, diagonal = 0.0, upper = 0.0;
+
+  if(n < 3) {
+    return false;
+  }
+
+  /* Boundary rows may only hold the diagonal */
+  for(auto elem : A.boundaryEntries()) {
+    if(elem.first != 0 && elem.second != 0.0) {
+      return false;
+    }
+
+    boundary += (elem.first == 0) ? elem.second : 0.0;
+  }
+
+  /* Inner rows may only couple to their direct neighbours */
+  for(auto elem : A.innerEntries()) {
+    switch(elem.first) {
+      case -1: lower += elem.second; break;
+      case 0: diagonal += elem.second; break;
+      case 1: upper += elem.second; break;
+      default:
+        if(elem.second != 0.0) {
+          return false;
+        }
+    }
+  }
+
+  /* The coupling has to be symmetric, up to rounding */
+  if(boundary == 0.0 || !std::isfinite(boundary) || !std::isfinite(diagonal) || !std::isfinite(upper) ||
+     std::abs(lower - upper) > 1e-12 * std::abs(upper)) {
+    return false;
+  }
+
+  const PoissonCoefficients<T> result = { boundary, diagonal, upper };
+  const T scale = std::abs(diagonal) + 2.0 * std::abs(upper);
+
+  for(std::size_t k = 0; k < n - 2; ++k) {
+    if(std::abs(poissonEigenvalue(result, k, n)) <= 1e-12 * scale) {
+      return false;
+    }
+  }
+
+  coefficients = result;
+  return true;
+}
+
+/* Direct solver for stencils of the form described in PoissonCoefficients.
+   The boundary values follow from the boundary rows, and the remaining
+   n - 2 unknowns are decoupled by a type-I sine transform, so a solve costs
+   O(n log n) */
+template<typename T, std::size_t n>
+class FastPoisson1D {
+private:
+  /* Coefficients of the operator */
+  PoissonCoefficients<T> coefficients;
+  /* Sine transform of the inner unknowns */
+  DST<T> dst;
+  /* Eigenvalues of the inner operator */
+  std::vector<T> eigenvalues;
+  /* Whether the stencil was eligible */
+  bool isEligible;
+public:
+  /* Check whether the solver can be used for the given stencil */
+  static bool eligible(const Stencil<T, n, n>& A) {
+    PoissonCoefficients<T> coefficients;
+    return poissonCoefficients(A, coefficients);
+  }
+
+  /* FastPoisson1D constructor, the solves fail unless the stencil is
+     eligible */
+  explicit FastPoisson1D(const Stencil<T, n, n>& A) : dst(n - 2), eigenvalues(n - 2) {
+    isEligible = poissonCoefficients(A, coefficients);
+
+    for(std::size_t k = 0; isEligible && k < n - 2; ++k) {
+      eigenvalues[k] = poissonEigenvalue(coefficients, k, n);
+    }
+  }
+
+  /* Solves A * u = b, returns false and leaves u alone if the stencil is
+     not eligible */
+  bool solve(const Vector<T, n>& b, Vector<T, n>& u) const {
+    if(!isEligible) {
+      return false;
+    }
+
+    const T a = coefficients.offDiagonal;
+
+    /* Boundary values, which move to the right-hand side of their neighbours */
+    u(0) = b(0) / coefficients.boundary;
+    u(n - 1) = b(n - 1) / coefficients.boundary;
+
+    for(std::size_t i = 1; i < n - 1; ++i) {
+      u(i) = b(i);
+    }
+
+    u(1) -= a * u(0);
+    u(n - 2) -= a * u(n - 1);
+
+    /* Transform, scale with the inverse eigenvalues, transform back */
+    T *inner = &u(1);
+    dst.transform(inner);
+
+    for(std::size_t k = 0; k < n - 2; ++k) {
+      inner[k] *= 2.0 / ((n - 1) * eigenvalues[k]);
+    }
+
+    dst.transform(inner);
+    return true;
+  }
+};
+
+/* Solves A * u = b with FastPoisson1D if the stencil is eligible, and
+   returns whether it was */
+template<typename T, std::size_t n>
+bool fastPoissonSolve(const Stencil<T, n, n>& A, const Vector<T, n>& b, Vector<T, n>& u) {
+  if(!FastPoisson1D<T, n>::eligible(A)) {
+    return false;
+  }
+
+  return FastPoisson1D<T, n>(A).solve(b, u);
+}
+
+/* Direct solver for the 2-D five-point Laplacian on an nx x ny grid with
+   Dirichlet boundaries, stored with x running fastest (index i + j * nx).
+   Following the 1-D convention, boundary points satisfy u = b, and inner
+   points
+     cx (u(i-1, j) + u(i+1, j)) + cy (u(i, j-1) + u(i, j+1)) - 2 (cx + cy) u(i, j) = b(i, j)
+   with cx = 1 / hx^2 and cy = 1 / hy^2. Solves with a 2-D sine transform of
+   the inner points in O(N log N). The eigenvalues are sums of the negative
+   ones of both directions scaled by cx and cy, so the operator is regular
+   if cx and cy are finite and positive; solves fail otherwise */
+template<typename T, std::size_t nx, std::size_t ny>
+class FastPoisson2D {
+private:
+  /* Coupling coefficients in x and y direction */
+  T cx, cy;
+  /* Sine transforms along x and y */
+  DST<T> dstx, dsty;
+  /* Eigenvalues of the 1-D second differences in x and y direction */
+  std::vector<T> eigenvaluesx, eigenvaluesy;
+public:
+  /* Check whether the coefficients give a regular operator */
+  static bool eligible(T cx, T cy) {
+    return cx > 0.0 && cy > 0.0 && std::isfinite(cx) && std::isfinite(cy);
+  }
+
+  /* FastPoisson2D constructor */
+  FastPoisson2D(T cx, T cy) : cx(cx), cy(cy), dstx(nx - 2), dsty(ny - 2), eigenvaluesx(nx - 2), eigenvaluesy(ny - 2) {
+    static_assert(nx >= 3 && ny >= 3, "Grid needs inner points");
+
+    for(std::size_t k = 0; k < nx - 2; ++k) {
+      eigenvaluesx[k] = 2.0 * cx * (cos(PI_POISSON * (k + 1) / (nx - 1)) - 1.0);
+    }
+
+    for(std::size_t k = 0; k < ny - 2; ++k) {
+      eigenvaluesy[k] = 2.0 * cy * (cos(PI_POISSON * (k + 1) / (ny - 1)) - 1.0);
+    }
+  }
+
+  /* Solves A * u = b, returns false and leaves u alone if the coefficients
+     are not eligible */
+  bool solve(const Vector<T, nx * ny>& b, Vector<T, nx * ny>& u) const {
+    if(!eligible(cx, cy)) {
+      return false;
+    }
+
+    /* Boundary values */
+    for(std::size_t i = 0; i < nx; ++i) {
+      u(i) = b(i);
+      u(i + (ny - 1) * nx) = b(i + (ny - 1) * nx);
+    }
+
+    for(std::size_t j = 0; j < ny; ++j) {
+      u(j * nx) = b(j * nx);
+      u(nx - 1 + j * nx) = b(nx - 1 + j * nx);
+    }
+
+    /* Right-hand side of the inner points, with the known boundary values
+       of their neighbours moved over */
+    for(std::size_t j = 1; j < ny - 1; ++j) {
+      for(std::size_t i = 1; i < nx - 1; ++i) {
+        T rhs = b(i + j * nx);
+
+        if(i == 1) rhs -= cx * u(j * nx);
+        if(i == nx - 2) rhs -= cx * u(nx - 1 + j * nx);
+        if(j == 1) rhs -= cy * u(i);
+        if(j == ny - 2) rhs -= cy * u(i + (ny - 1) * nx);
+
+        u(i + j * nx) = rhs;
+      }
+    }
+
+    /* Transform along x (rows) and y (columns), scale, transform back */
+    transform(u);
+
+    const T normalization = 4.0 / ((nx - 1) * (ny - 1));
+
+    for(std::size_t j = 1; j < ny - 1; ++j) {
+      for(std::size_t i = 1; i < nx - 1; ++i) {
+        u(i + j * nx) *= normalization / (eigenvaluesx[i - 1] + eigenvaluesy[j - 1]);
+      }
+    }
+
+    transform(u);
+    return true;
+  }
+
+private:
+  /* 2-D sine transform of the inner points of u, in place */
+  void transform(Vector<T, nx * ny>& u) const {
+    for(std::size_t j = 1; j < ny - 1; ++j) {
+      dstx.transform(&u(1 + j * nx));
+    }
+
+    for(std::size_t i = 1; i < nx - 1; ++i) {
+      dsty.transform(&u(i + nx), nx);
+    }
+  }
+};
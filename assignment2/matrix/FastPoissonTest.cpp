@@ -0,0 +1,232 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "FFT.h"
+#include "FastPoisson.h"
+#include "BandedMatrix.h"
+#include "Factorization.h"
+#include "Jacobi.h"
+
+#define PI 3.141592653589793
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+double measureTime(std::function<void( )> toMeasure) {
+	std::chrono::time_point<std::chrono::steady_clock> start, end;
+	start = std::chrono::steady_clock::now( );
+	toMeasure( );
+	end = std::chrono::steady_clock::now( );
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count( );
+}
+
+bool almostEqual(double a, double b, double epsilon = 1e-10) {
+	return std::abs(a - b) <= epsilon * std::max(1.0, std::abs(b));
+}
+
+// compares the transform against the O(n^2) definition
+void checkFFT(size_t n) {
+	std::vector<std::complex<double>> x(n), expected(n);
+	for (size_t j = 0; j < n; ++j) {
+		x[j] = std::complex<double>(std::sin(0.7 * j + 1.), std::cos(1.3 * j * j));
+	}
+	for (size_t k = 0; k < n; ++k) {
+		for (size_t j = 0; j < n; ++j) {
+			expected[k] += x[j] * std::polar(1.0, -2. * PI * ((j * k) % n) / n);
+		}
+	}
+
+	FFT<double> fft(n);
+	std::vector<std::complex<double>> y = x;
+	fft.forward(y.data());
+	for (size_t k = 0; k < n; ++k) {
+		assert("forward transform" && std::abs(y[k] - expected[k]) < 1e-9 * n);
+	}
+	fft.inverse(y.data());
+	for (size_t j = 0; j < n; ++j) {
+		assert("inverse transform" && std::abs(y[j] - x[j]) < 1e-12 * n);
+	}
+}
+
+void test_fft() {
+	TESTCASE("test_fft");
+	// powers of two, mixed radices and primes beyond the largest radix
+	for (size_t n : { 1, 2, 8, 64, 12, 30, 62, 97, 127, 254, 1009 }) {
+		checkFFT(n);
+	}
+}
+
+void test_dst() {
+	TESTCASE("test_dst");
+	for (size_t m : { 1, 5, 31, 63, 100 }) {
+		std::vector<double> x(m), y(m);
+		for (size_t j = 0; j < m; ++j) {
+			x[j] = std::cos(0.4 * j) + 0.1 * j;
+		}
+		for (size_t k = 0; k < m; ++k) {
+			for (size_t j = 0; j < m; ++j) {
+				y[k] += x[j] * std::sin(PI * (j + 1) * (k + 1) / (m + 1));
+			}
+		}
+
+		DST<double> dst(m);
+		std::vector<double> z = x;
+		dst.transform(z.data());
+		for (size_t k = 0; k < m; ++k) {
+			assert("sine transform" && almostEqual(z[k], y[k], 1e-10 * m));
+		}
+		dst.transform(z.data());
+		for (size_t j = 0; j < m; ++j) {
+			assert("sine transform is its own inverse" && almostEqual(z[j] * 2. / (m + 1), x[j]));
+		}
+	}
+}
+
+template<size_t numPoints>
+void checkPoisson1D() {
+	const double hxSq = 1. / ((numPoints - 1) * (numPoints - 1));
+	Stencil<double, numPoints, numPoints> stencil({ { 0, 1. } }, { { -1, 1. / hxSq },{ 0, -2. / hxSq },{ 1, 1. / hxSq } });
+
+	Vector<double, numPoints> b(0.0);
+	for (size_t x = 0; x < numPoints; ++x) {
+		b(x) = sin(2. * PI * (1. + x / (double)(numPoints - 1))) + cos(PI * (x / (double)(numPoints - 1)));
+	}
+
+	Vector<double, numPoints> u(0.0), r(0.0);
+	FastPoisson1D<double, numPoints> solver(stencil);
+	bool solved = false;
+	double time = measureTime([&] { solved = solver.solve(b, u); });
+	double res = residual(stencil, b, u, r);
+	std::cout << "\t" << numPoints << " grid points solved in " << time * 1e6 << " microseconds, residual " << res << std::endl;
+	assert("fast solve" && solved && res < 1e-8 * b.l2Norm() / hxSq);
+
+	// same solution as the banded LU solve
+	Vector<double, numPoints> uBanded(0.0);
+	BandedMatrix<double, numPoints, numPoints, 1>(stencil).solve(b, uBanded);
+	for (size_t i = 0; i < numPoints; ++i) {
+		assert("banded solve agrees with the fast solution" && almostEqual(uBanded(i), u(i), 1e-8));
+	}
+
+	// same solution as the dense LU solve with partial pivoting
+	std::unique_ptr<Matrix<double, numPoints, numPoints>> dense(new Matrix<double, numPoints, numPoints>([&] (size_t i, size_t j) {
+		if (i == 0 || i == numPoints - 1) {
+			return (i == j) ? 1. : 0.;
+		}
+		return (i == j) ? -2. / hxSq : (i == j + 1 || j == i + 1) ? 1. / hxSq : 0.;
+	}));
+	std::unique_ptr<DenseLU<double, numPoints>> lu(new DenseLU<double, numPoints>(*dense));
+	Vector<double, numPoints> uDense(0.0);
+	assert("dense LU solve" && lu->solve(b, uDense));
+	for (size_t i = 0; i < numPoints; ++i) {
+		assert("dense solve agrees with the fast solution" && almostEqual(uDense(i), u(i), 1e-8));
+	}
+}
+
+void test_poisson_1d() {
+	TESTCASE("test_poisson_1d");
+	checkPoisson1D<33>();
+	checkPoisson1D<65>();
+	checkPoisson1D<193>();
+	// 2 * (n - 1) = 2 * 101 needs Bluestein's algorithm
+	checkPoisson1D<102>();
+
+	// only constant coefficient Dirichlet problems are eligible
+	Stencil<double, 10, 10> neumann({ { 0, 1. },{ 1, -1. } }, { { -1, 1. },{ 0, -2. },{ 1, 1. } });
+	Stencil<double, 10, 10> convection({ { 0, 1. } }, { { -1, 2. },{ 0, -3. },{ 1, 1. } });
+	Stencil<double, 10, 10> wide({ { 0, 1. } }, { { -2, 1. },{ 0, -2. },{ 2, 1. } });
+	Vector<double, 10> b(1.0), u(0.0);
+	assert("boundary coupling is not eligible" && !fastPoissonSolve(neumann, b, u));
+	assert("nonsymmetric stencil is not eligible" && !fastPoissonSolve(convection, b, u));
+	assert("wide stencil is not eligible" && !fastPoissonSolve(wide, b, u));
+
+	// singular operators: no coupling at all, and an eigenvalue -1 + 2 cos(pi 3 / 9) of zero
+	Stencil<double, 10, 10> empty({ { 0, 1. } }, { { 0, 0. } });
+	Stencil<double, 10, 10> singular({ { 0, 1. } }, { { -1, 1. },{ 0, -1. },{ 1, 1. } });
+	const Vector<double, 10> before(u);
+	assert("zero operator is not eligible" && !fastPoissonSolve(empty, b, u) && u == before);
+	assert("zero eigenvalue is not eligible" && !fastPoissonSolve(singular, b, u) && u == before);
+	FastPoisson1D<double, 10> singularSolver(singular);
+	assert("solve of an ineligible stencil fails" && !singularSolver.solve(b, u) && u == before);
+
+	Stencil<double, 10, 10> shifted({ { 0, 2. } }, { { -1, 1. },{ 0, -5. },{ 1, 1. } });
+	Vector<double, 10> r(0.0);
+	assert("shifted Laplacian is eligible" && fastPoissonSolve(shifted, b, u));
+	assert("shifted solve" && residual(shifted, b, u, r) < 1e-12);
+}
+
+// 2-D five-point Laplacian, checked by applying the operator to the solution
+template<size_t nx, size_t ny>
+void checkPoisson2D() {
+	const double cx = (nx - 1) * (nx - 1), cy = (ny - 1) * (ny - 1);
+	Vector<double, nx * ny> b(0.0), u(0.0);
+	for (size_t j = 0; j < ny; ++j) {
+		for (size_t i = 0; i < nx; ++i) {
+			double x = i / (double)(nx - 1), y = j / (double)(ny - 1);
+			bool boundary = i == 0 || j == 0 || i == nx - 1 || j == ny - 1;
+			b(i + j * nx) = boundary ? x * (1. - y) : std::sin(PI * x) * std::cos(3. * y);
+		}
+	}
+
+	FastPoisson2D<double, nx, ny> solver(cx, cy);
+	bool solved = false;
+	double time = measureTime([&] { solved = solver.solve(b, u); });
+	assert("eligible" && solved);
+	std::cout << "\t" << nx << " x " << ny << " grid points solved in " << time * 1e6 << " microseconds" << std::endl;
+
+	for (size_t j = 0; j < ny; ++j) {
+		for (size_t i = 0; i < nx; ++i) {
+			size_t idx = i + j * nx;
+			if (i == 0 || j == 0 || i == nx - 1 || j == ny - 1) {
+				assert("boundary values" && u(idx) == b(idx));
+				continue;
+			}
+			double au = cx * (u(idx - 1) + u(idx + 1)) + cy * (u(idx - nx) + u(idx + nx)) - 2. * (cx + cy) * u(idx);
+			assert("2-D solve" && almostEqual(au, b(idx), 1e-8));
+		}
+	}
+}
+
+void test_poisson_2d() {
+	TESTCASE("test_poisson_2d");
+	checkPoisson2D<33, 33>();
+	checkPoisson2D<65, 17>();
+	checkPoisson2D<129, 129>();
+
+	// coefficients that are not positive make the operator singular or indefinite
+	const Vector<double, 25> b(1.0), before(0.0);
+	Vector<double, 25> u(before);
+	FastPoisson2D<double, 5, 5> zero(0., 0.), mixed(1., -1.);
+	assert("zero coefficients fail" && !zero.solve(b, u) && u == before);
+	assert("mixed signs fail" && !mixed.solve(b, u));
+}
+
+int main() {
+	test_fft();
+	test_dst();
+	test_poisson_1d();
+	test_poisson_2d();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include "Matrix.h"
+#include "Vector.h"
+
+#define PI 3.141592653589793
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+double measureTime(std::function<void( )> toMeasure) {
+	std::chrono::time_point<std::chrono::steady_clock> start, end;
+	start = std::chrono::steady_clock::now( );
+	toMeasure( );
+	end = std::chrono::steady_clock::now( );
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count( );
+}
+
+// the right-hand side of SolverTest
+template<size_t numPoints>
+double rhs(size_t x) {
+	return sin(2. * PI * (1. + x / (double)(numPoints - 1))) + cos(PI * (x / (double)(numPoints - 1)));
+}
+
+// generator constructors take lambdas, function pointers and std::function alike
+void test_constructors() {
+	TESTCASE("test_constructors");
+	constexpr size_t n = 33;
+	Vector<double, n> expected(0.0);
+	for (size_t x = 0; x < n; ++x) {
+		expected(x) = rhs<n>(x);
+	}
+
+	using VectorN = Vector<double, n>;
+	using Matrix34 = Matrix<double, 3, 4>;
+	std::function<double(size_t)> typeErased = rhs<n>;
+	assert("from a lambda" && VectorN([] (size_t x) { return rhs<n>(x); }) == expected);
+	assert("from a function" && VectorN(rhs<n>) == expected);
+	assert("from a std::function" && VectorN(typeErased) == expected);
+	assert("on several threads" && VectorN(rhs<n>, 4) == expected);
+	assert("values still fill" && VectorN(2.0)(n - 1) == 2.0 && VectorN(0)(0) == 0.0);
+
+	Matrix34 m([] (size_t i, size_t j) { return j * 100. + i; });
+	for (size_t i = 0; i < 3; ++i) {
+		for (size_t j = 0; j < 4; ++j) {
+			assert("matrix from a lambda" && m(i, j) == j * 100. + i);
+		}
+	}
+	assert("matrix values still fill" && Matrix34(1.5)(2, 3) == 1.5);
+}
+
+// fills split among threads give the elements of a serial fill
+void test_parallel_fill() {
+	TESTCASE("test_parallel_fill");
+	constexpr size_t n = 1 << 20;
+	std::unique_ptr<Vector<double, n>> serial(new Vector<double, n>(0.0)), v(new Vector<double, n>(0.0));
+	serial->generate(rhs<n>);
+	for (unsigned threads : { 1u, 2u, 3u, 4u }) {
+		v->fill(-1.0, threads);
+		for (size_t i = 0; i < n; ++i) {
+			assert("filled" && (*v)(i) == -1.0);
+		}
+		v->generate(rhs<n>, threads);
+		assert("same elements" && *v == *serial);
+		v->iota(2.0, 0.5, threads);
+		for (size_t i = 0; i < n; ++i) {
+			assert("iota" && (*v)(i) == 2.0 + i * 0.5);
+		}
+	}
+
+	constexpr size_t rows = 700, cols = 500;
+	std::unique_ptr<Matrix<double, rows, cols>> m(new Matrix<double, rows, cols>(0.0));
+	for (unsigned threads : { 1u, 4u }) {
+		m->iota(1.0, 1.0, threads);
+		for (size_t i = 0; i < rows; ++i) {
+			for (size_t j = 0; j < cols; ++j) {
+				assert("row-major iota" && (*m)(i, j) == 1.0 + i * cols + j);
+			}
+		}
+		m->fill(3.0, threads);
+		assert("filled matrix" && (*m)(0, 0) == 3.0 && (*m)(rows - 1, cols - 1) == 3.0);
+		m->generate([] (size_t i, size_t j) { return i == j ? 1.0 : 0.0; }, threads);
+		assert("identity" && (*m)(5, 5) == 1.0 && (*m)(5, 6) == 0.0);
+	}
+}
+
+// the setup cost of a large right-hand side
+void test_timing() {
+	TESTCASE("test_timing");
+	constexpr size_t n = 1 << 22;
+	std::unique_ptr<Vector<double, n>> v(new Vector<double, n>(0.0));
+	std::function<double(size_t)> typeErased = rhs<n>;
+
+	double loop = measureTime([&] { for (size_t x = 0; x < n; ++x) (*v)(x) = typeErased(x); });
+	double serial = measureTime([&] { v->generate([] (size_t x) { return rhs<n>(x); }); });
+	double parallel = measureTime([&] { v->generate([] (size_t x) { return rhs<n>(x); }, 4); });
+	double fill = measureTime([&] { v->fill(0.0); });
+	std::cout << "\t" << n << " elements: std::function " << loop << "s, inlined " << serial << "s, 4 threads "
+	          << parallel << "s, fill " << fill << "s" << std::endl;
+}
+
+int main() {
+	test_constructors();
+	test_parallel_fill();
+	test_timing();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+
+/* Matrix-free operator given by a callable computing row i of the product,
+   f(u, i) = (A * u)_i, and the diagonal of A, which the callable does not
+   reveal. The callable is a template parameter instead of a std::function,
+   so the products call it directly and it is inlined into their loop over
+   the rows. Branches of the callable on the first and last row do not keep
+   the inner rows from vectorizing, as in a Stencil. Operators that are
+   never assembled, e.g. with variable coefficients, then run in any of the
+   solvers at the speed of a Stencil, e.g.
+
+     FunctionOperator A([&] (const Vector<double, n>& u, std::size_t i) {
+       return k(i) * u(i - 1) + ... ;
+     }, diagonal);
+*/
+template<typename T, std::size_t n, class Function>
+class FunctionOperator : public MatrixLike<T, FunctionOperator<T, n, Function>, n, n> {
+private:
+  /* Row function, and the diagonal of the operator */
+  Function f;
+  Vector<T, n> diag;
+  /* Set for the inverse diagonal, which only scales by diag and never calls f */
+  bool diagonalOnly;
+
+  FunctionOperator(const Function& f, const Vector<T, n>& diagonal, bool diagonalOnly)
+    : f(f), diag(diagonal), diagonalOnly(diagonalOnly) {}
+public:
+  /* FunctionOperator constructor */
+  FunctionOperator(Function f, const Vector<T, n>& diagonal)
+    : f(std::move(f)), diag(diagonal), diagonalOnly(false) {}
+
+  /* FunctionOperator destructor */
+  ~FunctionOperator() noexcept override {}
+
+  /* Matrix-Vector product */
+  Vector<T, n> operator *(const Vector<T, n> &v) const override {
+    /* Result vector */
+    Vector<T, n> result(0.0);
+    apply(v, result);
+    return result;
+  }
+
+  /* Matrix-Vector product written into an existing vector */
+  void apply(const Vector<T, n> &v, Vector<T, n> &result) const override {
+    if(diagonalOnly) {
+      for(std::size_t i = 0; i < n; ++i) {
+        result(i) = diag(i) * v(i);
+      }
+
+      return;
+    }
+
+    /* The first and last row are peeled off, so that once f is inlined the
+       compiler drops its boundary checks from the loop over the inner rows */
+    result(0) = f(v, 0);
+
+    for(std::size_t i = 1; i < n - 1; ++i) {
+      result(i) = f(v, i);
+    }
+
+    if(n > 1) {
+      result(n - 1) = f(v, n - 1);
+    }
+  }
+
+  /* Returns the inverse diagonal as an operator of the same type */
+  FunctionOperator<T, n, Function> inverseDiagonal() const override {
+    Vector<T, n> inverse(0.0);
+
+    for(std::size_t i = 0; i < n; ++i) {
+      inverse(i) = 1.0 / diag(i);
+    }
+
+    return FunctionOperator<T, n, Function>(f, inverse, true);
+  }
+
+  /* Return the diagonal of the operator */
+  const Vector<T, n>& diagonal() const {
+    return diag;
+  }
+};
+
+/* Take T and n from the diagonal, so FunctionOperator A(f, diagonal) works */
+template<typename T, std::size_t n, class Function>
+FunctionOperator(Function, const Vector<T, n>&) -> FunctionOperator<T, n, Function>;
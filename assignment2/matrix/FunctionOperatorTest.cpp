@@ -0,0 +1,136 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "CG.h"
+#include "FunctionOperator.h"
+#include "TestProblems.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+double measureTime(std::function<void( )> toMeasure) {
+	std::chrono::time_point<std::chrono::steady_clock> start, end;
+	start = std::chrono::steady_clock::now( );
+	toMeasure( );
+	end = std::chrono::steady_clock::now( );
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count( );
+}
+
+bool almostEqual(double a, double b, double epsilon = 1e-10) {
+	return std::abs(a - b) <= epsilon * std::max(1.0, std::abs(b));
+}
+
+// the Poisson stencil of SolverTest as a function, summed in the order of the stencil kernel
+template<size_t numPoints>
+auto poissonFunction() {
+	const double hxSq = 1. / ((numPoints - 1) * (numPoints - 1));
+	const double side = 1. / hxSq, center = -2. / hxSq;
+	Vector<double, numPoints> diagonal(center);
+	diagonal(0) = 1.;
+	diagonal(numPoints - 1) = 1.;
+	return FunctionOperator([side, center] (const Vector<double, numPoints>& u, size_t i) {
+		if (i == 0 || i == numPoints - 1) {
+			return u(i);
+		}
+		return ((0. + u(i - 1) * side) + u(i) * center) + u(i + 1) * side;
+	}, diagonal);
+}
+
+// same products, iterations and solutions as the stencil
+template<size_t numPoints>
+void checkPoisson(unsigned int jacobiIts) {
+	const double hxSq = 1. / ((numPoints - 1) * (numPoints - 1));
+	Stencil<double, numPoints, numPoints> stencil({ { 0, 1. } }, { { -1, 1. / hxSq },{ 0, -2. / hxSq },{ 1, 1. / hxSq } });
+	const auto A = poissonFunction<numPoints>();
+	const auto b = rhs<numPoints>();
+	assert("product matches the stencil" && A * b == stencil * b);
+	assert("inverse diagonal matches the stencil" && A.inverseDiagonal() * b == stencil.inverseDiagonal() * b);
+
+	Workspace<double, numPoints> workspace;
+	Vector<double, numPoints> stencilU(0.0), u(0.0);
+	double stencilTime = measureTime([&] { assert("stencil iterations" && jacobi(stencil, b, stencilU, workspace) == jacobiIts); });
+	double time = measureTime([&] { assert("same Jacobi iterations" && jacobi(A, b, u, workspace) == jacobiIts); });
+	assert("same Jacobi solution" && u == stencilU);
+	std::cout << "\t" << numPoints << " grid points, Jacobi in " << time << "s, stencil in " << stencilTime << "s" << std::endl;
+
+	stencilU = Vector<double, numPoints>(0.0);
+	u = Vector<double, numPoints>(0.0);
+	assert("same CG iterations" && pcg(A, b, u, workspace) == pcg(stencil, b, stencilU, workspace));
+	assert("same CG solution" && u == stencilU);
+}
+
+void test_poisson() {
+	TESTCASE("test_poisson");
+	checkPoisson<33>(743);
+	checkPoisson<65>(2982);
+	checkPoisson<193>(26874);
+}
+
+// a variable coefficient operator -(k u')' that has no stencil, against the assembled matrix
+void test_variable_coefficients() {
+	TESTCASE("test_variable_coefficients");
+	constexpr size_t n = 65;
+	const double hxSq = 1. / ((n - 1) * (n - 1));
+	// coefficient between point i - 1 and i
+	const Vector<double, n + 1> k([] (size_t i) { return 1. + 0.5 * sin(0.1 * i); });
+
+	std::unique_ptr<Matrix<double, n, n>> dense(new Matrix<double, n, n>(0.));
+	(*dense)(0, 0) = 1.;
+	(*dense)(n - 1, n - 1) = 1.;
+	for (size_t i = 1; i < n - 1; ++i) {
+		(*dense)(i, i - 1) = -k(i) / hxSq;
+		(*dense)(i, i) = (k(i) + k(i + 1)) / hxSq;
+		(*dense)(i, i + 1) = -k(i + 1) / hxSq;
+	}
+
+	Vector<double, n> diagonal([&] (size_t i) { return (*dense)(i, i); });
+	FunctionOperator A([&k, hxSq] (const Vector<double, n>& u, size_t i) {
+		if (i == 0 || i == n - 1) {
+			return u(i);
+		}
+		return (k(i) * (u(i) - u(i - 1)) - k(i + 1) * (u(i + 1) - u(i))) / hxSq;
+	}, diagonal);
+
+	const Vector<double, n> x([] (size_t i) { return std::cos(0.3 * i) + 0.1 * i; });
+	const Vector<double, n> ax = A * x, dx = (*dense) * x;
+	const Vector<double, n> ix = A.inverseDiagonal() * x, idx = dense->inverseDiagonal() * x;
+	for (size_t i = 0; i < n; ++i) {
+		assert("product matches the matrix" && almostEqual(ax(i), dx(i)));
+		assert("inverse diagonal matches the matrix" && almostEqual(ix(i), idx(i)));
+	}
+
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+	Vector<double, n> u(0.0), r(0.0);
+	pcg(A, b, u, workspace, 1.e-10);
+	assert("solved" && residual(*dense, b, u, r) <= 1.e-8 * b.l2Norm());
+}
+
+int main() {
+	test_poisson();
+	test_variable_coefficients();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
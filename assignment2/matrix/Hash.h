@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Start value of the 64 bit FNV-1a hash */
+constexpr std::uint64_t HASH_OFFSET = 14695981039346656037ull;
+
+/* Continue the 64 bit FNV-1a hash with the given bytes. It is not meant to
+   withstand deliberate collisions, only to tell files and operators apart */
+inline std::uint64_t hashBytes(const void *data, std::size_t size, std::uint64_t hash = HASH_OFFSET) {
+  const unsigned char *begin = static_cast<const unsigned char *>(data);
+
+  for(std::size_t i = 0; i < size; ++i) {
+    hash = (hash ^ begin[i]) * 1099511628211ull;
+  }
+
+  return hash;
+}
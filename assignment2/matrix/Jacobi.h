@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Workspace.h"
+#include "Steppable.h"
+#include "Snapshot.h"
+#include "Telemetry.h"
+
+/* Computes r = b - A * u and returns the L2 norm of r */
+template<typename T, class MatrixImpl, std::size_t n>
+double residual(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n>& b,
+  const Vector<T, n>& u,
+  Vector<T, n>& r) {
+
+  A.apply(u, r);
+
+  /* Form the residual and its squared norm in the same pass */
+  double sum = 0.0;
+
+  for(std::size_t i = 0; i < n; ++i) {
+    r(i) = b(i) - r(i);
+    sum += r(i) * r(i);
+  }
+
+  return sqrt(sum);
+}
+
+/* Resumable Jacobi solver drawing all of its temporaries from the given
+   workspace, see Steppable. A, b, u and the workspace have to outlive it,
+   and the workspace must not be used by other solves in the meantime.
+   Solves until the residual is reduced by the given factor, recording the
+   residuals and the phases in the telemetry if one is given. Its state is
+   u with the residual norms, the residual is recomputed on resume */
+template<typename T, class MatrixImpl, std::size_t n>
+class JacobiStepper : public Steppable, public Checkpointable {
+private:
+  /* Problem and scratch storage */
+  const MatrixLike<T, MatrixImpl, n, n>& A;
+  const Vector<T, n>& b;
+  Vector<T, n>& u;
+  Workspace<T, n>& workspace;
+  double tolerance;
+  SolverTelemetry *telemetry;
+  /* Inverse diagonal and residual, taken from the workspace on the first step */
+  const Vector<T, n> *invDiag = nullptr;
+  Vector<T, n> *r = nullptr;
+  /* Initial and current residual norm, and the iterations done */
+  double initRes = 0.0, curRes = 0.0;
+  unsigned int curIt = 0;
+
+  /* Take the storage from the workspace and compute the residual of u */
+  void setup() {
+    invDiag = &workspace.inverseDiagonal(A);
+    r = &workspace.vector(0);
+    curRes = residual(A, b, u, *r);
+  }
+public:
+  /* JacobiStepper constructor, the work starts with the first step */
+  JacobiStepper(
+    const MatrixLike<T, MatrixImpl, n, n>& A,
+    const Vector<T, n>& b,
+    Vector<T, n>& u,
+    Workspace<T, n>& workspace,
+    double tolerance = 1.e-5,
+    SolverTelemetry *telemetry = nullptr)
+    : A(A), b(b), u(u), workspace(workspace), tolerance(tolerance), telemetry(telemetry) {}
+
+  bool step(unsigned int count) override {
+    if(r == nullptr) {
+      TELEMETRY(telemetry, begin("setup"));
+      setup();
+      initRes = curRes; // determine the initial residual
+      TELEMETRY(telemetry, end("setup", 0, curRes));
+    }
+
+    TELEMETRY(telemetry, begin("iterate", curIt));
+
+    const Vector<T, n>& d = *invDiag;
+    Vector<T, n>& res = *r;
+
+    for(unsigned int k = 0; k < count && !converged() && !failed(); ++k) {
+      ++curIt;
+
+      /* Jacobi step */
+      for(std::size_t i = 0; i < n; ++i) {
+        u(i) += d(i) * res(i);
+      }
+
+      curRes = residual(A, b, u, res); // update the residual
+      TELEMETRY(telemetry, residual(curIt, curRes));
+    }
+
+    TELEMETRY(telemetry, end("iterate", curIt, curRes));
+    return converged();
+  }
+
+  bool converged() const override {
+    return r != nullptr && curRes <= tolerance * initRes;
+  }
+
+  unsigned int iterations() const override {
+    return curIt;
+  }
+
+  bool failed() const override {
+    return r != nullptr && !std::isfinite(curRes);
+  }
+
+  /* Return the current residual norm */
+  double residualNorm() const {
+    return curRes;
+  }
+
+  SolverSnapshot snapshot() const override {
+    SolverSnapshot state;
+    state.solver = "jacobi";
+    state.iterations = curIt;
+    state.problem = problemHash(A, b);
+    state.scalars = { initRes, curRes };
+    state.addVector(u);
+    return state;
+  }
+
+  bool resume(const SolverSnapshot& state) override {
+    if(!state.matches("jacobi", problemHash(A, b), 2, 1, n)) {
+      return false;
+    }
+
+    state.copyVector(0, u);
+    setup();
+    curIt = state.iterations;
+    initRes = state.scalars[0];
+    curRes = state.scalars[1];
+    return true;
+  }
+};
+
+/* Jacobi solver drawing all of its temporaries from the given workspace, so
+   once the workspace is set up the iterations do not allocate. Solves until
+   the residual is reduced by the given factor and returns the number of
+   iterations required, or SOLVE_FAILED if that takes more than
+   maxIterations */
+template<typename T, class MatrixImpl, std::size_t n>
+unsigned int jacobi(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n>& b,
+  Vector<T, n>& u,
+  Workspace<T, n>& workspace,
+  double tolerance = 1.e-5,
+  SolverTelemetry *telemetry = nullptr,
+  unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+
+  JacobiStepper<T, MatrixImpl, n> stepper(A, b, u, workspace, tolerance, telemetry);
+  return solveSteps(stepper, maxIterations);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "../../common/CpuDispatch.h"
+
+/* Vector kernels behind Matrix, Stencil and Vector, built for every
+   instruction set level of common/CpuDispatch.h. The *Body functions hold the code,
+   the *Kernel functions pick the build for the level selected at startup.
+   All builds perform the same operations in the same order, so they give
+   identical results */
+
+/* Number of partial sums of the reductions: the sums are independent, so they
+   fill the vector lanes, and the summation order does not depend on the
+   instruction set */
+constexpr std::size_t KERNEL_PARTIAL_SUMS = 8;
+
+/* Returns sum_i a[i] * b[i] */
+template<typename T>
+ISA_KERNEL T dotBody(const T *a, const T *b, std::size_t n) {
+  T partial[KERNEL_PARTIAL_SUMS] = {};
+  const std::size_t blocked = n - n % KERNEL_PARTIAL_SUMS;
+
+  for(std::size_t i = 0; i < blocked; i += KERNEL_PARTIAL_SUMS) {
+    for(std::size_t k = 0; k < KERNEL_PARTIAL_SUMS; ++k) {
+      partial[k] += a[i + k] * b[i + k];
+    }
+  }
+
+  T sum = 0.0;
+
+  for(std::size_t k = 0; k < KERNEL_PARTIAL_SUMS; ++k) {
+    sum += partial[k];
+  }
+
+  for(std::size_t i = blocked; i < n; ++i) {
+    sum += a[i] * b[i];
+  }
+
+  return sum;
+}
+
+/* y = A * x for the row-major rows x cols matrix A */
+template<typename T>
+ISA_KERNEL void matvecBody(const T *a, const T *x, T *y, std::size_t rows, std::size_t cols) {
+  for(std::size_t i = 0; i < rows; ++i) {
+    y[i] = dotBody(a + i * cols, x, cols);
+  }
+}
+
+/* y[i] = sum_k coefficient_k * x[i + offset_k] for i in [first, last), the
+   entries are added in their given order */
+template<typename T>
+ISA_KERNEL void stencilBody(
+  const T *x, T *y, std::size_t first, std::size_t last,
+  const std::pair<int, T> *entries, std::size_t count) {
+
+  for(std::size_t i = first; i < last; ++i) {
+    y[i] = 0.0;
+  }
+
+  /* One sweep per entry, the sweeps vectorize without reordering the sums */
+  for(std::size_t k = 0; k < count; ++k) {
+    const T *shifted = x + entries[k].first;
+    const T coefficient = entries[k].second;
+
+    for(std::size_t i = first; i < last; ++i) {
+      y[i] += coefficient * shifted[i];
+    }
+  }
+}
+
+/* Builds of the kernels for each instruction set level */
+template<typename T>
+T dotSSE2(const T *a, const T *b, std::size_t n) {
+  return dotBody(a, b, n);
+}
+
+template<typename T>
+ISA_TARGET_AVX2 T dotAVX2(const T *a, const T *b, std::size_t n) {
+  return dotBody(a, b, n);
+}
+
+template<typename T>
+ISA_TARGET_AVX512 T dotAVX512(const T *a, const T *b, std::size_t n) {
+  return dotBody(a, b, n);
+}
+
+template<typename T>
+void matvecSSE2(const T *a, const T *x, T *y, std::size_t rows, std::size_t cols) {
+  matvecBody(a, x, y, rows, cols);
+}
+
+template<typename T>
+ISA_TARGET_AVX2 void matvecAVX2(const T *a, const T *x, T *y, std::size_t rows, std::size_t cols) {
+  matvecBody(a, x, y, rows, cols);
+}
+
+template<typename T>
+ISA_TARGET_AVX512 void matvecAVX512(const T *a, const T *x, T *y, std::size_t rows, std::size_t cols) {
+  matvecBody(a, x, y, rows, cols);
+}
+
+template<typename T>
+void stencilSSE2(const T *x, T *y, std::size_t first, std::size_t last, const std::pair<int, T> *entries, std::size_t count) {
+  stencilBody(x, y, first, last, entries, count);
+}
+
+template<typename T>
+ISA_TARGET_AVX2 void stencilAVX2(const T *x, T *y, std::size_t first, std::size_t last, const std::pair<int, T> *entries, std::size_t count) {
+  stencilBody(x, y, first, last, entries, count);
+}
+
+template<typename T>
+ISA_TARGET_AVX512 void stencilAVX512(const T *x, T *y, std::size_t first, std::size_t last, const std::pair<int, T> *entries, std::size_t count) {
+  stencilBody(x, y, first, last, entries, count);
+}
+
+/* Returns sum_i a[i] * b[i], with the build for the given level */
+template<typename T>
+T dotKernel(const T *a, const T *b, std::size_t n, IsaLevel level = isa_level()) {
+  return isa_dispatch(level, dotSSE2<T>, dotAVX2<T>, dotAVX512<T>, a, b, n);
+}
+
+/* y = A * x for the row-major rows x cols matrix A, with the build for the
+   given level. y must not share memory with A or x */
+template<typename T>
+void matvecKernel(const T *a, const T *x, T *y, std::size_t rows, std::size_t cols, IsaLevel level = isa_level()) {
+  isa_dispatch(level, matvecSSE2<T>, matvecAVX2<T>, matvecAVX512<T>, a, x, y, rows, cols);
+}
+
+/* Stencil application to the elements [first, last), see stencilBody, with
+   the build for the given level. y must not share memory with x */
+template<typename T>
+void stencilKernel(
+  const T *x, T *y, std::size_t first, std::size_t last,
+  const std::pair<int, T> *entries, std::size_t count, IsaLevel level = isa_level()) {
+
+  isa_dispatch(level, stencilSSE2<T>, stencilAVX2<T>, stencilAVX512<T>, x, y, first, last, entries, count);
+}
@@ -0,0 +1,693 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "Steppable.h"
+#include "Snapshot.h"
+#include "Telemetry.h"
+
+/* Default number of GMRES iterations between restarts */
+constexpr unsigned int GMRES_RESTART = 30;
+
+/* Dot products of BiCGSTAB below this fraction of the product of the norms
+   of their vectors count as breakdown */
+constexpr double BICGSTAB_BREAKDOWN = 1.e-12;
+
+/* Side the Jacobi preconditioner D^-1 (see MatrixLike::inverseDiagonal) is
+   applied on by the Krylov solvers for nonsymmetric operators */
+enum class Preconditioning {
+  /* Krylov space of A */
+  None,
+  /* Krylov space of D^-1 A, the residuals minimized are scaled by D^-1 */
+  Left,
+  /* Krylov space of A D^-1, for the solution D u, the residuals are those of A */
+  Right
+};
+
+/* Computes result = A * x, D^-1 A * x or A D^-1 * x, the operator whose
+   Krylov space is built for the given preconditioning, using tmp */
+template<typename T, class MatrixImpl, std::size_t n>
+void krylovProduct(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n> *invDiag,
+  Preconditioning preconditioning,
+  const Vector<T, n>& x,
+  Vector<T, n>& result,
+  Vector<T, n>& tmp) {
+
+  if(preconditioning == Preconditioning::Right) {
+    for(std::size_t i = 0; i < n; ++i) {
+      tmp(i) = (*invDiag)(i) * x(i);
+    }
+
+    A.apply(tmp, result);
+    return;
+  }
+
+  A.apply(x, result);
+
+  if(preconditioning == Preconditioning::Left) {
+    for(std::size_t i = 0; i < n; ++i) {
+      result(i) *= (*invDiag)(i);
+    }
+  }
+}
+
+/* Resumable restarted GMRES(m) solver for nonsymmetric operators, drawing
+   all of its temporaries from the given workspace, see Steppable. Each
+   iteration extends the Krylov basis by one vector, orthogonalized with
+   classical Gram-Schmidt and a second pass (CGS2), which is as stable as
+   modified Gram-Schmidt. Each pass takes one sweep over the basis for all
+   dot products and one for all updates, instead of one sweep per basis
+   vector. The basis is m + 1 vectors of the workspace and the Hessenberg
+   matrix is allocated with the stepper, so the iterations do not allocate.
+   u is only updated at the end of a cycle, when the Givens rotations
+   estimate the residual to be small enough or after m iterations, and the
+   solve converges when the true residual is reduced by the given factor.
+   A, b, u and the workspace have to outlive the stepper, and the workspace
+   must not be used by other solves in the meantime. Records the residual
+   estimates and the phases in the telemetry if one is given.
+   Restarts lose the Krylov space built so far, which stalls the iteration
+   when the residual norm it minimizes is dominated by a few rows, like the
+   Dirichlet rows next to the 1 / h^2 scaled inner rows of the stencils.
+   Left preconditioning balances the rows and is the default. A cycle that
+   does not change u at all leaves the next cycle the same residual, the
+   solve then fails instead of repeating it. A restart of 0 counts as 1. Its
+   state is u, the residual and the basis with the Hessenberg matrix, the
+   rotations and the residual norms, so a snapshot may be taken mid-cycle */
+template<typename T, class MatrixImpl, std::size_t n>
+class GMRESStepper : public Steppable, public Checkpointable {
+private:
+  /* Problem and scratch storage */
+  const MatrixLike<T, MatrixImpl, n, n>& A;
+  const Vector<T, n>& b;
+  Vector<T, n>& u;
+  Workspace<T, n>& workspace;
+  unsigned int restart;
+  Preconditioning preconditioning;
+  double tolerance;
+  SolverTelemetry *telemetry;
+  /* Inverse diagonal (only with preconditioning), residual and Krylov
+     basis, taken from the workspace on the first step */
+  const Vector<T, n> *invDiag = nullptr;
+  Vector<T, n> *r = nullptr;
+  std::vector<Vector<T, n> *> basis;
+  /* Hessenberg matrix by columns, reduced to upper triangular form by the
+     Givens rotations, and the rotated right-hand side */
+  std::vector<double> h, cs, sn, g;
+  /* Dot products of a Gram-Schmidt pass */
+  std::vector<double> dots;
+  /* Initial and current true residual norm, the estimated residual norm of
+     the iterated system and its target in the current cycle */
+  double initRes = 0.0, curRes = 0.0, estimate = 0.0, target = 0.0;
+  /* Iterations done, in total and in the current cycle */
+  unsigned int curIt = 0, cycleIt = 0;
+  /* Whether the last cycle left u unchanged */
+  bool stalled = false;
+
+  /* Return entry (i, j) of the Hessenberg matrix */
+  double& hessenberg(unsigned int i, unsigned int j) {
+    return h[j * (restart + 1) + i];
+  }
+
+  /* Take the storage from the workspace */
+  void setup() {
+    if(preconditioning != Preconditioning::None) {
+      invDiag = &workspace.inverseDiagonal(A);
+    }
+
+    r = &workspace.vector(0);
+    workspace.reserve(restart + 3);
+
+    for(unsigned int k = 0; k <= restart; ++k) {
+      basis.push_back(&workspace.vector(k + 2));
+    }
+  }
+
+  /* Number of scalars of a snapshot: the norms, the counters and the
+     settings, then h, cs, sn and g */
+  std::size_t snapshotScalars() const {
+    return 9 + h.size() + cs.size() + sn.size() + g.size();
+  }
+
+  /* Start a cycle from the current residual */
+  void startCycle() {
+    Vector<T, n>& v = *basis[0];
+
+    for(std::size_t i = 0; i < n; ++i) {
+      v(i) = (preconditioning == Preconditioning::Left) ? (*invDiag)(i) * (*r)(i) : (*r)(i);
+    }
+
+    const double beta = v.l2Norm();
+
+    for(std::size_t i = 0; i < n; ++i) {
+      v(i) /= beta;
+    }
+
+    std::fill(g.begin(), g.end(), 0.0);
+    g[0] = beta;
+    estimate = beta;
+    /* Left preconditioning scales the residuals, the target is scaled alike */
+    target = tolerance * initRes * beta / curRes;
+    cycleIt = 0;
+  }
+
+  /* One pass of classical Gram-Schmidt of w against the first count basis
+     vectors, adding the coefficients to column j of the Hessenberg matrix */
+  void orthogonalize(Vector<T, n>& w, unsigned int count, unsigned int j) {
+    std::fill(dots.begin(), dots.begin() + count, 0.0);
+
+    for(std::size_t i = 0; i < n; ++i) {
+      const double wi = w(i);
+
+      for(unsigned int k = 0; k < count; ++k) {
+        dots[k] += (*basis[k])(i) * wi;
+      }
+    }
+
+    for(std::size_t i = 0; i < n; ++i) {
+      double wi = w(i);
+
+      for(unsigned int k = 0; k < count; ++k) {
+        wi -= dots[k] * (*basis[k])(i);
+      }
+
+      w(i) = wi;
+    }
+
+    for(unsigned int k = 0; k < count; ++k) {
+      hessenberg(k, j) += dots[k];
+    }
+  }
+
+  /* Extend the basis by one vector, returns false on breakdown, when the
+     Krylov space is invariant and the cycle holds the exact solution */
+  bool arnoldi() {
+    const unsigned int j = cycleIt;
+    Vector<T, n>& w = *basis[j + 1];
+
+    krylovProduct(A, invDiag, preconditioning, *basis[j], w, workspace.vector(1));
+
+    for(unsigned int k = 0; k <= j + 1; ++k) {
+      hessenberg(k, j) = 0.0;
+    }
+
+    orthogonalize(w, j + 1, j);
+    orthogonalize(w, j + 1, j);
+
+    const double norm = w.l2Norm();
+    hessenberg(j + 1, j) = norm;
+
+    if(norm > 0.0) {
+      for(std::size_t i = 0; i < n; ++i) {
+        w(i) /= norm;
+      }
+    }
+
+    /* Apply the previous rotations to the new column, and eliminate its
+       subdiagonal entry with a new one */
+    for(unsigned int k = 0; k < j; ++k) {
+      const double upper = hessenberg(k, j), lower = hessenberg(k + 1, j);
+      hessenberg(k, j) = cs[k] * upper + sn[k] * lower;
+      hessenberg(k + 1, j) = -sn[k] * upper + cs[k] * lower;
+    }
+
+    const double diagonal = hessenberg(j, j), denominator = std::hypot(diagonal, norm);
+    cs[j] = diagonal / denominator;
+    sn[j] = norm / denominator;
+    hessenberg(j, j) = denominator;
+    hessenberg(j + 1, j) = 0.0;
+    g[j + 1] = -sn[j] * g[j];
+    g[j] = cs[j] * g[j];
+
+    estimate = std::abs(g[j + 1]);
+    cycleIt = j + 1;
+    return norm > 0.0;
+  }
+
+  /* Update u with the solution of the cycle and compute the true residual */
+  void finishCycle() {
+    /* Solve the triangular system for the coefficients, kept in g */
+    for(unsigned int k = cycleIt; k-- > 0;) {
+      for(unsigned int l = k + 1; l < cycleIt; ++l) {
+        g[k] -= hessenberg(k, l) * g[l];
+      }
+
+      g[k] /= hessenberg(k, k);
+    }
+
+    stalled = std::all_of(g.begin(), g.begin() + cycleIt, [] (double coefficient) { return coefficient == 0.0; });
+
+    for(std::size_t i = 0; i < n; ++i) {
+      double correction = 0.0;
+
+      for(unsigned int k = 0; k < cycleIt; ++k) {
+        correction += g[k] * (*basis[k])(i);
+      }
+
+      u(i) += (preconditioning == Preconditioning::Right) ? (*invDiag)(i) * correction : correction;
+    }
+
+    curRes = residual(A, b, u, *r);
+  }
+public:
+  /* GMRESStepper constructor, restarting after the given number of
+     iterations, the work starts with the first step */
+  GMRESStepper(
+    const MatrixLike<T, MatrixImpl, n, n>& A,
+    const Vector<T, n>& b,
+    Vector<T, n>& u,
+    Workspace<T, n>& workspace,
+    Preconditioning preconditioning = Preconditioning::Left,
+    unsigned int restart = GMRES_RESTART,
+    double tolerance = 1.e-5,
+    SolverTelemetry *telemetry = nullptr)
+    : A(A), b(b), u(u), workspace(workspace), restart(std::max(restart, 1u)), preconditioning(preconditioning),
+      tolerance(tolerance), telemetry(telemetry), h((this->restart + 1) * this->restart), cs(this->restart),
+      sn(this->restart), g(this->restart + 1), dots(this->restart + 1) {}
+
+  bool step(unsigned int count) override {
+    if(r == nullptr) {
+      TELEMETRY(telemetry, begin("setup"));
+      setup();
+      initRes = residual(A, b, u, *r); // determine the initial residual
+      curRes = initRes;
+
+      if(!converged() && !failed()) {
+        startCycle();
+      }
+
+      TELEMETRY(telemetry, end("setup", 0, curRes));
+    }
+
+    TELEMETRY(telemetry, begin("iterate", curIt));
+
+    for(unsigned int k = 0; k < count && !converged() && !failed(); ++k) {
+      ++curIt;
+
+      const bool extended = arnoldi();
+      TELEMETRY(telemetry, residual(curIt, estimate));
+
+      if(estimate <= target || cycleIt == restart || !extended) {
+        finishCycle();
+
+        if(!converged() && !failed()) {
+          startCycle();
+        }
+      }
+    }
+
+    TELEMETRY(telemetry, end("iterate", curIt, curRes));
+    return converged();
+  }
+
+  bool converged() const override {
+    return r != nullptr && curRes <= tolerance * initRes;
+  }
+
+  unsigned int iterations() const override {
+    return curIt;
+  }
+
+  bool failed() const override {
+    return r != nullptr && !converged() && (stalled || !std::isfinite(curRes));
+  }
+
+  /* Return the true residual norm at the end of the last cycle */
+  double residualNorm() const {
+    return curRes;
+  }
+
+  SolverSnapshot snapshot() const override {
+    SolverSnapshot state;
+    state.solver = "gmres";
+    state.iterations = curIt;
+    state.problem = problemHash(A, b);
+    state.scalars = { initRes, curRes, estimate, target, (double)cycleIt, (double)restart, (double)preconditioning,
+                      (double)stalled, (double)(r != nullptr) };
+
+    for(const std::vector<double> *values : { &h, &cs, &sn, &g }) {
+      state.scalars.insert(state.scalars.end(), values->begin(), values->end());
+    }
+
+    state.addVector(u);
+
+    for(unsigned int k = 0; k < restart + 2; ++k) {
+      state.addVector(workspace.vector(k == 0 ? 0 : k + 1));
+    }
+
+    return state;
+  }
+
+  bool resume(const SolverSnapshot& state) override {
+    if(!state.matches("gmres", problemHash(A, b), snapshotScalars(), restart + 3, n) ||
+       state.scalars[5] != restart || state.scalars[6] != (double)preconditioning || !(state.scalars[4] <= restart)) {
+      return false;
+    }
+
+    state.copyVector(0, u);
+    curIt = state.iterations;
+
+    /* Not started yet, the first step starts from u */
+    if(state.scalars[8] == 0.0) {
+      return true;
+    }
+
+    if(r == nullptr) {
+      setup();
+    }
+
+    state.copyVector(1, *r);
+
+    for(unsigned int k = 0; k <= restart; ++k) {
+      state.copyVector(k + 2, *basis[k]);
+    }
+
+    initRes = state.scalars[0];
+    curRes = state.scalars[1];
+    estimate = state.scalars[2];
+    target = state.scalars[3];
+    cycleIt = (unsigned int)state.scalars[4];
+    stalled = state.scalars[7] != 0.0;
+    auto next = state.scalars.begin() + 9;
+
+    for(std::vector<double> *values : { &h, &cs, &sn, &g }) {
+      std::copy(next, next + values->size(), values->begin());
+      next += values->size();
+    }
+
+    return true;
+  }
+};
+
+/* Resumable BiCGSTAB solver for nonsymmetric operators, drawing all of its
+   temporaries from the given workspace, see Steppable. Each iteration takes
+   two operator applications and four dot products, but only six vectors of
+   storage however many iterations it takes. The recurrence residual of the
+   iterated system is checked against the target, after which the true
+   residual decides: the solve converges when it is reduced by the given
+   factor, otherwise the recurrence restarts from it. The recurrence also
+   restarts when it breaks down, i.e. a dot product it divides by vanishes
+   (see BICGSTAB_BREAKDOWN) or a coefficient is not finite, and the solve
+   fails if it breaks down again before its first iteration. A, b, u and the
+   workspace have to outlive the stepper, and the workspace must not be used
+   by other solves in the meantime. Records the residuals of the iterated
+   system and the phases in the telemetry if one is given. Its state is u,
+   the residual, the shadow residual, p and v with the coefficients of the
+   recurrence and the residual norms */
+template<typename T, class MatrixImpl, std::size_t n>
+class BiCGSTABStepper : public Steppable, public Checkpointable {
+private:
+  /* Problem and scratch storage */
+  const MatrixLike<T, MatrixImpl, n, n>& A;
+  const Vector<T, n>& b;
+  Vector<T, n>& u;
+  Workspace<T, n>& workspace;
+  Preconditioning preconditioning;
+  double tolerance;
+  SolverTelemetry *telemetry;
+  /* Inverse diagonal, only with preconditioning */
+  const Vector<T, n> *invDiag = nullptr;
+  /* Initial and current true residual norm, the residual norm of the
+     iterated system and its target */
+  double initRes = 0.0, curRes = 0.0, estimate = 0.0, target = 0.0;
+  /* Coefficients of the recurrence, and the norm of the shadow residual */
+  double rho = 1.0, alpha = 1.0, omega = 1.0, shadowNorm = 0.0;
+  /* Iterations done, in total and since the last restart */
+  unsigned int curIt = 0, restartIt = 0;
+  bool started = false, done = false, brokenDown = false;
+
+  /* Restart after a breakdown, which fails if the recurrence did not get
+     past its first iteration since the last restart */
+  void breakdown() {
+    if(restartIt <= 1) {
+      brokenDown = true;
+      return;
+    }
+
+    restartFrom();
+  }
+
+  /* Return the scaling of corrections to u */
+  T scale(std::size_t i) const {
+    return (preconditioning == Preconditioning::Right) ? (*invDiag)(i) : 1.0;
+  }
+
+  /* Compute the true residual of u and restart the recurrence from it,
+     r is the residual of the iterated system, the shadow residual and the
+     search direction start from it */
+  void restartFrom() {
+    Vector<T, n>& r = workspace.vector(0);
+    Vector<T, n>& shadow = workspace.vector(1);
+    Vector<T, n>& p = workspace.vector(2);
+    Vector<T, n>& v = workspace.vector(3);
+
+    curRes = residual(A, b, u, r);
+    done = curRes <= tolerance * initRes;
+
+    if(preconditioning == Preconditioning::Left) {
+      for(std::size_t i = 0; i < n; ++i) {
+        r(i) *= (*invDiag)(i);
+      }
+    }
+
+    shadow = r;
+    p = Vector<T, n>(0.0);
+    v = Vector<T, n>(0.0);
+    rho = alpha = omega = 1.0;
+    estimate = shadowNorm = r.l2Norm();
+    restartIt = 0;
+    /* Left preconditioning scales the residuals, the target is scaled alike */
+    target = tolerance * initRes * ((curRes > 0.0) ? estimate / curRes : 1.0);
+  }
+public:
+  /* BiCGSTABStepper constructor, the work starts with the first step */
+  BiCGSTABStepper(
+    const MatrixLike<T, MatrixImpl, n, n>& A,
+    const Vector<T, n>& b,
+    Vector<T, n>& u,
+    Workspace<T, n>& workspace,
+    Preconditioning preconditioning = Preconditioning::Right,
+    double tolerance = 1.e-5,
+    SolverTelemetry *telemetry = nullptr)
+    : A(A), b(b), u(u), workspace(workspace), preconditioning(preconditioning), tolerance(tolerance), telemetry(telemetry) {}
+
+  bool step(unsigned int count) override {
+    Vector<T, n>& r = workspace.vector(0);
+    Vector<T, n>& shadow = workspace.vector(1);
+    Vector<T, n>& p = workspace.vector(2);
+    Vector<T, n>& v = workspace.vector(3);
+    Vector<T, n>& t = workspace.vector(4);
+    Vector<T, n>& tmp = workspace.vector(5);
+
+    if(!started) {
+      TELEMETRY(telemetry, begin("setup"));
+
+      if(preconditioning != Preconditioning::None) {
+        invDiag = &workspace.inverseDiagonal(A);
+      }
+
+      initRes = residual(A, b, u, r); // determine the initial residual
+      restartFrom();
+      started = true;
+      TELEMETRY(telemetry, end("setup", 0, curRes));
+    }
+
+    TELEMETRY(telemetry, begin("iterate", curIt));
+
+    for(unsigned int k = 0; k < count && !converged() && !failed(); ++k) {
+      ++curIt;
+      ++restartIt;
+
+      double rhoNew = 0.0;
+
+      for(std::size_t i = 0; i < n; ++i) {
+        rhoNew += shadow(i) * r(i);
+      }
+
+      /* The shadow residual became orthogonal to the residual */
+      if(!(std::abs(rhoNew) > BICGSTAB_BREAKDOWN * shadowNorm * estimate)) {
+        breakdown();
+        continue;
+      }
+
+      const double beta = (rhoNew / rho) * (alpha / omega);
+      rho = rhoNew;
+
+      for(std::size_t i = 0; i < n; ++i) {
+        p(i) = r(i) + beta * (p(i) - omega * v(i));
+      }
+
+      krylovProduct(A, invDiag, preconditioning, p, v, tmp);
+      double shadowV = 0.0, vv = 0.0;
+
+      for(std::size_t i = 0; i < n; ++i) {
+        shadowV += shadow(i) * v(i);
+        vv += v(i) * v(i);
+      }
+
+      alpha = rho / shadowV;
+
+      /* The shadow residual is orthogonal to the search direction */
+      if(!(std::abs(shadowV) > BICGSTAB_BREAKDOWN * shadowNorm * sqrt(vv)) || !std::isfinite(alpha)) {
+        breakdown();
+        continue;
+      }
+
+      /* r becomes s = r - alpha v */
+      for(std::size_t i = 0; i < n; ++i) {
+        u(i) += alpha * scale(i) * p(i);
+        r(i) -= alpha * v(i);
+      }
+
+      krylovProduct(A, invDiag, preconditioning, r, t, tmp);
+      double ts = 0.0, tt = 0.0;
+
+      for(std::size_t i = 0; i < n; ++i) {
+        ts += t(i) * r(i);
+        tt += t(i) * t(i);
+      }
+
+      omega = (tt > 0.0) ? ts / tt : 0.0;
+
+      if(!std::isfinite(omega)) {
+        breakdown();
+        continue;
+      }
+
+      double rr = 0.0;
+
+      for(std::size_t i = 0; i < n; ++i) {
+        u(i) += omega * scale(i) * r(i);
+        r(i) -= omega * t(i);
+        rr += r(i) * r(i);
+      }
+
+      estimate = sqrt(rr);
+      TELEMETRY(telemetry, residual(curIt, estimate));
+
+      /* Check the true residual once the recurrence one is small enough, or
+         restart when the recurrence stagnates */
+      if(estimate <= target || omega == 0.0) {
+        restartFrom();
+      }
+    }
+
+    TELEMETRY(telemetry, end("iterate", curIt, curRes));
+    return converged();
+  }
+
+  bool converged() const override {
+    return started && done;
+  }
+
+  unsigned int iterations() const override {
+    return curIt;
+  }
+
+  bool failed() const override {
+    return started && !done && (brokenDown || !std::isfinite(curRes));
+  }
+
+  /* Return the true residual norm at the last check */
+  double residualNorm() const {
+    return curRes;
+  }
+
+  SolverSnapshot snapshot() const override {
+    SolverSnapshot state;
+    state.solver = "bicgstab";
+    state.iterations = curIt;
+    state.problem = problemHash(A, b);
+    state.scalars = { initRes, curRes, estimate, target, rho, alpha, omega, shadowNorm, (double)restartIt,
+                      (double)preconditioning, (double)started, (double)done, (double)brokenDown };
+    state.addVector(u);
+
+    for(std::size_t k = 0; k < 4; ++k) {
+      state.addVector(workspace.vector(k));
+    }
+
+    return state;
+  }
+
+  bool resume(const SolverSnapshot& state) override {
+    if(!state.matches("bicgstab", problemHash(A, b), 13, 5, n) || state.scalars[9] != (double)preconditioning) {
+      return false;
+    }
+
+    state.copyVector(0, u);
+    curIt = state.iterations;
+
+    /* Not started yet, the first step starts from u */
+    if(state.scalars[10] == 0.0) {
+      return true;
+    }
+
+    if(preconditioning != Preconditioning::None) {
+      invDiag = &workspace.inverseDiagonal(A);
+    }
+
+    workspace.reserve(6);
+
+    for(std::size_t k = 0; k < 4; ++k) {
+      state.copyVector(k + 1, workspace.vector(k));
+    }
+
+    initRes = state.scalars[0];
+    curRes = state.scalars[1];
+    estimate = state.scalars[2];
+    target = state.scalars[3];
+    rho = state.scalars[4];
+    alpha = state.scalars[5];
+    omega = state.scalars[6];
+    shadowNorm = state.scalars[7];
+    restartIt = (unsigned int)state.scalars[8];
+    started = true;
+    done = state.scalars[11] != 0.0;
+    brokenDown = state.scalars[12] != 0.0;
+    return true;
+  }
+};
+
+/* Restarted GMRES(m) solver, see GMRESStepper. Solves until the residual is
+   reduced by the given factor and returns the number of iterations required,
+   or SOLVE_FAILED if that takes more than maxIterations */
+template<typename T, class MatrixImpl, std::size_t n>
+unsigned int gmres(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n>& b,
+  Vector<T, n>& u,
+  Workspace<T, n>& workspace,
+  Preconditioning preconditioning = Preconditioning::Left,
+  unsigned int restart = GMRES_RESTART,
+  double tolerance = 1.e-5,
+  SolverTelemetry *telemetry = nullptr,
+  unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+
+  GMRESStepper<T, MatrixImpl, n> stepper(A, b, u, workspace, preconditioning, restart, tolerance, telemetry);
+  return solveSteps(stepper, maxIterations);
+}
+
+/* BiCGSTAB solver, see BiCGSTABStepper. Solves until the residual is reduced
+   by the given factor and returns the number of iterations required, or
+   SOLVE_FAILED if that takes more than maxIterations */
+template<typename T, class MatrixImpl, std::size_t n>
+unsigned int bicgstab(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n>& b,
+  Vector<T, n>& u,
+  Workspace<T, n>& workspace,
+  Preconditioning preconditioning = Preconditioning::Right,
+  double tolerance = 1.e-5,
+  SolverTelemetry *telemetry = nullptr,
+  unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+
+  BiCGSTABStepper<T, MatrixImpl, n> stepper(A, b, u, workspace, preconditioning, tolerance, telemetry);
+  return solveSteps(stepper, maxIterations);
+}
@@ -0,0 +1,206 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "Workspace.h"
+#include "Factorization.h"
+#include "Jacobi.h"
+#include "Krylov.h"
+#include "TestProblems.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// -u'' + c u' with the convection term upwinded (upwind) or central differenced
+template<size_t numPoints>
+Stencil<double, numPoints, numPoints> convectionStencil(double c, bool upwind) {
+	const double hx = 1. / (numPoints - 1), hxSq = hx * hx;
+	if (upwind) {
+		return Stencil<double, numPoints, numPoints>({ { 0, 1. } }, { { -1, -1. / hxSq - c / hx },{ 0, 2. / hxSq + c / hx },{ 1, -1. / hxSq } });
+	}
+	return Stencil<double, numPoints, numPoints>({ { 0, 1. } }, { { -1, -1. / hxSq - c / (2. * hx) },{ 0, 2. / hxSq },{ 1, -1. / hxSq + c / (2. * hx) } });
+}
+
+const char *name(Preconditioning preconditioning) {
+	return (preconditioning == Preconditioning::None) ? "none" : (preconditioning == Preconditioning::Left) ? "left" : "right";
+}
+
+// all solvers and preconditionings converge, returns the largest iteration count
+// of full GMRES and BiCGSTAB
+template<typename T, class MatrixImpl, size_t numPoints>
+unsigned int solveAll(const MatrixLike<T, MatrixImpl, numPoints, numPoints>& A, const Vector<T, numPoints>& b) {
+	Workspace<T, numPoints> workspace;
+	unsigned int most = 0;
+	for (Preconditioning preconditioning : { Preconditioning::None, Preconditioning::Left, Preconditioning::Right }) {
+		Vector<T, numPoints> u(0.0);
+		const unsigned int gmresIts = gmres(A, b, u, workspace, preconditioning, numPoints);
+		checkConverged(A, b, u);
+		u = Vector<T, numPoints>(0.0);
+		const unsigned int bicgstabIts = bicgstab(A, b, u, workspace, preconditioning);
+		checkConverged(A, b, u);
+		std::cout << "\t\tpreconditioning " << name(preconditioning) << ": GMRES " << gmresIts << ", BiCGSTAB "
+		          << bicgstabIts << " iterations" << std::endl;
+		most = std::max(most, std::max(gmresIts, bicgstabIts));
+	}
+
+	// the restarted one, with the default left preconditioning that balances the rows
+	Vector<T, numPoints> u(0.0);
+	const unsigned int restartedIts = gmres(A, b, u, workspace);
+	checkConverged(A, b, u);
+	std::cout << "\t\tGMRES(" << GMRES_RESTART << ") " << restartedIts << " iterations" << std::endl;
+	return most;
+}
+
+// the upwinded operator is an M-matrix, where Jacobi converges, but slowly
+template<size_t numPoints>
+void checkUpwind() {
+	const auto A = convectionStencil<numPoints>(20., true);
+	const auto b = rhs<numPoints>();
+	Workspace<double, numPoints> workspace;
+	Vector<double, numPoints> u(0.0);
+	const unsigned int jacobiIts = jacobi(A, b, u, workspace);
+	checkConverged(A, b, u);
+	std::cout << "\t" << numPoints << " grid points, upwind convection: Jacobi " << jacobiIts << " iterations" << std::endl;
+	assert("far fewer iterations than Jacobi" && 10 * solveAll(A, b) < jacobiIts);
+}
+
+void test_upwind() {
+	TESTCASE("test_upwind");
+	checkUpwind<65>();
+	checkUpwind<129>();
+}
+
+// central differences at a cell Peclet number of 3, where Jacobi diverges
+void test_central() {
+	TESTCASE("test_central");
+	constexpr size_t n = 65;
+	const auto A = convectionStencil<n>(6. * (n - 1), false);
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+
+	Vector<double, n> u(0.0);
+	JacobiStepper<double, Stencil<double, n, n>, n> jacobiStepper(A, b, u, workspace);
+	jacobiStepper.step(1);
+	const double first = jacobiStepper.residualNorm();
+	jacobiStepper.step(200);
+	assert("Jacobi diverges" && !jacobiStepper.converged() && jacobiStepper.residualNorm() > 1.e3 * first);
+
+	std::cout << "\t" << n << " grid points, central convection" << std::endl;
+	solveAll(A, b);
+}
+
+// with a restart beyond the problem size, GMRES takes at most N iterations
+void test_full_gmres() {
+	TESTCASE("test_full_gmres");
+	constexpr size_t n = 40;
+	std::unique_ptr<Matrix<double, n, n>> A(new Matrix<double, n, n>([] (size_t i, size_t j) {
+		return (i == j) ? 3. + 0.1 * i : 1. / (1. + 3. * i + j) - ((j == i + 1) ? 1. : 0.);
+	}));
+	const Vector<double, n> b([] (size_t i) { return cos(0.4 * i); });
+	Vector<double, n> expected(0.0);
+	DenseLU<double, n>(*A).solve(b, expected);
+
+	Workspace<double, n> workspace;
+	for (Preconditioning preconditioning : { Preconditioning::None, Preconditioning::Left, Preconditioning::Right }) {
+		Vector<double, n> u(0.0);
+		assert("at most N iterations" && gmres(*A, b, u, workspace, preconditioning, n, 1.e-12) <= n);
+		for (size_t i = 0; i < n; ++i) {
+			assert("direct solution" && std::abs(u(i) - expected(i)) <= 1.e-9 * (1. + std::abs(expected(i))));
+		}
+	}
+	solveAll(*A, b);
+}
+
+// stepping in slices of any size gives the iterations and the solution of the blocking solvers
+void test_slices() {
+	TESTCASE("test_slices");
+	constexpr size_t n = 129;
+	const auto A = convectionStencil<n>(20., true);
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+
+	Vector<double, n> gmresU(0.0), bicgstabU(0.0);
+	const unsigned int gmresIts = gmres(A, b, gmresU, workspace, Preconditioning::Left, 10);
+	const unsigned int bicgstabIts = bicgstab(A, b, bicgstabU, workspace);
+
+	for (unsigned int slice : { 1u, 7u, 1000u }) {
+		Vector<double, n> u(0.0);
+		GMRESStepper<double, Stencil<double, n, n>, n> gmresStepper(A, b, u, workspace, Preconditioning::Left, 10);
+		while (!gmresStepper.step(slice)) {}
+		assert("same GMRES iterations" && gmresStepper.iterations() == gmresIts);
+		assert("same GMRES solution" && u == gmresU);
+
+		u = Vector<double, n>(0.0);
+		BiCGSTABStepper<double, Stencil<double, n, n>, n> bicgstabStepper(A, b, u, workspace);
+		while (!bicgstabStepper.step(slice)) {}
+		assert("same BiCGSTAB iterations" && bicgstabStepper.iterations() == bicgstabIts);
+		assert("same BiCGSTAB solution" && u == bicgstabU);
+	}
+
+	// a zero residual to start from takes no iterations
+	const Vector<double, n> zero(0.0);
+	Vector<double, n> u(0.0);
+	assert("converged start" && gmres(A, zero, u, workspace) == 0 && bicgstab(A, zero, u, workspace) == 0 && u == zero);
+}
+
+// the cyclic shift makes restarted GMRES stagnate and BiCGSTAB break down, both fail
+void test_failure() {
+	TESTCASE("test_failure");
+	constexpr size_t n = 20;
+	Matrix<double, n, n> A([] (size_t i, size_t j) { return (i == (j + 1) % n) ? 1. : 0.; });
+	const Vector<double, n> b([] (size_t i) { return (i == 0) ? 1. : 0.; });
+	const Vector<double, n> zero(0.0);
+	Workspace<double, n> workspace;
+
+	Vector<double, n> u(0.0);
+	GMRESStepper<double, Matrix<double, n, n>, n> gmresStepper(A, b, u, workspace, Preconditioning::None, 5);
+	assert("GMRES stagnates" && !gmresStepper.step(STEP_ALL) && gmresStepper.failed() && gmresStepper.iterations() == 5);
+	u = Vector<double, n>(0.0);
+	assert("GMRES reported as failed" && gmres(A, b, u, workspace, Preconditioning::None, 5) == SOLVE_FAILED);
+
+	u = Vector<double, n>(0.0);
+	BiCGSTABStepper<double, Matrix<double, n, n>, n> bicgstabStepper(A, b, u, workspace, Preconditioning::None);
+	assert("BiCGSTAB breaks down" && !bicgstabStepper.step(STEP_ALL) && bicgstabStepper.failed() && bicgstabStepper.iterations() == 1);
+	assert("no NaN in the solution" && u == zero);
+	assert("BiCGSTAB reported as failed" && bicgstab(A, b, u, workspace, Preconditioning::None) == SOLVE_FAILED);
+
+	// full GMRES solves it in n iterations, fewer are not enough
+	u = Vector<double, n>(0.0);
+	assert("limit reached" && gmres(A, b, u, workspace, Preconditioning::None, n, 1.e-5, nullptr, n - 1) == SOLVE_FAILED);
+	u = Vector<double, n>(0.0);
+	assert("solved within n iterations" && gmres(A, b, u, workspace, Preconditioning::None, n, 1.e-5, nullptr, n) == n);
+	checkConverged(A, b, u);
+
+	// a restart of 0 iterates like GMRES(1) instead of indexing past its storage
+	const auto C = convectionStencil<n>(20., true);
+	Vector<double, n> zeroRestartU(0.0), oneRestartU(0.0);
+	const unsigned int zeroRestartIts = gmres(C, b, zeroRestartU, workspace, Preconditioning::Left, 0, 1.e-5, nullptr, 100);
+	const unsigned int oneRestartIts = gmres(C, b, oneRestartU, workspace, Preconditioning::Left, 1, 1.e-5, nullptr, 100);
+	assert("restart 0 counts as 1" && zeroRestartIts == oneRestartIts && zeroRestartU == oneRestartU);
+}
+
+int main() {
+	test_upwind();
+	test_central();
+	test_full_gmres();
+	test_slices();
+	test_failure();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
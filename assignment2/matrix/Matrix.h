@@ -1,6 +1,9 @@
 #include <iostream>
+#include <type_traits>
 #include "Vector.h"
 #include "MatrixLike.h"
+#include "SmallKernels.h"
+#include "Kernels.h"
 
 #pragma once
 
@@ -26,6 +29,16 @@ public:
     }
   }
 
+  /* Matrix constructor, setting element (i, j) to initFunc(i, j), with the
+     rows split among the given number of threads */
+  template<class Generator, std::enable_if_t<std::is_invocable_r_v<T, Generator&, std::size_t, std::size_t>, int> = 0>
+  Matrix(Generator initFunc, unsigned threads = 1) {
+    generate(initFunc, threads);
+  }
+
+  /* Matrix constructor, taking the elements in row-major order */
+  explicit Matrix(const std::array<T, nrows * ncols>& values) : data(values) {}
+
   /* Matrix destructor */
   ~Matrix() {}
 
@@ -54,6 +67,30 @@ public:
     return *this;
   }
 
+  /* Set element (i, j) to f(i, j), on the given number of threads. f is
+     called concurrently for large matrices, so it must not modify shared
+     state */
+  template<class Generator>
+  void generate(Generator f, unsigned threads = 1) {
+    parallelChunks(0, nrows, ncols, FILL_PARALLEL_MIN, threads, [this, &f] (std::size_t first, std::size_t last) {
+      for(std::size_t i = first; i < last; ++i) {
+        for(std::size_t j = 0; j < ncols; ++j) {
+          data[i * ncols + j] = f(i, j);
+        }
+      }
+    });
+  }
+
+  /* Set all elements to the given value */
+  void fill(T value, unsigned threads = 1) {
+    generate([value] (std::size_t, std::size_t) { return value; }, threads);
+  }
+
+  /* Set the elements, in row-major order, to start, start + step, ... */
+  void iota(T start = 0.0, T step = 1.0, unsigned threads = 1) {
+    generate([start, step] (std::size_t i, std::size_t j) { return start + static_cast<T>(i * ncols + j) * step; }, threads);
+  }
+
   /* Return reference from the specified index */
   inline T& operator()(int i, int j) {
     return data[i * ncols + j];
@@ -168,6 +205,12 @@ public:
   /* Product assignment operator */
   template<std::size_t mncols>
   Matrix<T, nrows, mncols>& operator *=(const Matrix<T, ncols, mncols>& m) {
+    /* Small products go through the unrolled kernel */
+    if constexpr (use_small_kernel<nrows, ncols, mncols>) {
+      data = small_product<T, nrows, ncols, mncols>(data, m.values());
+      return *this;
+    }
+
     std::array<T, nrows * ncols> old_data(data);
 
     /* Go through each element of the result matrix */
@@ -192,6 +235,11 @@ public:
   /* Matrix product */
   template<std::size_t mncols>
   Matrix<T, nrows, mncols> operator *(const Matrix<T, ncols, mncols>& m) const {
+    /* Small products go through the unrolled kernel */
+    if constexpr (use_small_kernel<nrows, ncols, mncols>) {
+      return Matrix<T, nrows, mncols>(small_product<T, nrows, ncols, mncols>(data, m.values()));
+    }
+
     /* Result matrix */
     Matrix<T, nrows, mncols> result(0.0);
 
@@ -215,18 +263,22 @@ public:
   Vector<T, nrows> operator *(const Vector<T, nrows> &v) const {
     /* Result vector */
     Vector<T, nrows> result(0.0);
+    apply(v, result);
+    return result;
+  }
 
-    /* Go through each element of the result vector */
-    for(std::size_t i = 0; i < nrows; ++i) {
-      /* Perform the vector product by going through all the j columns in the
-         current line i for the matrix, and through all the j lines in the
-         vector, the result is the summation of the products of each iteration */
-      for(std::size_t j = 0; j < ncols; ++j) {
-        result(i) += data[i * ncols + j] * v(j);
-      }
+  /* Matrix-Vector product written into an existing vector */
+  void apply(const Vector<T, nrows> &v, Vector<T, nrows> &result) const {
+    /* Small products go through the unrolled kernel */
+    if constexpr (nrows == ncols && use_small_kernel<nrows, ncols, 1>) {
+      result = Vector<T, nrows>(small_product<T, nrows, ncols>(data, v.values()));
+      return;
     }
 
-    return result;
+    /* Each element of the result vector is the dot product of a row of the
+       matrix with the vector, computed by the kernel for the selected
+       instruction set */
+    matvecKernel(data.data(), v.values().data(), &result(0), nrows, ncols);
   }
 
   /* Returns the inverse diagonal of the matrix */
@@ -243,6 +295,18 @@ public:
     return result;
   }
 
+  /* Inverse diagonal entries written into an existing vector */
+  void inverseDiagonalEntries(Vector<T, nrows>& result) const {
+    for(std::size_t i = 0; i < nrows; ++i) {
+      result(i) = 1.0 / data[i * ncols + i];
+    }
+  }
+
+  /* Return the elements in row-major order */
+  const std::array<T, nrows * ncols>& values() const {
+    return data;
+  }
+
   /* Return the number of rows */
   std::size_t rows() const {
     return nrows;
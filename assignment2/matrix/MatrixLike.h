@@ -12,10 +12,14 @@ public:
 
 	/// virtual operators
 	virtual Vector<T, nrows> operator* (const Vector<T, nrows> & o) const = 0;
+	// product written into existing storage (not aliasing o), overridden by operators that can avoid the temporary
+	virtual void apply (const Vector<T, nrows> & o, Vector<T, nrows> & result) const { result = (*this) * o; }
 	// feel free to extend as required
 
 	/// other functions
 	virtual Derived inverseDiagonal( ) const = 0;
+	// entries of the inverse diagonal written into existing storage, overridden by operators that can avoid the temporary
+	virtual void inverseDiagonalEntries (Vector<T, nrows> & result) const { result.fill(1.0); result = inverseDiagonal( ) * result; }
 	// feel free to extend as required
 
 protected:
@@ -0,0 +1,551 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Matrix.h"
+#include "CSRMatrix.h"
+#include "Parallel.h"
+
+/* Smallest number of bytes of a file that is parsed or formatted by more
+   than one thread */
+constexpr std::size_t MATRIX_MARKET_PARALLEL_MIN = 1 << 20;
+
+/* Layouts of a Matrix Market file: the entries as (row, column, value)
+   lines, or all of the values in column-major order */
+enum class MatrixMarketFormat {
+  Coordinate, Array
+};
+
+/* Types of the values, pattern files only list the positions of the entries,
+   whose value is one */
+enum class MatrixMarketField {
+  Real, Integer, Pattern
+};
+
+/* Symmetric and skew-symmetric files only store the entries on and below the
+   diagonal, the ones above it are mirrored */
+enum class MatrixMarketSymmetry {
+  General, Symmetric, SkewSymmetric
+};
+
+/* Header of a Matrix Market file. Entries is the number of entries stored in
+   the file, before mirroring */
+struct MatrixMarketHeader {
+  MatrixMarketFormat format = MatrixMarketFormat::Coordinate;
+  MatrixMarketField field = MatrixMarketField::Real;
+  MatrixMarketSymmetry symmetry = MatrixMarketSymmetry::General;
+  std::size_t rows = 0, cols = 0, entries = 0;
+};
+
+/* Contents of a Matrix Market file: its header and its entries, 0-based and
+   in the order of the file */
+struct MatrixMarketData {
+  MatrixMarketHeader header;
+  std::vector<std::size_t> rows, columns;
+  std::vector<double> values;
+};
+
+/* Number of chunks the given number of bytes are split into */
+inline std::size_t matrixMarketChunks(std::size_t bytes, unsigned threads) {
+  return (threads > 1 && bytes >= MATRIX_MARKET_PARALLEL_MIN) ? threads : 1;
+}
+
+/* Skip the blanks of a line */
+inline const char *matrixMarketSkip(const char *p, const char *end) {
+  while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+    ++p;
+  }
+
+  return p;
+}
+
+/* Parse the number at p into value, returns the position after it or nullptr
+   if there is none */
+template<typename V>
+const char *matrixMarketNumber(const char *p, const char *end, V& value) {
+  p = matrixMarketSkip(p, end);
+
+  if(p < end && *p == '+') {
+    ++p;
+  }
+
+  const std::from_chars_result result = std::from_chars(p, end, value);
+  return (result.ec == std::errc() && result.ptr != p) ? result.ptr : nullptr;
+}
+
+/* Parse the header lines at the start of text: the banner, the comments and
+   the size line. Returns the position of the first entry line, or nullptr
+   if the header is malformed or of an unsupported type */
+inline const char *parseMatrixMarketHeader(const char *begin, const char *end, MatrixMarketHeader& header) {
+  const char *lineEnd = std::find(begin, end, '\n');
+  std::istringstream banner(std::string(begin, lineEnd));
+  std::string tag, object, format, field, symmetry;
+  banner >> tag >> object >> format >> field >> symmetry;
+
+  for(std::string *word : { &tag, &object, &format, &field, &symmetry }) {
+    std::transform(word->begin(), word->end(), word->begin(), [] (unsigned char c) { return std::tolower(c); });
+  }
+
+  if(tag != "%%matrixmarket" || object != "matrix") {
+    return nullptr;
+  }
+
+  if(format == "coordinate") {
+    header.format = MatrixMarketFormat::Coordinate;
+  } else if(format == "array") {
+    header.format = MatrixMarketFormat::Array;
+  } else {
+    return nullptr;
+  }
+
+  if(field == "real" || field == "double") {
+    header.field = MatrixMarketField::Real;
+  } else if(field == "integer") {
+    header.field = MatrixMarketField::Integer;
+  } else if(field == "pattern" && header.format == MatrixMarketFormat::Coordinate) {
+    header.field = MatrixMarketField::Pattern;
+  } else {
+    return nullptr;
+  }
+
+  if(symmetry == "general") {
+    header.symmetry = MatrixMarketSymmetry::General;
+  } else if(symmetry == "symmetric") {
+    header.symmetry = MatrixMarketSymmetry::Symmetric;
+  } else if(symmetry == "skew-symmetric") {
+    header.symmetry = MatrixMarketSymmetry::SkewSymmetric;
+  } else {
+    return nullptr;
+  }
+
+  /* Comments and blank lines up to the size line */
+  const char *p = lineEnd;
+
+  while(p < end) {
+    p = matrixMarketSkip(p + 1, end);
+    lineEnd = std::find(p, end, '\n');
+
+    if(p < lineEnd && *p != '%') {
+      break;
+    }
+
+    p = lineEnd;
+  }
+
+  if(p >= end) {
+    return nullptr;
+  }
+
+  p = matrixMarketNumber(p, lineEnd, header.rows);
+  p = (p != nullptr) ? matrixMarketNumber(p, lineEnd, header.cols) : nullptr;
+
+  if(p != nullptr && header.format == MatrixMarketFormat::Coordinate) {
+    p = matrixMarketNumber(p, lineEnd, header.entries);
+  } else if(p != nullptr) {
+    const std::size_t n = header.rows;
+
+    switch(header.symmetry) {
+      case MatrixMarketSymmetry::Symmetric:
+        header.entries = n * (n + 1) / 2;
+        break;
+      case MatrixMarketSymmetry::SkewSymmetric:
+        header.entries = (n > 0) ? n * (n - 1) / 2 : 0;
+        break;
+      default:
+        header.entries = header.rows * header.cols;
+        break;
+    }
+  }
+
+  if(p == nullptr || matrixMarketSkip(p, lineEnd) != lineEnd ||
+     (header.symmetry != MatrixMarketSymmetry::General && header.rows != header.cols)) {
+    return nullptr;
+  }
+
+  return (lineEnd < end) ? lineEnd + 1 : end;
+}
+
+/* Parse the entry lines in [begin, end), which start at entry first of the
+   file, into data. Counts the entry lines instead if count is set. Returns
+   false if a line is malformed or an index out of range */
+inline bool parseMatrixMarketEntries(const char *begin, const char *end, std::size_t first, bool count, MatrixMarketData& data, std::size_t& entries) {
+  const MatrixMarketHeader& header = data.header;
+  const bool array = header.format == MatrixMarketFormat::Array;
+  entries = 0;
+
+  /* Position of the first entry of an array file: the columns hold the rows
+     on and below the diagonal for symmetric files, below it for skew ones */
+  const std::size_t below = (header.symmetry == MatrixMarketSymmetry::General) ? 0 :
+                            (header.symmetry == MatrixMarketSymmetry::Symmetric) ? 1 : 2;
+  auto columnStart = [&] (std::size_t j) { return (below == 0) ? 0 : j + below - 1; };
+  std::size_t row = 0, column = 0;
+
+  if(array && !count && header.rows > 0) {
+    std::size_t skipped = first;
+
+    while(column < header.cols && skipped >= header.rows - std::min(header.rows, columnStart(column))) {
+      skipped -= header.rows - std::min(header.rows, columnStart(column));
+      ++column;
+    }
+
+    row = columnStart(column) + skipped;
+  }
+
+  for(const char *p = begin; p < end;) {
+    const char *lineEnd = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    lineEnd = (lineEnd != nullptr) ? lineEnd : end;
+    const char *q = matrixMarketSkip(p, lineEnd);
+    p = lineEnd + 1;
+
+    if(q == lineEnd || *q == '%') {
+      continue;
+    }
+
+    if(count) {
+      ++entries;
+      continue;
+    }
+
+    const std::size_t k = first + entries++;
+
+    if(k >= header.entries) {
+      return false;
+    }
+
+    double value = 1.0;
+
+    if(array) {
+      if(column >= header.cols) {
+        return false;
+      }
+
+      data.rows[k] = row;
+      data.columns[k] = column;
+
+      if(++row == header.rows) {
+        ++column;
+        row = columnStart(column);
+      }
+    } else {
+      std::size_t i = 0, j = 0;
+      q = matrixMarketNumber(q, lineEnd, i);
+      q = (q != nullptr) ? matrixMarketNumber(q, lineEnd, j) : nullptr;
+
+      if(q == nullptr || i < 1 || j < 1 || i > header.rows || j > header.cols) {
+        return false;
+      }
+
+      data.rows[k] = i - 1;
+      data.columns[k] = j - 1;
+    }
+
+    if(header.field != MatrixMarketField::Pattern) {
+      q = matrixMarketNumber(q, lineEnd, value);
+    }
+
+    if(q == nullptr || matrixMarketSkip(q, lineEnd) != lineEnd) {
+      return false;
+    }
+
+    data.values[k] = value;
+  }
+
+  return true;
+}
+
+/* Read a Matrix Market file into data, with the entry lines split into
+   chunks at line boundaries and parsed on the given number of threads.
+   Returns false if the file is missing, malformed, or of a type other than
+   a real, integer or pattern matrix */
+inline bool readMatrixMarket(const std::string& path, MatrixMarketData& data, unsigned threads = 1) {
+  std::ifstream in(path, std::ios::binary);
+  std::string text;
+
+  if(!in.seekg(0, std::ios::end)) {
+    return false;
+  }
+
+  text.resize(static_cast<std::size_t>(in.tellg()));
+  in.seekg(0);
+
+  if(!in.read(&text[0], text.size())) {
+    return false;
+  }
+
+  MatrixMarketData result;
+  const char *end = text.data() + text.size();
+  const char *body = parseMatrixMarketHeader(text.data(), end, result.header);
+
+  if(body == nullptr) {
+    return false;
+  }
+
+  /* Chunks start after the first line break at or after their share */
+  const std::size_t size = end - body, chunks = matrixMarketChunks(size, threads);
+  std::vector<const char *> bounds(chunks + 1, end);
+
+  for(std::size_t k = 0; k < chunks; ++k) {
+    const char *p = body + size * k / chunks;
+
+    if(p > body && p[-1] != '\n') {
+      p = std::find(p, end, '\n');
+      p = (p < end) ? p + 1 : end;
+    }
+
+    bounds[k] = std::max(p, (k > 0) ? bounds[k - 1] : body);
+  }
+
+  /* Count the entries of each chunk, then parse them into their positions */
+  std::vector<std::size_t> firsts(chunks + 1, 0), counts(chunks, 0);
+  std::vector<char> ok(chunks, 1);
+
+  auto pass = [&] (bool count) {
+    parallelChunks(0, chunks, 1, 1, threads, [&] (std::size_t first, std::size_t last) {
+      for(std::size_t k = first; k < last; ++k) {
+        ok[k] = parseMatrixMarketEntries(bounds[k], bounds[k + 1], firsts[k], count, result, counts[k]);
+      }
+    });
+
+    return std::all_of(ok.begin(), ok.end(), [] (char chunk) { return chunk != 0; });
+  };
+
+  pass(true);
+
+  for(std::size_t k = 0; k < chunks; ++k) {
+    firsts[k + 1] = firsts[k] + counts[k];
+  }
+
+  if(firsts[chunks] != result.header.entries) {
+    return false;
+  }
+
+  result.rows.resize(result.header.entries);
+  result.columns.resize(result.header.entries);
+  result.values.resize(result.header.entries);
+
+  if(!pass(false)) {
+    return false;
+  }
+
+  data = std::move(result);
+  return true;
+}
+
+/* Return the entry mirrored to the position above the diagonal by the
+   symmetry of the file, false if there is none */
+inline bool matrixMarketMirror(const MatrixMarketHeader& header, std::size_t i, std::size_t j, double& value) {
+  if(header.symmetry == MatrixMarketSymmetry::General || i == j) {
+    return false;
+  }
+
+  value = (header.symmetry == MatrixMarketSymmetry::SkewSymmetric) ? -value : value;
+  return true;
+}
+
+/* Read a Matrix Market file into a dense matrix, see above. Entries given
+   more than once are summed. Returns false as well if the dimensions of the
+   file are not the ones of the matrix */
+template<typename T, std::size_t nrows, std::size_t ncols>
+bool readMatrixMarket(const std::string& path, Matrix<T, nrows, ncols>& m, unsigned threads = 1) {
+  MatrixMarketData data;
+
+  if(!readMatrixMarket(path, data, threads) || data.header.rows != nrows || data.header.cols != ncols) {
+    return false;
+  }
+
+  m.fill(0.0, threads);
+
+  auto store = [&] (std::size_t k) {
+    const std::size_t i = data.rows[k], j = data.columns[k];
+    double value = data.values[k];
+    m(i, j) += value;
+
+    if(matrixMarketMirror(data.header, i, j, value)) {
+      m(j, i) += value;
+    }
+  };
+
+  /* The positions of an array file are distinct, so its entries can be
+     stored in parallel */
+  if(data.header.format == MatrixMarketFormat::Array) {
+    parallelChunks(0, data.values.size(), 1, MATRIX_MARKET_PARALLEL_MIN, threads, [&] (std::size_t first, std::size_t last) {
+      for(std::size_t k = first; k < last; ++k) {
+        store(k);
+      }
+    });
+  } else {
+    for(std::size_t k = 0; k < data.values.size(); ++k) {
+      store(k);
+    }
+  }
+
+  return true;
+}
+
+/* Read a Matrix Market file into a CSR matrix, see above. The entries of
+   each row are sorted by column, entries given more than once are summed,
+   and the zeros of array files are left out. Returns false as well if the
+   dimensions of the file are not the ones of the matrix */
+template<typename T, std::size_t nrows, std::size_t ncols>
+bool readMatrixMarket(const std::string& path, CSRMatrix<T, nrows, ncols>& m, unsigned threads = 1) {
+  MatrixMarketData data;
+
+  if(!readMatrixMarket(path, data, threads) || data.header.rows != nrows || data.header.cols != ncols) {
+    return false;
+  }
+
+  const bool array = data.header.format == MatrixMarketFormat::Array;
+  std::vector<std::size_t> rowStart(nrows + 1, 0);
+
+  /* Count the entries of each row, then place them after the ones before */
+  auto each = [&] (auto body) {
+    for(std::size_t k = 0; k < data.values.size(); ++k) {
+      double value = data.values[k];
+
+      if(array && value == 0.0) {
+        continue;
+      }
+
+      const std::size_t i = data.rows[k], j = data.columns[k];
+      body(i, j, value);
+
+      if(matrixMarketMirror(data.header, i, j, value)) {
+        body(j, i, value);
+      }
+    }
+  };
+
+  each([&] (std::size_t i, std::size_t, double) { ++rowStart[i + 1]; });
+
+  for(std::size_t i = 0; i < nrows; ++i) {
+    rowStart[i + 1] += rowStart[i];
+  }
+
+  std::vector<std::size_t> next(rowStart.begin(), rowStart.end() - 1), columns(rowStart[nrows]);
+  std::vector<T> values(rowStart[nrows]);
+
+  each([&] (std::size_t i, std::size_t j, double value) {
+    columns[next[i]] = j;
+    values[next[i]++] = value;
+  });
+
+  /* Sort the rows by column, the files usually list them sorted already */
+  parallelChunks(0, nrows, 1, MATRIX_MARKET_PARALLEL_MIN / 64, threads, [&] (std::size_t first, std::size_t last) {
+    std::vector<std::pair<std::size_t, T>> row;
+
+    for(std::size_t i = first; i < last; ++i) {
+      if(std::is_sorted(columns.begin() + rowStart[i], columns.begin() + rowStart[i + 1])) {
+        continue;
+      }
+
+      row.clear();
+
+      for(std::size_t k = rowStart[i]; k < rowStart[i + 1]; ++k) {
+        row.emplace_back(columns[k], values[k]);
+      }
+
+      std::stable_sort(row.begin(), row.end(), [] (const std::pair<std::size_t, T>& a, const std::pair<std::size_t, T>& b) {
+        return a.first < b.first;
+      });
+
+      for(std::size_t k = rowStart[i]; k < rowStart[i + 1]; ++k) {
+        columns[k] = row[k - rowStart[i]].first;
+        values[k] = row[k - rowStart[i]].second;
+      }
+    }
+  });
+
+  /* Sum the entries given more than once */
+  std::size_t stored = 0;
+
+  for(std::size_t i = 0; i < nrows; ++i) {
+    const std::size_t start = stored;
+
+    for(std::size_t k = rowStart[i]; k < rowStart[i + 1]; ++k) {
+      if(stored > start && columns[stored - 1] == columns[k]) {
+        values[stored - 1] += values[k];
+      } else {
+        columns[stored] = columns[k];
+        values[stored++] = values[k];
+      }
+    }
+
+    rowStart[i] = start;
+  }
+
+  rowStart[nrows] = stored;
+  columns.resize(stored);
+  values.resize(stored);
+  m = CSRMatrix<T, nrows, ncols>(std::move(rowStart), std::move(columns), std::move(values));
+  return true;
+}
+
+/* Write the lines of the given entries to the file, formatting chunks of
+   them on the given number of threads. The values are written with the
+   fewest digits that read back to the same value */
+template<typename Entry>
+bool writeMatrixMarketLines(std::ofstream& out, std::size_t count, unsigned threads, Entry entry) {
+  const std::size_t chunks = matrixMarketChunks(count * 32, threads);
+  std::vector<std::string> parts(chunks);
+
+  parallelChunks(0, chunks, 1, 1, threads, [&] (std::size_t first, std::size_t last) {
+    char line[96];
+
+    for(std::size_t c = first; c < last; ++c) {
+      for(std::size_t k = count * c / chunks; k < count * (c + 1) / chunks; ++k) {
+        parts[c].append(line, entry(k, line, line + sizeof(line)) - line);
+      }
+    }
+  });
+
+  for(const std::string& part : parts) {
+    out.write(part.data(), part.size());
+  }
+
+  out.close();
+  return !out.fail();
+}
+
+/* Write the dense matrix as an array file, returns false if it could not be
+   written */
+template<typename T, std::size_t nrows, std::size_t ncols>
+bool writeMatrixMarket(const std::string& path, const Matrix<T, nrows, ncols>& m, unsigned threads = 1) {
+  std::ofstream out(path, std::ios::binary);
+  out << "%%MatrixMarket matrix array real general\n" << nrows << " " << ncols << "\n";
+
+  return writeMatrixMarketLines(out, nrows * ncols, threads, [&] (std::size_t k, char *p, char *end) {
+    p = std::to_chars(p, end, static_cast<double>(m(k % nrows, k / nrows))).ptr;
+    *p++ = '\n';
+    return p;
+  });
+}
+
+/* Write the CSR matrix as a coordinate file, returns false if it could not
+   be written */
+template<typename T, std::size_t nrows, std::size_t ncols>
+bool writeMatrixMarket(const std::string& path, const CSRMatrix<T, nrows, ncols>& m, unsigned threads = 1) {
+  const std::vector<std::size_t>& rowStart = m.rowStarts();
+  const std::vector<std::size_t>& columns = m.columnIndices();
+  const std::vector<T>& values = m.entries();
+  std::ofstream out(path, std::ios::binary);
+  out << "%%MatrixMarket matrix coordinate real general\n" << nrows << " " << ncols << " " << values.size() << "\n";
+
+  return writeMatrixMarketLines(out, values.size(), threads, [&] (std::size_t k, char *p, char *end) {
+    const std::size_t i = std::upper_bound(rowStart.begin(), rowStart.end(), k) - rowStart.begin();
+    p = std::to_chars(p, end, i).ptr;
+    *p++ = ' ';
+    p = std::to_chars(p, end, columns[k] + 1).ptr;
+    *p++ = ' ';
+    p = std::to_chars(p, end, static_cast<double>(values[k])).ptr;
+    *p++ = '\n';
+    return p;
+  });
+}
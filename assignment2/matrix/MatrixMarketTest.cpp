@@ -0,0 +1,178 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <chrono>
+#include <memory>
+#include <random>
+#include "Matrix.h"
+#include "Vector.h"
+#include "CSRMatrix.h"
+#include "MatrixMarket.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+const std::string path = "MatrixMarketTest.mtx";
+
+void writeFile(const std::string& contents) {
+	std::ofstream(path, std::ios::binary) << contents;
+}
+
+template<size_t nrows, size_t ncols>
+bool sameCSR(const CSRMatrix<double, nrows, ncols>& a, const CSRMatrix<double, nrows, ncols>& b) {
+	return a.rowStarts() == b.rowStarts() && a.columnIndices() == b.columnIndices() && a.entries() == b.entries();
+}
+
+// dense and sparse matrices read back exactly as written, on any number of threads
+void test_round_trip() {
+	TESTCASE("test_round_trip");
+	constexpr size_t n = 40, m = 25;
+	auto entry = [] (size_t i, size_t j) { return ((i * 7 + j * 3) % 5 == 0) ? std::sin(1. + i) / (1. + j) * 1.e-3 : 0.0; };
+	std::unique_ptr<Matrix<double, n, m>> dense(new Matrix<double, n, m>(entry));
+	std::unique_ptr<Matrix<double, n, n>> square(new Matrix<double, n, n>(entry));
+	const CSRMatrix<double, n, n> sparse(*square);
+
+	for (unsigned threads : { 1u, 3u }) {
+		std::unique_ptr<Matrix<double, n, m>> read(new Matrix<double, n, m>(1.0));
+		assert("dense written" && writeMatrixMarket(path, *dense, threads));
+		assert("dense read" && readMatrixMarket(path, *read, threads) && *read == *dense);
+
+		std::unique_ptr<Matrix<double, n, n>> readSquare(new Matrix<double, n, n>(1.0));
+		assert("square written" && writeMatrixMarket(path, *square, threads));
+		CSRMatrix<double, n, n> fromArray;
+		assert("array into CSR, zeros left out" && readMatrixMarket(path, fromArray, threads) && sameCSR(fromArray, sparse));
+
+		assert("sparse written" && writeMatrixMarket(path, sparse, threads));
+		CSRMatrix<double, n, n> readSparse;
+		assert("sparse read" && readMatrixMarket(path, readSparse, threads) && sameCSR(readSparse, sparse));
+		assert("coordinate into dense" && readMatrixMarket(path, *readSquare, threads) && *readSquare == *square);
+	}
+	std::remove(path.c_str());
+}
+
+// symmetry, pattern and integer fields, comments, blank lines, CRLF and duplicate entries
+void test_header() {
+	TESTCASE("test_header");
+	writeFile("%%MatrixMarket matrix coordinate real symmetric\r\n% a comment\r\n\r\n3 3 4\r\n1 1 2.5\r\n3 1 -1e-3\r\n\r\n2 2 4\r\n3 3 +1.\r\n");
+	Matrix<double, 3, 3> m(7.0);
+	assert("symmetric read" && readMatrixMarket(path, m));
+	assert("mirrored" && m(0, 0) == 2.5 && m(2, 0) == -1e-3 && m(0, 2) == -1e-3 && m(1, 1) == 4. && m(2, 2) == 1. && m(0, 1) == 0.);
+	CSRMatrix<double, 3, 3> csr;
+	assert("symmetric CSR" && readMatrixMarket(path, csr) && csr.nonZeros() == 5 && csr(0, 2) == -1e-3);
+
+	writeFile("%%MatrixMarket matrix coordinate pattern general\n2 3 3\n1 3\n2 1\n1 3\n");
+	Matrix<double, 2, 3> p(0.0);
+	assert("pattern, duplicates summed" && readMatrixMarket(path, p) && p(0, 2) == 2. && p(1, 0) == 1. && p(0, 0) == 0.);
+	writeFile("%%MatrixMarket matrix coordinate pattern general\n3 3 3\n1 3\n2 1\n1 3\n");
+	CSRMatrix<double, 3, 3> pCSR;
+	assert("pattern CSR, duplicates summed" && readMatrixMarket(path, pCSR) && pCSR.nonZeros() == 2 && pCSR(0, 2) == 2.);
+
+	writeFile("%%MATRIXMARKET MATRIX ARRAY INTEGER SKEW-SYMMETRIC\n3 3\n1\n2\n3\n");
+	assert("skew-symmetric array" && readMatrixMarket(path, m) && m(1, 0) == 1. && m(0, 1) == -1. && m(2, 0) == 2. &&
+	       m(2, 1) == 3. && m(1, 2) == -3. && m(0, 0) == 0.);
+
+	writeFile("%%MatrixMarket matrix array real symmetric\n3 3\n1\n2\n3\n4\n5\n6\n");
+	assert("symmetric array" && readMatrixMarket(path, m) && m(0, 0) == 1. && m(1, 0) == 2. && m(0, 2) == 3. &&
+	       m(1, 1) == 4. && m(2, 1) == 5. && m(2, 2) == 6.);
+
+	MatrixMarketData data;
+	assert("data" && readMatrixMarket(path, data) && data.header.format == MatrixMarketFormat::Array &&
+	       data.header.symmetry == MatrixMarketSymmetry::Symmetric && data.header.entries == 6 && data.rows[4] == 2 && data.columns[4] == 1);
+	std::remove(path.c_str());
+}
+
+// malformed files and mismatched dimensions are rejected and leave the matrix alone
+void test_errors() {
+	TESTCASE("test_errors");
+	Matrix<double, 3, 3> m(7.0);
+	const char *files[] = {
+		"",
+		"%%MatrixMarket matrix coordinate complex general\n3 3 1\n1 1 1 0\n",
+		"%%MatrixMarket vector coordinate real general\n3 3 1\n1 1 1\n",
+		"%%MatrixMarket matrix coordinate real general\n3 3 2\n1 1 1\n",
+		"%%MatrixMarket matrix coordinate real general\n3 3 1\n1 1 1\n2 2 2\n",
+		"%%MatrixMarket matrix coordinate real general\n3 3 1\n4 1 1\n",
+		"%%MatrixMarket matrix coordinate real general\n3 3 1\n0 1 1\n",
+		"%%MatrixMarket matrix coordinate real general\n3 3 1\n1 1 x\n",
+		"%%MatrixMarket matrix coordinate real general\n3 3 1\n1 1 1 1\n",
+		"%%MatrixMarket matrix coordinate real symmetric\n3 2 1\n1 1 1\n",
+		"%%MatrixMarket matrix array real general\n3 3\n1\n",
+		"%%MatrixMarket matrix coordinate real general\n2 3 1\n1 1 1\n",
+		"%%MatrixMarket matrix coordinate real general\n",
+	};
+	for (const char *contents : files) {
+		writeFile(contents);
+		assert("rejected" && !readMatrixMarket(path, m) && m(0, 0) == 7.);
+	}
+	std::remove(path.c_str());
+	assert("missing file" && !readMatrixMarket(path, m));
+}
+
+// files beyond MATRIX_MARKET_PARALLEL_MIN are split into chunks, which gives the same entries
+void test_chunks() {
+	TESTCASE("test_chunks");
+	constexpr size_t n = 20000;
+	std::minstd_rand random(3);
+	std::uniform_int_distribution<size_t> column(0, n - 1);
+	std::uniform_real_distribution<double> value(-1., 1.);
+	std::vector<size_t> rowStart(n + 1, 0), columns;
+	std::vector<double> values;
+	for (size_t i = 0; i < n; ++i) {
+		std::vector<size_t> row = { i };
+		for (int k = 0; k < 9; ++k) {
+			row.push_back(column(random));
+		}
+		std::sort(row.begin(), row.end());
+		row.erase(std::unique(row.begin(), row.end()), row.end());
+		for (size_t j : row) {
+			columns.push_back(j);
+			values.push_back(value(random) * std::pow(10., (double)(j % 40) - 20.));
+		}
+		rowStart[i + 1] = values.size();
+	}
+	const CSRMatrix<double, n, n> A(rowStart, columns, values);
+	assert("written" && writeMatrixMarket(path, A, 4));
+
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	const double megabytes = in.tellg() / 1.e6;
+	assert("large enough to be split" && megabytes * 1.e6 > 2 * MATRIX_MARKET_PARALLEL_MIN);
+
+	MatrixMarketData single, chunked;
+	assert("read" && readMatrixMarket(path, single, 1));
+	for (unsigned threads : { 2u, 3u, 8u }) {
+		assert("read in chunks" && readMatrixMarket(path, chunked, threads));
+		assert("same entries" && chunked.rows == single.rows && chunked.columns == single.columns && chunked.values == single.values);
+	}
+
+	CSRMatrix<double, n, n> read;
+	const auto start = std::chrono::steady_clock::now();
+	assert("CSR read" && readMatrixMarket(path, read, 4));
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	assert("same matrix" && sameCSR(read, A));
+	std::cout << "\t" << A.nonZeros() << " entries, " << megabytes << " MB read at " << megabytes / seconds << " MB/s" << std::endl;
+	std::remove(path.c_str());
+}
+
+int main() {
+	test_round_trip();
+	test_header();
+	test_errors();
+	test_chunks();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
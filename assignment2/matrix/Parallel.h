@@ -0,0 +1,35 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/* Run body(begin, end) on the range [first, last), split into contiguous
+   chunks among the given number of threads. Ranges with less than minimum
+   units of work, counting cost units per element, are not split, as
+   starting the threads would cost more than the work itself */
+template<typename Body>
+void parallelChunks(std::size_t first, std::size_t last, std::size_t cost, std::size_t minimum, unsigned threads, Body body) {
+  const std::size_t size = last - first;
+
+  if(threads <= 1 || size < 2 || size * cost < minimum) {
+    body(first, last);
+    return;
+  }
+
+  const std::size_t count = std::min<std::size_t>(threads, size);
+  std::vector<std::thread> workers;
+  workers.reserve(count - 1);
+
+  /* The calling thread takes the first chunk itself */
+  for(std::size_t t = 1; t < count; ++t) {
+    workers.emplace_back(body, first + size * t / count, first + size * (t + 1) / count);
+  }
+
+  body(first, first + size / count);
+
+  for(std::thread& worker : workers) {
+    worker.join();
+  }
+}
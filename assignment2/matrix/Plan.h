@@ -0,0 +1,482 @@
+#pragma once
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "CG.h"
+#include "Chebyshev.h"
+#include "Krylov.h"
+#include "Spectrum.h"
+#include "../../common/CpuDispatch.h"
+#include "Hash.h"
+
+/* Iterations between the checks of the time budget while measuring */
+constexpr unsigned int PLAN_SLICE = 16;
+
+/* Longest a single candidate is measured, in seconds */
+constexpr double PLAN_MEASURE_SECONDS = 1.0;
+
+/* How much work goes into a plan, as in FFTW: Estimate picks the solver from
+   the analysis of the operator, Measure times the candidate solvers */
+enum class PlanEffort {
+  Estimate, Measure
+};
+
+/* Solvers a plan can choose from */
+enum class PlannedSolver {
+  Jacobi, Chebyshev, CG, BiCGSTAB
+};
+
+/* Return the name of a planned solver */
+inline const char *solverName(PlannedSolver solver) {
+  switch(solver) {
+    case PlannedSolver::Jacobi:
+      return "jacobi";
+    case PlannedSolver::Chebyshev:
+      return "chebyshev";
+    case PlannedSolver::CG:
+      return "cg";
+    case PlannedSolver::BiCGSTAB:
+      return "bicgstab";
+    default:
+      return "unknown";
+  }
+}
+
+/* Result of analyzing an operator: the solver to use with its parameters,
+   for the operator with the given hash and size on the instruction set
+   level the kernels ran at */
+struct SolverPlan {
+  std::uint64_t key = 0;
+  std::size_t size = 0;
+  IsaLevel isa = IsaLevel::SSE2;
+  PlannedSolver solver = PlannedSolver::BiCGSTAB;
+  /* Whether the solver was chosen by measuring */
+  bool measured = false;
+  /* Parameters from the estimated spectrum of D^-1 A, the Chebyshev
+     interval is the one a Chebyshev solve uses */
+  RelaxationParameters relaxation = { 1.0, 1.0, { 0.0, 0.0 } };
+};
+
+/* Returns a hash of the operator: of its product with a fixed random vector
+   and of its inverse diagonal, so operators of the same representation with
+   the same entries have the same hash. The representations sum the products
+   in different orders, so a stencil and the dense matrix holding its entries
+   do not. Takes one product */
+template<typename T, class MatrixImpl, std::size_t n>
+std::uint64_t operatorHash(const MatrixLike<T, MatrixImpl, n, n>& A, Workspace<T, n>& workspace) {
+  Vector<T, n>& v = workspace.vector(0);
+  Vector<T, n>& w = workspace.vector(1);
+  std::minstd_rand random(42);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  v.generate([&] (std::size_t) { return uniform(random); });
+  A.apply(v, w);
+
+  const std::uint64_t size = n;
+  std::uint64_t hash = hashBytes(&size, sizeof(size));
+  hash = hashBytes(w.values().data(), n * sizeof(T), hash);
+  return hashBytes(workspace.inverseDiagonal(A).values().data(), n * sizeof(T), hash);
+}
+
+/* Check if A is symmetric on the rows coupled to other rows, the part CG
+   iterates in: rows that only hold a diagonal entry, like Dirichlet
+   boundaries, are satisfied by a Jacobi step (see CGStepper). Compares
+   x * A y with y * A x for random x and y vanishing on those rows */
+template<typename T, class MatrixImpl, std::size_t n>
+bool isSymmetric(const MatrixLike<T, MatrixImpl, n, n>& A, Workspace<T, n>& workspace) {
+  const Vector<T, n>& invDiag = workspace.inverseDiagonal(A);
+  Vector<T, n>& x = workspace.vector(0);
+  Vector<T, n>& y = workspace.vector(1);
+  Vector<T, n>& ax = workspace.vector(2);
+  Vector<T, n>& ay = workspace.vector(3);
+  std::minstd_rand random(7);
+  std::uniform_real_distribution<double> uniform(1.0, 2.0);
+  x.generate([&] (std::size_t) { return uniform(random); });
+  y.generate([&] (std::size_t) { return uniform(random); });
+  A.apply(x, ax);
+
+  /* A row holding only its diagonal maps x to its diagonal times x */
+  for(std::size_t i = 0; i < n; ++i) {
+    const double diagonal = x(i) / invDiag(i);
+
+    if(std::abs(ax(i) - diagonal) <= 1.e-12 * std::abs(diagonal)) {
+      x(i) = 0.0;
+      y(i) = 0.0;
+    }
+  }
+
+  A.apply(x, ax);
+  A.apply(y, ay);
+
+  double xAy = 0.0, yAx = 0.0;
+
+  for(std::size_t i = 0; i < n; ++i) {
+    xAy += x(i) * ay(i);
+    yAx += y(i) * ax(i);
+  }
+
+  return std::abs(xAy - yAx) <= 1.e-10 * (x.l2Norm() * ay.l2Norm() + y.l2Norm() * ax.l2Norm());
+}
+
+/* Run the planned solver, drawing all of its temporaries from the given
+   workspace. Solves until the residual is reduced by the given factor and
+   returns the number of iterations required, or SOLVE_FAILED if that takes
+   more than maxIterations */
+template<typename T, class MatrixImpl, std::size_t n>
+unsigned int solvePlanned(
+  const SolverPlan& plan,
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n>& b,
+  Vector<T, n>& u,
+  Workspace<T, n>& workspace,
+  double tolerance = 1.e-5,
+  SolverTelemetry *telemetry = nullptr,
+  unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+
+  assert("plan for an operator of the same size" && plan.size == n);
+
+  switch(plan.solver) {
+    case PlannedSolver::Jacobi:
+      return jacobi(A, b, u, workspace, tolerance, telemetry, maxIterations);
+    case PlannedSolver::Chebyshev:
+      return chebyshev(A, b, u, workspace, plan.relaxation.chebyshev, tolerance, telemetry, maxIterations);
+    case PlannedSolver::CG:
+      return pcg(A, b, u, workspace, tolerance, telemetry, maxIterations);
+    default:
+      return bicgstab(A, b, u, workspace, Preconditioning::Right, tolerance, telemetry, maxIterations);
+  }
+}
+
+/* Returns the time a solve of A u = b from zero with the given solver takes,
+   or infinity if it does not converge within the budget in seconds */
+template<typename T, class MatrixImpl, std::size_t n>
+double timeSolver(
+  PlannedSolver solver,
+  const RelaxationParameters& relaxation,
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  const Vector<T, n>& b,
+  Workspace<T, n>& workspace,
+  double tolerance,
+  double budget) {
+
+  std::unique_ptr<Vector<T, n>> u(new Vector<T, n>(0.0));
+  std::unique_ptr<Steppable> stepper;
+
+  switch(solver) {
+    case PlannedSolver::Jacobi:
+      stepper.reset(new JacobiStepper<T, MatrixImpl, n>(A, b, *u, workspace, tolerance));
+      break;
+    case PlannedSolver::Chebyshev:
+      stepper.reset(new ChebyshevStepper<T, MatrixImpl, n>(A, b, *u, workspace, relaxation.chebyshev, tolerance));
+      break;
+    case PlannedSolver::CG:
+      stepper.reset(new CGStepper<T, MatrixImpl, n>(A, b, *u, workspace, tolerance));
+      break;
+    default:
+      stepper.reset(new BiCGSTABStepper<T, MatrixImpl, n>(A, b, *u, workspace, Preconditioning::Right, tolerance));
+      break;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  double elapsed = 0.0;
+
+  while(!stepper->step(PLAN_SLICE)) {
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if(elapsed > budget || stepper->failed()) {
+      return std::numeric_limits<double>::infinity();
+    }
+  }
+
+  elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  /* The true residual decides, in case a stopping test is too lenient */
+  const double initRes = b.l2Norm();
+  const double res = residual(A, b, *u, workspace.vector(0));
+  return (std::isfinite(res) && res <= 2.0 * tolerance * initRes) ? elapsed : std::numeric_limits<double>::infinity();
+}
+
+/* Analyze A and return its plan. The spectrum of D^-1 A is estimated with
+   Lanczos steps, as for tuneRelaxation. With Estimate, CG is chosen for
+   operators symmetric and definite apart from their diagonal-only rows, and
+   BiCGSTAB for all others; with Measure, the solvers expected to converge
+   are timed on a random right-hand side and the fastest one is chosen */
+template<typename T, class MatrixImpl, std::size_t n>
+SolverPlan makePlan(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  Workspace<T, n>& workspace,
+  PlanEffort effort = PlanEffort::Estimate,
+  double tolerance = 1.e-5) {
+
+  SolverPlan plan;
+  plan.key = operatorHash(A, workspace);
+  plan.size = n;
+  plan.isa = isa_level();
+  plan.relaxation = tuneRelaxation(A, workspace);
+
+  const SpectralBounds& bounds = plan.relaxation.chebyshev;
+  const bool definite = bounds.min > 0.0 && std::isfinite(bounds.max);
+  const bool symmetric = isSymmetric(A, workspace);
+  plan.solver = (symmetric && definite) ? PlannedSolver::CG : PlannedSolver::BiCGSTAB;
+
+  if(effort == PlanEffort::Measure) {
+    std::minstd_rand random(42);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::unique_ptr<Vector<T, n>> b(new Vector<T, n>([&] (std::size_t) { return uniform(random); }));
+
+    /* The broadly converging solver goes first, its time bounds the others */
+    std::vector<PlannedSolver> candidates = { PlannedSolver::BiCGSTAB };
+
+    if(symmetric && definite) {
+      candidates.push_back(PlannedSolver::CG);
+    }
+
+    if(definite) {
+      candidates.push_back(PlannedSolver::Chebyshev);
+    }
+
+    /* Jacobi converges if the spectrum of D^-1 A lies in (0, 2) */
+    if(definite && bounds.max < 2.0) {
+      candidates.push_back(PlannedSolver::Jacobi);
+    }
+
+    double best = PLAN_MEASURE_SECONDS;
+
+    for(PlannedSolver candidate : candidates) {
+      const double time = timeSolver(candidate, plan.relaxation, A, *b, workspace, tolerance, best);
+
+      if(time < best) {
+        best = time;
+        plan.solver = candidate;
+      }
+    }
+
+    plan.measured = true;
+  }
+
+  return plan;
+}
+
+/* Plans kept in a file, like the FFTW wisdom, so later runs on the same
+   operators start solving without analyzing them. Plans are looked up by
+   the operator hash and size and the instruction set level of the process.
+   The file is text, a header line followed by one plan per line:
+   key, size, instruction set, solver, measured, the Jacobi damping, the SOR
+   factor and the Chebyshev interval. Values are written with all of their
+   digits, so a plan read back is the one written. The version in the
+   header changes with the way the parameters are estimated, so files of
+   older estimates are ignored instead of answering lookups */
+class PlanCache {
+private:
+  std::string path;
+  std::vector<SolverPlan> plans;
+  /* Lookups answered from the cache and plans made */
+  unsigned int hitCount = 0, missCount = 0;
+
+  /* Version 2 holds the Chebyshev interval of the symmetric scaling */
+  static constexpr const char *header = "advpt-plans 2";
+
+  /* Parse a plan line, returns false if it is malformed */
+  static bool parse(const std::string& line, SolverPlan& plan) {
+    std::istringstream in(line);
+    std::string isa, solver;
+    in >> std::hex >> plan.key >> std::dec >> plan.size >> isa >> solver >> plan.measured >> plan.relaxation.jacobiDamping
+       >> plan.relaxation.sorOmega >> plan.relaxation.chebyshev.min >> plan.relaxation.chebyshev.max;
+
+    if(!in) {
+      return false;
+    }
+
+    bool known = false;
+
+    for(IsaLevel level : { IsaLevel::SSE2, IsaLevel::AVX2, IsaLevel::AVX512 }) {
+      if(isa == isa_name(level)) {
+        plan.isa = level;
+        known = true;
+      }
+    }
+
+    for(PlannedSolver planned : { PlannedSolver::Jacobi, PlannedSolver::Chebyshev, PlannedSolver::CG, PlannedSolver::BiCGSTAB }) {
+      if(solver == solverName(planned)) {
+        plan.solver = planned;
+        return known;
+      }
+    }
+
+    return false;
+  }
+
+  /* Read the plans of the file, returns false if it is missing or not a
+     plan file */
+  bool readFile(std::vector<SolverPlan>& read) const {
+    std::ifstream in(path);
+    std::string line;
+
+    if(!std::getline(in, line) || line != header) {
+      return false;
+    }
+
+    while(std::getline(in, line)) {
+      SolverPlan plan;
+
+      if(!parse(line, plan)) {
+        return false;
+      }
+
+      read.push_back(plan);
+    }
+
+    return true;
+  }
+
+  /* Add the plan unless a measured one for the same operator would be
+     replaced by an estimated one */
+  void merge(const SolverPlan& plan) {
+    for(const SolverPlan& existing : plans) {
+      if(existing.key == plan.key && existing.size == plan.size && existing.isa == plan.isa &&
+         existing.measured && !plan.measured) {
+        return;
+      }
+    }
+
+    insert(plan);
+  }
+public:
+  /* PlanCache constructor, reading the plans of the given file if it exists */
+  explicit PlanCache(const std::string& path) : path(path) {
+    load();
+  }
+
+  /* Replace the plans with the ones of the file, returns false if it is
+     missing or not a plan file, in which case the cache is left empty */
+  bool load() {
+    plans.clear();
+    std::vector<SolverPlan> read;
+
+    if(!readFile(read)) {
+      return false;
+    }
+
+    plans = read;
+    return true;
+  }
+
+  /* Write the plans to the file, returns false if it could not be written.
+     Other caches may share the file, so the plans written there in the
+     meantime are merged in first, ours replacing theirs for the same
+     operator unless only theirs is measured. Like snapshots, the file is
+     written under a temporary name and renamed, the name is unique to the
+     write so concurrent ones do not write into each other's file */
+  bool save() {
+    std::vector<SolverPlan> merged;
+
+    if(readFile(merged)) {
+      std::swap(merged, plans);
+
+      for(const SolverPlan& plan : merged) {
+        merge(plan);
+      }
+    }
+
+    std::random_device device;
+    std::ostringstream name;
+    name << path << "." << std::hex << device() << device() << ".tmp";
+    const std::string temporary = name.str();
+    std::ofstream out(temporary);
+    out << header << "\n" << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+    for(const SolverPlan& plan : plans) {
+      out << std::hex << plan.key << std::dec << " " << plan.size << " " << isa_name(plan.isa) << " "
+          << solverName(plan.solver) << " " << plan.measured << " " << plan.relaxation.jacobiDamping << " "
+          << plan.relaxation.sorOmega << " " << plan.relaxation.chebyshev.min << " "
+          << plan.relaxation.chebyshev.max << "\n";
+    }
+
+    out.close();
+
+    if(out.fail()) {
+      std::remove(temporary.c_str());
+      return false;
+    }
+
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+  }
+
+  /* Return the plan for the given operator on this instruction set level, a
+     measured one if measured is set, or nullptr if there is none */
+  const SolverPlan *find(std::uint64_t key, std::size_t size, bool measured = false) const {
+    for(const SolverPlan& plan : plans) {
+      if(plan.key == key && plan.size == size && plan.isa == isa_level() && (plan.measured || !measured)) {
+        return &plan;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /* Add the plan, replacing the one for the same operator */
+  void insert(const SolverPlan& plan) {
+    for(SolverPlan& existing : plans) {
+      if(existing.key == plan.key && existing.size == plan.size && existing.isa == plan.isa) {
+        existing = plan;
+        return;
+      }
+    }
+
+    plans.push_back(plan);
+  }
+
+  /* Return the plan for A from the cache, or make it with the given effort
+     and write it to the file. A measured plan also answers an Estimate
+     request, as it is the better one */
+  template<typename T, class MatrixImpl, std::size_t n>
+  SolverPlan plan(
+    const MatrixLike<T, MatrixImpl, n, n>& A,
+    Workspace<T, n>& workspace,
+    PlanEffort effort = PlanEffort::Estimate,
+    double tolerance = 1.e-5) {
+
+    const SolverPlan *cached = find(operatorHash(A, workspace), n, effort == PlanEffort::Measure);
+
+    if(cached != nullptr) {
+      ++hitCount;
+      return *cached;
+    }
+
+    ++missCount;
+    const SolverPlan made = makePlan(A, workspace, effort, tolerance);
+    insert(made);
+    save();
+    return made;
+  }
+
+  /* Return the number of plans */
+  std::size_t size() const {
+    return plans.size();
+  }
+
+  /* Return the number of lookups answered from the cache */
+  unsigned int hits() const {
+    return hitCount;
+  }
+
+  /* Return the number of plans made */
+  unsigned int misses() const {
+    return missCount;
+  }
+};
@@ -0,0 +1,172 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "Workspace.h"
+#include "Plan.h"
+#include "TestProblems.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// -u'' + c u' with the convection term upwinded
+template<size_t numPoints>
+Stencil<double, numPoints, numPoints> convectionStencil(double c) {
+	const double hx = 1. / (numPoints - 1), hxSq = hx * hx;
+	return Stencil<double, numPoints, numPoints>({ { 0, 1. } }, { { -1, -1. / hxSq - c / hx },{ 0, 2. / hxSq + c / hx },{ 1, -1. / hxSq } });
+}
+
+const std::string path = "PlanTest.plans";
+
+// equal operators have equal hashes, different ones different hashes
+void test_hash() {
+	TESTCASE("test_hash");
+	constexpr size_t n = 33;
+	Workspace<double, n> workspace;
+	const auto A = poissonStencil<n>();
+	const auto sameA = poissonStencil<n>();
+	const std::uint64_t hash = operatorHash(A, workspace);
+	assert("same entries, same hash" && operatorHash(sameA, workspace) == hash);
+	assert("other entries, other hash" && operatorHash(convectionStencil<n>(1.), workspace) != hash);
+
+	std::unique_ptr<Matrix<double, n, n>> dense(new Matrix<double, n, n>([] (size_t i, size_t j) { return 1. / (1. + i + 2. * j); }));
+	std::unique_ptr<Matrix<double, n, n>> copy(new Matrix<double, n, n>(*dense));
+	assert("dense matrices" && operatorHash(*copy, workspace) == operatorHash(*dense, workspace));
+	(*copy)(n - 1, 0) += 1.e-12;
+	assert("one entry changed" && operatorHash(*copy, workspace) != operatorHash(*dense, workspace));
+}
+
+// the estimated plan picks CG for the symmetric stencil and BiCGSTAB for the nonsymmetric one
+void test_estimate() {
+	TESTCASE("test_estimate");
+	constexpr size_t n = 129;
+	Workspace<double, n> workspace;
+	const auto b = rhs<n>();
+
+	const auto A = poissonStencil<n>();
+	assert("Poisson symmetric" && isSymmetric(A, workspace));
+	const SolverPlan plan = makePlan(A, workspace);
+	assert("CG for Poisson" && plan.solver == PlannedSolver::CG && !plan.measured && plan.size == n);
+	const double c = cos(PI / (n - 1));
+	assert("spectrum estimated" && std::abs(plan.relaxation.chebyshev.min - (1. - c)) < 1.e-6);
+
+	Vector<double, n> u(0.0), expected(0.0);
+	const unsigned int its = solvePlanned(plan, A, b, u, workspace);
+	assert("planned solve is the CG solve" && its == pcg(A, b, expected, workspace) && u == expected);
+
+	const auto C = convectionStencil<n>(20.);
+	assert("convection nonsymmetric" && !isSymmetric(C, workspace));
+	const SolverPlan convectionPlan = makePlan(C, workspace);
+	assert("BiCGSTAB for convection" && convectionPlan.solver == PlannedSolver::BiCGSTAB);
+	u = Vector<double, n>(0.0);
+	solvePlanned(convectionPlan, C, b, u, workspace);
+	checkConverged(C, b, u);
+}
+
+// the measured plan picks one of the converging solvers
+void test_measure() {
+	TESTCASE("test_measure");
+	constexpr size_t n = 65;
+	Workspace<double, n> workspace;
+	const auto b = rhs<n>();
+
+	const auto A = poissonStencil<n>();
+	const SolverPlan plan = makePlan(A, workspace, PlanEffort::Measure);
+	std::cout << "\tPoisson: " << solverName(plan.solver) << std::endl;
+	assert("measured" && plan.measured);
+	Vector<double, n> u(0.0);
+	solvePlanned(plan, A, b, u, workspace);
+	checkConverged(A, b, u);
+
+	const auto C = convectionStencil<n>(20.);
+	const SolverPlan convectionPlan = makePlan(C, workspace, PlanEffort::Measure);
+	std::cout << "\tconvection: " << solverName(convectionPlan.solver) << std::endl;
+	assert("no CG for convection" && convectionPlan.solver != PlannedSolver::CG);
+	u = Vector<double, n>(0.0);
+	solvePlanned(convectionPlan, C, b, u, workspace);
+	checkConverged(C, b, u);
+}
+
+// plans are made once, written to the file, and read back exactly by later caches
+void test_cache() {
+	TESTCASE("test_cache");
+	constexpr size_t n = 129;
+	Workspace<double, n> workspace;
+	const auto A = poissonStencil<n>();
+	const auto C = convectionStencil<n>(20.);
+	std::remove(path.c_str());
+
+	SolverPlan plan, convectionPlan;
+	{
+		PlanCache cache(path);
+		assert("empty" && cache.size() == 0);
+		plan = cache.plan(A, workspace);
+		convectionPlan = cache.plan(C, workspace);
+		assert("planned once" && cache.plan(A, workspace).key == plan.key && cache.misses() == 2 && cache.hits() == 1);
+	}
+
+	PlanCache cache(path);
+	assert("plans read back" && cache.size() == 2);
+	const SolverPlan cached = cache.plan(A, workspace);
+	assert("from the file" && cache.hits() == 1 && cache.misses() == 0);
+	assert("same plan" && cached.key == plan.key && cached.solver == plan.solver && cached.isa == plan.isa &&
+	       cached.relaxation.jacobiDamping == plan.relaxation.jacobiDamping &&
+	       cached.relaxation.sorOmega == plan.relaxation.sorOmega &&
+	       cached.relaxation.chebyshev.min == plan.relaxation.chebyshev.min &&
+	       cached.relaxation.chebyshev.max == plan.relaxation.chebyshev.max);
+	assert("other plan" && cache.plan(C, workspace).solver == convectionPlan.solver && cache.hits() == 2);
+
+	// an estimated plan does not answer a measure request, the measured one replaces it
+	const SolverPlan measured = cache.plan(A, workspace, PlanEffort::Measure);
+	assert("measured on request" && measured.measured && cache.misses() == 1 && cache.size() == 2);
+	assert("measured plan answers estimates" && cache.plan(A, workspace).measured && cache.hits() == 3);
+
+	// caches sharing the file keep each other's plans, measured ones are not replaced by estimates
+	std::remove(path.c_str());
+	{
+		PlanCache first(path), second(path);
+		first.plan(A, workspace, PlanEffort::Measure);
+		second.plan(C, workspace);
+		assert("plans of the other cache picked up" && first.size() == 1 && second.size() == 2);
+		assert("answered with them" && second.plan(A, workspace).measured && second.hits() == 1 && second.misses() == 1);
+	}
+	assert("plans merged" && cache.load() && cache.size() == 2);
+	assert("measured plan kept" && cache.plan(A, workspace, PlanEffort::Measure).measured && cache.misses() == 1);
+
+	// malformed files leave the cache empty
+	std::ofstream(path) << "advpt-plans 2\n0123 129 sse2 newton 0 1 1 0 2\n";
+	assert("malformed rejected" && !cache.load() && cache.size() == 0);
+	std::ofstream(path) << "advpt-plans 1\n";
+	assert("older version rejected" && !cache.load() && cache.size() == 0);
+	std::ofstream(path) << "something else\n";
+	assert("other file rejected" && !cache.load() && cache.size() == 0);
+	std::remove(path.c_str());
+	assert("missing file" && !cache.load() && cache.size() == 0);
+}
+
+int main() {
+	test_hash();
+	test_estimate();
+	test_measure();
+	test_cache();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
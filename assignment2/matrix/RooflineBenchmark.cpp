@@ -0,0 +1,253 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "../../common/CpuDispatch.h"
+
+// vectors of 2^e elements for e = ROOFLINE_MIN_EXPONENT, +2, ..., ROOFLINE_MAX_EXPONENT: 8 KiB (in L1) to
+// 128 MiB (in DRAM) per vector; the matrices have as many elements as the vectors
+constexpr size_t ROOFLINE_MIN_EXPONENT = 10;
+constexpr size_t ROOFLINE_MAX_EXPONENT = 24;
+
+// results returned by value are temporaries on the stack, so the operators returning a vector are only
+// measured up to this many elements
+constexpr size_t ROOFLINE_BY_VALUE_MAX = size_t(1) << 19;
+
+// vector registers kept busy by the peak flop kernel, enough to hide the latency of the adds and multiplies
+constexpr size_t PEAK_REGISTERS = 12;
+
+// util timer
+
+double measureTime(std::function<void( )> toMeasure) {
+	std::chrono::time_point<std::chrono::steady_clock> start, end;
+	start = std::chrono::steady_clock::now( );
+	toMeasure( );
+	end = std::chrono::steady_clock::now( );
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count( );
+}
+
+// seconds per call of the fastest of three runs, each repeating f until it takes at least minTime
+
+double timePerCall(const std::function<void( )>& f, double minTime) {
+	size_t numReps = 1;
+	auto run = [&] {
+		return measureTime([&] {
+			for (size_t r = 0; r < numReps; ++r) {
+				f( );
+			}
+		}) / numReps;
+	};
+	while (run( ) * numReps < minTime) {
+		numReps *= 2;
+	}
+	double best = run( );
+	for (int k = 0; k < 2; ++k) {
+		best = std::min(best, run( ));
+	}
+	return best;
+}
+
+// peak flop rate: independent chains x = x * a + b, built for each instruction set level like the kernels
+// (see Kernels.h), so the peak is the one the kernels can reach with the multiplies and adds not contracted
+
+template<size_t chains>
+ISA_KERNEL double peakBody(size_t numReps) {
+	double x[chains];
+	for (size_t k = 0; k < chains; ++k) {
+		x[k] = 1.0 + k * 1e-3;
+	}
+	const double a = 0.999999, b = 1e-7;
+	for (size_t r = 0; r < numReps; ++r) {
+		for (size_t k = 0; k < chains; ++k) {
+			x[k] = x[k] * a + b;
+		}
+	}
+	double sum = 0.0;
+	for (size_t k = 0; k < chains; ++k) {
+		sum += x[k];
+	}
+	return sum;
+}
+
+double peakSSE2(size_t numReps) {
+	return peakBody<PEAK_REGISTERS * 2>(numReps);
+}
+
+ISA_TARGET_AVX2 double peakAVX2(size_t numReps) {
+	return peakBody<PEAK_REGISTERS * 4>(numReps);
+}
+
+ISA_TARGET_AVX512 double peakAVX512(size_t numReps) {
+	return peakBody<PEAK_REGISTERS * 8>(numReps);
+}
+
+// returns the peak in GFLOP/s
+
+double measurePeak(double minTime) {
+	constexpr size_t numReps = 100000;
+	volatile double sink = 0.0;
+	const size_t chains = PEAK_REGISTERS * isa_vector_doubles(isa_level( ));
+	const double time = timePerCall([&] { sink = isa_dispatch(isa_level( ), peakSSE2, peakAVX2, peakAVX512, numReps); }, minTime);
+	(void)sink;
+	return 2.0 * chains * numReps / time * 1e-9;
+}
+
+// STREAM kernels, built for each instruction set level like the peak kernel
+
+enum class StreamKernel {
+	Copy, Scale, Add, Triad
+};
+
+template<StreamKernel kernel>
+ISA_KERNEL void streamBody(double *__restrict a, double *__restrict b, double *__restrict c, size_t numElements) {
+	const double s = 3.0;
+	for (size_t i = 0; i < numElements; ++i) {
+		if constexpr (kernel == StreamKernel::Copy) {
+			c[i] = a[i];
+		} else if constexpr (kernel == StreamKernel::Scale) {
+			b[i] = s * c[i];
+		} else if constexpr (kernel == StreamKernel::Add) {
+			c[i] = a[i] + b[i];
+		} else {
+			a[i] = b[i] + s * c[i];
+		}
+	}
+}
+
+template<StreamKernel kernel>
+void streamSSE2(double *a, double *b, double *c, size_t numElements) {
+	streamBody<kernel>(a, b, c, numElements);
+}
+
+template<StreamKernel kernel>
+ISA_TARGET_AVX2 void streamAVX2(double *a, double *b, double *c, size_t numElements) {
+	streamBody<kernel>(a, b, c, numElements);
+}
+
+template<StreamKernel kernel>
+ISA_TARGET_AVX512 void streamAVX512(double *a, double *b, double *c, size_t numElements) {
+	streamBody<kernel>(a, b, c, numElements);
+}
+
+template<StreamKernel kernel>
+void stream(double *a, double *b, double *c, size_t numElements) {
+	isa_dispatch(isa_level( ), streamSSE2<kernel>, streamAVX2<kernel>, streamAVX512<kernel>, a, b, c, numElements);
+}
+
+// STREAM kernels over three arrays of numElements, returns the best of their bandwidths in GB/s
+
+double measureStream(size_t numElements, double minTime) {
+	std::vector<double> a(numElements, 1.0), b(numElements, 2.0), c(numElements, 0.0);
+	const double copy = timePerCall([&] { stream<StreamKernel::Copy>(a.data( ), b.data( ), c.data( ), numElements); }, minTime);
+	const double scale = timePerCall([&] { stream<StreamKernel::Scale>(a.data( ), b.data( ), c.data( ), numElements); }, minTime);
+	const double add = timePerCall([&] { stream<StreamKernel::Add>(a.data( ), b.data( ), c.data( ), numElements); }, minTime);
+	const double triad = timePerCall([&] { stream<StreamKernel::Triad>(a.data( ), b.data( ), c.data( ), numElements); }, minTime);
+	volatile double sink = a[numElements / 2];
+	(void)sink;
+
+	const double bytes = 8.0 * numElements;
+	const double rates[] = { 2 * bytes / copy * 1e-9, 2 * bytes / scale * 1e-9, 3 * bytes / add * 1e-9, 3 * bytes / triad * 1e-9 };
+	std::cout << 3 * bytes / 1024;
+	double best = 0.0;
+	for (double rate : rates) {
+		std::cout << "\t" << rate;
+		best = std::max(best, rate);
+	}
+	std::cout << std::endl;
+	return best;
+}
+
+// measured roofs: the peak flop rate and the STREAM bandwidth by working set. Like STREAM, the bytes count
+// every element read or written once, without the cache line reads before writes to a separate array, so
+// kernels writing in place (operator+=) can come out above 100%
+
+struct Roofline {
+	double peak;
+	std::vector<std::pair<double, double>> bandwidths; // working set [B], GB/s
+
+	// bandwidth of the smallest working set holding the given one, the one of the largest beyond
+	double bandwidth(double workingSet) const {
+		for (const auto& measured : bandwidths) {
+			if (measured.first >= workingSet) {
+				return measured.second;
+			}
+		}
+		return bandwidths.back( ).second;
+	}
+};
+
+// prints a kernel taking the given time per call, with its flops, the bytes it has to move at least and the
+// bytes it works on
+
+void report(const std::string& name, double time, double flops, double bytes, double workingSet, const Roofline& roofline) {
+	const double intensity = flops / bytes, gflops = flops / time * 1e-9;
+	const double roof = std::min(roofline.peak, intensity * roofline.bandwidth(workingSet));
+	std::cout << name << "\t" << workingSet / 1024 << "\t" << intensity << "\t" << bytes / time * 1e-9 << "\t"
+	          << gflops << "\t" << roof << "\t" << 100.0 * gflops / roof << std::endl;
+}
+
+// the kernels for vectors of 2^exponent elements and the matrix of as many elements
+
+template<size_t exponent>
+void benchmarkKernels(const Roofline& roofline, double minTime) {
+	constexpr size_t n = size_t(1) << exponent;
+	constexpr size_t m = size_t(1) << (exponent / 2);
+	const double hxSq = 1. / ((n - 1) * (n - 1));
+
+	std::unique_ptr<Vector<double, n>> a(new Vector<double, n>(0.0)), b(new Vector<double, n>(0.0)), c(new Vector<double, n>(0.0));
+	a->iota(1.0, 1e-6);
+	b->iota(-1.0, 1e-9);
+	std::unique_ptr<Stencil<double, n, n>> stencil(new Stencil<double, n, n>({ { 0, 1. } }, { { -1, 1. / hxSq },{ 0, -2. / hxSq },{ 1, 1. / hxSq } }));
+	std::unique_ptr<Matrix<double, m, m>> matrix(new Matrix<double, m, m>([] (size_t i, size_t j) { return 1.0 / (1.0 + i + j); }));
+	std::unique_ptr<Vector<double, m>> x(new Vector<double, m>(1.0)), y(new Vector<double, m>(0.0));
+	volatile double sink = 0.0;
+
+	const double bytes = 8.0 * n;
+	if constexpr (n <= ROOFLINE_BY_VALUE_MAX) {
+		const double time = timePerCall([&] { *c = *a + *b; }, minTime);
+		report("Vector::operator+", time, n, 3 * bytes, 3 * bytes, roofline);
+	}
+	report("Vector::operator+=", timePerCall([&] { *a += *b; }, minTime), n, 3 * bytes, 2 * bytes, roofline);
+	report("Vector::l2Norm", timePerCall([&] { sink = a->l2Norm( ); }, minTime), 2 * n, bytes, bytes, roofline);
+	if constexpr (n <= ROOFLINE_BY_VALUE_MAX) {
+		const double time = timePerCall([&] { *c = *stencil * *a; }, minTime);
+		report("Stencil::operator*", time, 5 * n, 2 * bytes, 2 * bytes, roofline);
+	}
+	report("Stencil::apply", timePerCall([&] { stencil->apply(*a, *c); }, minTime), 5 * n, 2 * bytes, 2 * bytes, roofline);
+	report("Matrix::operator*", timePerCall([&] { *y = *matrix * *x; }, minTime), 2.0 * m * m, 8.0 * (m * m + 2 * m),
+	       8.0 * (m * m + 2 * m), roofline);
+
+	sink = (*c)(n / 2) + (*y)(m / 2);
+	(void)sink;
+}
+
+template<size_t... exponents>
+void benchmarkSizes(const Roofline& roofline, double minTime, std::index_sequence<exponents...>) {
+	(benchmarkKernels<ROOFLINE_MIN_EXPONENT + 2 * exponents>(roofline, minTime), ...);
+}
+
+int main(int argc, char** argv) {
+	double minTime = (argc > 1) ? std::stod(argv[1]) : 0.02;
+
+	Roofline roofline;
+	roofline.peak = measurePeak(minTime);
+	std::cout << "peak (" << isa_name(isa_level( )) << "): " << roofline.peak << " GFLOP/s" << std::endl;
+
+	std::cout << "size[KiB]\tcopy[GB/s]\tscale[GB/s]\tadd[GB/s]\ttriad[GB/s]" << std::endl;
+	for (size_t exponent = ROOFLINE_MIN_EXPONENT; exponent <= ROOFLINE_MAX_EXPONENT; exponent += 2) {
+		const size_t numElements = size_t(1) << exponent;
+		roofline.bandwidths.emplace_back(24.0 * numElements, measureStream(numElements, minTime));
+	}
+
+	std::cout << "kernel\tsize[KiB]\tintensity[flop/B]\t[GB/s]\t[GFLOP/s]\troofline[GFLOP/s]\troofline[%]" << std::endl;
+	benchmarkSizes(roofline, minTime, std::make_index_sequence<(ROOFLINE_MAX_EXPONENT - ROOFLINE_MIN_EXPONENT) / 2 + 1>{});
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Steppable.h"
+
+/* Iterations a solve advances before it goes back to its queue */
+constexpr unsigned int SCHEDULER_SLICE = 64;
+
+/* Runs many resumable solves on a pool of threads. Every worker has its own
+   queue of solves: it takes the solve at the front, advances it by a slice of
+   iterations and puts it back at the end, so the solves of a queue take turns
+   and short ones finish after a few slices instead of waiting for the long
+   ones. A worker whose queue is empty steals from the end of another queue,
+   which keeps all threads busy as long as there are more solves than threads.
+   A solve ends once it converged, failed, used up its iteration budget or was
+   cancelled, so a solve that never converges does not hold a worker forever.
+   Solves are given by reference and have to outlive their run */
+class SolveScheduler {
+private:
+  /* A submitted solve, the function called once it ended, the iterations
+     it may still do and the cancel generation it was submitted in */
+  struct Task {
+    Steppable *solve;
+    std::function<void()> done;
+    unsigned int budget;
+    unsigned int generation;
+  };
+
+  /* Queue of one worker, with its own lock so that the workers do not
+     contend for a single queue */
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /* Iterations per slice */
+  unsigned int slice;
+  /* Queues and threads of the workers */
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+  /* Queue the next submitted solve goes to */
+  std::size_t next = 0;
+  /* Solves waiting in the queues (counted before they are queued, so it is
+     never lower than the actual number) and solves not converged yet */
+  std::size_t queued = 0, pending = 0;
+  bool stopping = false;
+  /* Bumped by cancel, solves submitted before are not advanced any further */
+  std::atomic<unsigned int> generation{0};
+  /* Guards the counters, with the conditions for work and for completion */
+  std::mutex mutex;
+  std::condition_variable work, finished;
+
+  /* Put a task at the end of the given queue */
+  void push(std::size_t queue, Task&& task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++queued;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+      queues[queue]->tasks.push_back(std::move(task));
+    }
+
+    work.notify_one();
+  }
+
+  /* Take the front task of the own queue, or the last one of another queue */
+  bool take(std::size_t self, Task& task) {
+    for(std::size_t k = 0; k < queues.size(); ++k) {
+      Queue& queue = *queues[(self + k) % queues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+
+      if(!queue.tasks.empty()) {
+        if(k == 0) {
+          task = std::move(queue.tasks.front());
+          queue.tasks.pop_front();
+        } else {
+          task = std::move(queue.tasks.back());
+          queue.tasks.pop_back();
+        }
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /* Work loop of worker self */
+  void run(std::size_t self) {
+    Task task;
+
+    while(true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        work.wait(lock, [this] { return stopping || queued > 0; });
+
+        if(queued == 0) {
+          return;
+        }
+      }
+
+      /* The task may be queued but not pushed yet, or taken by another
+         worker in the meantime */
+      if(!take(self, task)) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        --queued;
+      }
+
+      /* Solves that make no progress, like failed ones, end as well */
+      if(task.generation == generation && task.budget > 0) {
+        const unsigned int before = task.solve->iterations();
+        const bool converged = task.solve->step(std::min(slice, task.budget));
+        const unsigned int done = task.solve->iterations() - before;
+        task.budget -= std::min(task.budget, done);
+
+        if(!converged && done > 0) {
+          push(self, std::move(task));
+          continue;
+        }
+      }
+
+      if(task.done) {
+        task.done();
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        --pending;
+      }
+
+      finished.notify_all();
+    }
+  }
+public:
+  /* SolveScheduler constructor, zero threads uses one per processor */
+  explicit SolveScheduler(unsigned int threads = 0, unsigned int slice = SCHEDULER_SLICE) : slice(slice) {
+    if(threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for(unsigned int t = 0; t < threads; ++t) {
+      queues.emplace_back(new Queue());
+    }
+
+    for(unsigned int t = 0; t < threads; ++t) {
+      workers.emplace_back(&SolveScheduler::run, this, t);
+    }
+  }
+
+  /* The workers refer to the scheduler, so it can not be copied */
+  SolveScheduler(const SolveScheduler&) = delete;
+  SolveScheduler& operator=(const SolveScheduler&) = delete;
+
+  /* SolveScheduler destructor, finishing all submitted solves first, which
+     takes at most their iteration budgets unless they are cancelled */
+  ~SolveScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+
+    work.notify_all();
+
+    for(std::thread& worker : workers) {
+      worker.join();
+    }
+  }
+
+  /* Queue a solve to be advanced by at most maxIterations, done is called on
+     the worker that ended it, whether it converged or not */
+  void submit(Steppable& solve, std::function<void()> done = nullptr, unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+    std::size_t queue;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++pending;
+      queue = next++ % queues.size();
+    }
+
+    push(queue, Task{ &solve, std::move(done), maxIterations, generation });
+  }
+
+  /* End all submitted solves at their next turn without advancing them any
+     further, solves submitted afterwards are run as usual */
+  void cancel() {
+    ++generation;
+  }
+
+  /* Wait until all submitted solves have ended */
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return pending == 0; });
+  }
+
+  /* Return the number of worker threads */
+  std::size_t threads() const {
+    return workers.size();
+  }
+};
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+#include "Matrix.h"
+#include "SmallKernels.h"
+
+// util timer
+
+double measureTime(std::function<void( )> toMeasure) {
+	std::chrono::time_point<std::chrono::steady_clock> start, end;
+	start = std::chrono::steady_clock::now( );
+	toMeasure( );
+	end = std::chrono::steady_clock::now( );
+	std::chrono::duration<double> elapsed = end - start;
+	return elapsed.count( );
+}
+
+// the generic triple loop the unrolled kernels replace
+
+template<size_t n>
+std::array<double, n * n> loopProduct(const std::array<double, n * n>& a, const std::array<double, n * n>& b) {
+	std::array<double, n * n> c{ };
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			for (size_t k = 0; k < n; ++k) {
+				c[i * n + j] += a[i * n + k] * b[k * n + j];
+			}
+		}
+	}
+	return c;
+}
+
+// chains numReps products, so every product depends on the previous one
+
+template<size_t n>
+void benchmark(size_t numReps) {
+	std::array<double, n * n> a, b;
+	for (size_t i = 0; i < n * n; ++i) {
+		a[i] = std::sin(i + 1.0) / n;
+		b[i] = 0.0;
+	}
+
+	volatile double sink = 0.0;
+	double timeLoop = measureTime([&] {
+		std::array<double, n * n> c = a;
+		for (size_t r = 0; r < numReps; ++r) {
+			c = loopProduct<n>(c, a);
+			c[0] += 1.0;
+		}
+		sink = c[0];
+	});
+	double timeUnrolled = measureTime([&] {
+		std::array<double, n * n> c = a;
+		for (size_t r = 0; r < numReps; ++r) {
+			c = small_product<double, n, n, n>(c, a);
+			c[0] += 1.0;
+		}
+		sink = c[0];
+	});
+
+	std::cout << n << "x" << n << "\t" << timeLoop / numReps * 1e9 << "\t" << timeUnrolled / numReps * 1e9
+	          << "\t" << timeLoop / timeUnrolled << std::endl;
+	(void)sink;
+}
+
+template<size_t... sizes>
+void benchmarkSizes(size_t numReps, std::index_sequence<sizes...>) {
+	(benchmark<sizes + 2>(numReps), ...);
+}
+
+int main(int argc, char** argv) {
+	size_t numReps = (argc > 1) ? std::stoul(argv[1]) : 1000000;
+	std::cout << "size\tloop[ns]\tunrolled[ns]\tspeedup" << std::endl;
+	benchmarkSizes(numReps, std::make_index_sequence<SMALL_KERNEL_MAX_SIZE - 1>{});
+}
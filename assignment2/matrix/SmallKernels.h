@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+/* Fully unrolled kernels for products of small matrices whose dimensions are
+   known at compile time. Every element of the result is a fold expression
+   over the summation index, so no loops are left for the optimizer to
+   unroll, the operands can be kept in registers, and all kernels can be
+   evaluated in constant expressions */
+
+/* Largest dimension handled by the unrolled kernels */
+constexpr std::size_t SMALL_KERNEL_MAX_SIZE = 8;
+
+/* Check whether a rows x inner times inner x cols product uses the kernels */
+template<std::size_t rows, std::size_t inner, std::size_t cols>
+constexpr bool use_small_kernel =
+  rows > 0 && inner > 0 && cols > 0 &&
+  rows <= SMALL_KERNEL_MAX_SIZE && inner <= SMALL_KERNEL_MAX_SIZE && cols <= SMALL_KERNEL_MAX_SIZE;
+
+/* Element idx (row-major) of the product of a (rows x inner) and b (inner x cols) */
+template<typename T, std::size_t rows, std::size_t inner, std::size_t cols, std::size_t idx, std::size_t... k>
+constexpr T small_product_entry(
+  const std::array<T, rows * inner>& a,
+  const std::array<T, inner * cols>& b,
+  std::index_sequence<k...>) {
+
+  constexpr std::size_t i = idx / cols;
+  constexpr std::size_t j = idx % cols;
+  return (... + (a[i * inner + k] * b[k * cols + j]));
+}
+
+template<typename T, std::size_t rows, std::size_t inner, std::size_t cols, std::size_t... idx>
+constexpr std::array<T, rows * cols> small_product(
+  const std::array<T, rows * inner>& a,
+  const std::array<T, inner * cols>& b,
+  std::index_sequence<idx...>) {
+
+  return {{ small_product_entry<T, rows, inner, cols, idx>(a, b, std::make_index_sequence<inner>{})... }};
+}
+
+/* Product of a (rows x inner) and b (inner x cols), both stored row-major */
+template<typename T, std::size_t rows, std::size_t inner, std::size_t cols>
+constexpr std::array<T, rows * cols> small_product(
+  const std::array<T, rows * inner>& a,
+  const std::array<T, inner * cols>& b) {
+
+  return small_product<T, rows, inner, cols>(a, b, std::make_index_sequence<rows * cols>{});
+}
+
+/* Product of a (rows x cols) with the vector v */
+template<typename T, std::size_t rows, std::size_t cols>
+constexpr std::array<T, rows> small_product(
+  const std::array<T, rows * cols>& a,
+  const std::array<T, cols>& v) {
+
+  return small_product<T, rows, cols, 1>(a, v, std::make_index_sequence<rows>{});
+}
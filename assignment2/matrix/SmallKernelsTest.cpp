@@ -0,0 +1,111 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include "Matrix.h"
+#include "Vector.h"
+#include "SmallKernels.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+bool almostEqual(double a, double b, double epsilon = 1e-13) {
+	return std::abs(a - b) <= epsilon;
+}
+
+// compile-time checks: the kernels are usable in constant expressions
+constexpr std::array<int, 4> a22{ { 1, 2, 3, 4 } };
+constexpr std::array<int, 6> a23{ { 1, 2, 3, 4, 5, 6 } };
+constexpr std::array<int, 4> p22 = small_product<int, 2, 2, 2>(a22, a22);
+static_assert(p22[0] == 7 && p22[1] == 10 && p22[2] == 15 && p22[3] == 22, "2x2 product");
+constexpr std::array<int, 6> p23 = small_product<int, 2, 2, 3>(a22, a23);
+static_assert(p23[0] == 9 && p23[2] == 15 && p23[5] == 33, "2x2 times 2x3 product");
+constexpr std::array<int, 2> v2 = small_product<int, 2, 2>(a22, std::array<int, 2>{ { 1, 1 } });
+static_assert(v2[0] == 3 && v2[1] == 7, "matrix vector product");
+static_assert(use_small_kernel<8, 8, 8> && !use_small_kernel<9, 2, 2> && !use_small_kernel<0, 2, 2>, "kernel selection");
+
+// compares the kernels with the straightforward loops for one set of sizes
+template<size_t rows, size_t inner, size_t cols>
+void checkProduct() {
+	Matrix<double, rows, inner> a(0.0);
+	Matrix<double, inner, cols> b(0.0);
+	for (size_t i = 0; i < rows; ++i) {
+		for (size_t k = 0; k < inner; ++k) {
+			a(i, k) = std::sin(1.0 + i + 0.3 * k);
+		}
+	}
+	for (size_t k = 0; k < inner; ++k) {
+		for (size_t j = 0; j < cols; ++j) {
+			b(k, j) = std::cos(2.0 + 0.7 * k + j);
+		}
+	}
+	Matrix<double, rows, cols> c = a * b;
+	for (size_t i = 0; i < rows; ++i) {
+		for (size_t j = 0; j < cols; ++j) {
+			double sum = 0.0;
+			for (size_t k = 0; k < inner; ++k) {
+				sum += a(i, k) * b(k, j);
+			}
+			assert("unrolled product" && almostEqual(c(i, j), sum));
+		}
+	}
+}
+
+template<size_t n>
+void checkSquare() {
+	checkProduct<n, n, n>();
+	checkProduct<n, n, 1>();
+	checkProduct<1, n, n>();
+	Matrix<double, n, n> a(0.0);
+	Vector<double, n> v(0.0);
+	for (size_t i = 0; i < n; ++i) {
+		v(i) = i + 1.0;
+		for (size_t j = 0; j < n; ++j) {
+			a(i, j) = i * 10.0 + j;
+		}
+	}
+	Vector<double, n> r = a * v;
+	Matrix<double, n, n> p = a * a;
+	a *= a;
+	for (size_t i = 0; i < n; ++i) {
+		double sum = 0.0;
+		for (size_t j = 0; j < n; ++j) {
+			sum += (i * 10.0 + j) * (j + 1.0);
+			assert("product assignment" && a(i, j) == p(i, j));
+		}
+		assert("unrolled matrix vector product" && almostEqual(r(i), sum));
+	}
+}
+
+template<size_t... sizes>
+void checkSizes(std::index_sequence<sizes...>) {
+	(checkSquare<sizes + 1>(), ...);
+}
+
+void test_small_products() {
+	TESTCASE("test_small_products");
+	checkSizes(std::make_index_sequence<SMALL_KERNEL_MAX_SIZE>{});
+	checkProduct<2, 8, 3>();
+	checkProduct<7, 3, 5>();
+	// sizes above the limit still use the generic loops
+	checkProduct<9, 9, 9>();
+}
+
+int main() {
+	test_small_products();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
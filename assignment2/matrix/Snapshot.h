@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Hash.h"
+
+/* Returns a hash of the problem a solver works on: of the size, of the
+   product of the operator with a fixed random vector and of the right-hand
+   side, so a snapshot is only resumed for the problem it was taken from.
+   Takes one product, the temporaries are allocated, as snapshots are */
+template<typename T, class MatrixImpl, std::size_t n>
+std::uint64_t problemHash(const MatrixLike<T, MatrixImpl, n, n>& A, const Vector<T, n>& b) {
+  std::unique_ptr<Vector<T, n>> v = std::make_unique<Vector<T, n>>(0.0), w = std::make_unique<Vector<T, n>>(0.0);
+  std::minstd_rand random(42);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  v->generate([&] (std::size_t) { return uniform(random); });
+  A.apply(*v, *w);
+
+  const std::uint64_t size = n;
+  std::uint64_t hash = hashBytes(&size, sizeof(size));
+  hash = hashBytes(w->values().data(), n * sizeof(T), hash);
+  return hashBytes(b.values().data(), n * sizeof(T), hash);
+}
+
+/* State of a resumable solver, enough to continue the solve exactly where it
+   was taken: the solver name, the iterations done, its scalars (residual
+   norms, recurrence coefficients) and its vectors, the solution first,
+   with the problemHash of the problem it was taken for. Elements are stored as double, see Checkpoint.h for the file format */
+struct SolverSnapshot {
+  std::string solver;
+  unsigned int iterations = 0;
+  std::uint64_t problem = 0;
+  std::vector<double> scalars;
+  std::vector<std::vector<double>> vectors;
+
+  /* Append the elements of v */
+  template<typename T, std::size_t n>
+  void addVector(const Vector<T, n>& v) {
+    vectors.emplace_back(v.values().begin(), v.values().end());
+  }
+
+  /* Copy the k-th vector into v */
+  template<typename T, std::size_t n>
+  void copyVector(std::size_t k, Vector<T, n>& v) const {
+    for(std::size_t i = 0; i < n; ++i) {
+      v(i) = vectors[k][i];
+    }
+  }
+
+  /* Check if the snapshot was taken from the given solver for the given
+     problem, with the given number of scalars and vectors of n elements */
+  bool matches(const std::string& name, std::uint64_t problemKey, std::size_t scalarCount, std::size_t vectorCount, std::size_t n) const {
+    if(solver != name || problem != problemKey || scalars.size() != scalarCount || vectors.size() != vectorCount) {
+      return false;
+    }
+
+    for(const std::vector<double>& v : vectors) {
+      if(v.size() != n) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+};
+
+/* Interface of the solvers whose state can be saved and restored. A solver
+   resumed from a snapshot continues with the same iterations as the one the
+   snapshot was taken from, so a preempted solve can restart from its last
+   checkpoint instead of from the beginning */
+class Checkpointable {
+public:
+  virtual ~Checkpointable() {}
+
+  /* Return the current state, taken between iterations */
+  virtual SolverSnapshot snapshot() const = 0;
+
+  /* Continue from the given state instead of starting from u, has to be
+     called before the first step. Returns false and leaves u alone if the
+     snapshot does not come from the same solver for the same problem */
+  virtual bool resume(const SolverSnapshot& state) = 0;
+};
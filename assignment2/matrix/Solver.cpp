@@ -4,6 +4,7 @@
 #include "Matrix.h"
 #include "Vector.h"
 #include "Stencil.h"
+#include "Telemetry.h"
 
 #define PI 3.141592653589793
 
@@ -13,11 +14,14 @@ void solve (
   const Vector<T, numGridPoints>& b,
   Vector<T, numGridPoints>& u) {
 
+	SolverTelemetry telemetry(TELEMETRY_CAPACITY, 500); // record the residual every few steps, printed after the solve
+
 	double initRes = (b - A * u).l2Norm( ); // determine the initial residual
 	double curRes = initRes;
 	std::cout << "Initial residual:\t\t" << initRes << std::endl;
 
 	unsigned int curIt = 0; // store the current iteration index
+	TELEMETRY(&telemetry, begin("iterate"));
 
 	while (curRes > 1.e-5 * initRes) { // solve until the residual is reduced by a certain amount
 		++curIt;
@@ -25,11 +29,15 @@ void solve (
 		u += A.inverseDiagonal( ) * (b - A * u); // Jacobi step
 
 		curRes = (b - A * u).l2Norm( ); // update the residual
-
-		if (0 == curIt % 500) // print some info every few steps
-			std::cout << "Residual after iteration " << curIt << ":\t" << curRes << std::endl;
+		TELEMETRY(&telemetry, residual(curIt, curRes));
 	}
 
+	TELEMETRY(&telemetry, end("iterate", curIt, curRes));
+
+	for (const TelemetryRecord& record : telemetry.snapshot( ))
+		if (record.event == TelemetryEvent::Residual)
+			std::cout << "Residual after iteration " << record.iteration << ":\t" << record.residual << std::endl;
+
 	std::cout << "Residual after iteration " << curIt << ":\t" << curRes << std::endl << std::endl; // print the final number of iterations and the final residual
 }
 
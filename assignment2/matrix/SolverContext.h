@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Matrix.h"
+#include "BandedMatrix.h"
+#include "Factorization.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "CG.h"
+
+/* Initial guess a SolverContext starts each solve from */
+enum class WarmStart {
+  /* u as passed by the caller */
+  None,
+  /* The previous solution */
+  Previous,
+  /* Linear extrapolation from the last two solutions, 2 u1 - u2 */
+  Linear,
+  /* Quadratic extrapolation from the last three solutions, 3 u1 - 3 u2 + u3 */
+  Quadratic
+};
+
+/* State kept across consecutive solves of the same size, as in time-dependent
+   runs where b changes only slightly between calls. The context remembers
+   the last solutions and starts each iterative solve from their
+   extrapolation, and it caches the factorizations of direct solves. Cached
+   factorizations are kept per operator address together with a copy of the
+   entries they were computed from, so operators changed in place or rebuilt
+   at the same address are factorized again. invalidate() frees them */
+template<typename T, std::size_t n>
+class SolverContext {
+private:
+  /* Factorization behind a direct solve */
+  class Factorized {
+  public:
+    virtual ~Factorized() {}
+    virtual bool solve(const Vector<T, n>& b, Vector<T, n>& u) const = 0;
+  };
+
+  template<class Factorization, class Operator>
+  class FactorizedWith : public Factorized {
+  private:
+    /* Operator the factors were computed from */
+    Operator A;
+    Factorization factors;
+  public:
+    explicit FactorizedWith(const Operator& A) : A(A), factors(A) {}
+
+    /* Check if other has the entries the factors were computed from */
+    bool factorizes(const Operator& other) const {
+      return A.values() == other.values();
+    }
+
+    bool solve(const Vector<T, n>& b, Vector<T, n>& u) const override {
+      /* Factorizations that can fail report it from their solve */
+      if constexpr (std::is_void<decltype(factors.solve(b, u))>::value) {
+        factors.solve(b, u);
+        return true;
+      } else {
+        return factors.solve(b, u);
+      }
+    }
+  };
+
+  /* Initial guess used by the iterative solves */
+  WarmStart warmStart;
+  /* Scratch vectors */
+  Workspace<T, n> workspace;
+  /* Last solutions, the most recent first */
+  std::array<std::unique_ptr<Vector<T, n>>, 3> history;
+  std::size_t stored = 0;
+  /* Factorizations by operator */
+  std::unordered_map<const void *, std::unique_ptr<Factorized>> factorizations;
+
+  /* Overwrite u with the initial guess */
+  void guess(Vector<T, n>& u) const {
+    const std::size_t order = std::min<std::size_t>(static_cast<std::size_t>(warmStart), stored);
+
+    if(order == 0) {
+      return;
+    }
+
+    const Vector<T, n>& u1 = *history[0];
+
+    if(order == 1) {
+      u = u1;
+    } else if(order == 2) {
+      const Vector<T, n>& u2 = *history[1];
+
+      for(std::size_t i = 0; i < n; ++i) {
+        u(i) = 2.0 * u1(i) - u2(i);
+      }
+    } else {
+      const Vector<T, n>& u2 = *history[1];
+      const Vector<T, n>& u3 = *history[2];
+
+      for(std::size_t i = 0; i < n; ++i) {
+        u(i) = 3.0 * (u1(i) - u2(i)) + u3(i);
+      }
+    }
+  }
+
+  /* Remember u as the most recent solution, reusing the oldest slot. Only
+     converged solutions are recorded, a failed iterate would spoil the
+     guesses of all later solves */
+  void record(const Vector<T, n>& u) {
+    std::rotate(history.begin(), history.end() - 1, history.end());
+
+    if(history[0] == nullptr) {
+      history[0].reset(new Vector<T, n>(u));
+    } else {
+      *history[0] = u;
+    }
+
+    stored = std::min<std::size_t>(stored + 1, history.size());
+  }
+
+  /* Start an iterative solve from the guess. Returns the tolerance, relative
+     to the residual of the guess, that reaches the target of a solve from
+     zero, or zero if the guess already does. A guess whose residual is not
+     finite is replaced by zero */
+  template<class MatrixImpl>
+  double start(const MatrixLike<T, MatrixImpl, n, n>& A, const Vector<T, n>& b, Vector<T, n>& u, double tolerance) {
+    guess(u);
+
+    /* Starting from zero, the initial residual is the norm of b */
+    double sum = 0.0;
+
+    for(std::size_t i = 0; i < n; ++i) {
+      sum += b(i) * b(i);
+    }
+
+    /* No guess other than zero reaches a target of zero */
+    if(sum == 0.0) {
+      u = Vector<T, n>(0.0);
+      return 0.0;
+    }
+
+    const double target = tolerance * sqrt(sum);
+    const double guessRes = residual(A, b, u, workspace.vector(0));
+
+    if(!std::isfinite(guessRes)) {
+      u = Vector<T, n>(0.0);
+      return tolerance;
+    }
+
+    return (guessRes > target) ? target / guessRes : 0.0;
+  }
+
+  /* Return the cached factorization of A, factorizing it on first use and
+     whenever a different operator is found at its address */
+  template<class Factorization, class Operator>
+  const Factorized& factorized(const Operator& A) {
+    using Cached = FactorizedWith<Factorization, Operator>;
+    std::unique_ptr<Factorized>& entry = factorizations[&A];
+    const Cached *cached = dynamic_cast<const Cached *>(entry.get());
+
+    if(cached == nullptr || !cached->factorizes(A)) {
+      entry.reset(new Cached(A));
+    }
+
+    return *entry;
+  }
+public:
+  /* SolverContext constructor */
+  explicit SolverContext(WarmStart warmStart = WarmStart::Quadratic) : warmStart(warmStart) {}
+
+  /* The context owns its vectors, so it can not be copied */
+  SolverContext(const SolverContext&) = delete;
+  SolverContext& operator=(const SolverContext&) = delete;
+
+  /* Jacobi solve starting from the warm start. Solves until the residual is
+     reduced by the given factor relative to the norm of b, the target of a
+     solve from zero, and returns the number of iterations required, or
+     SOLVE_FAILED if that takes more than maxIterations or the solve breaks
+     down, in which case u is not remembered */
+  template<class MatrixImpl>
+  unsigned int jacobi(const MatrixLike<T, MatrixImpl, n, n>& A, const Vector<T, n>& b, Vector<T, n>& u, double tolerance = 1.e-5,
+                      unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+    const double relative = start(A, b, u, tolerance);
+    const unsigned int iterations = (relative > 0.0) ? ::jacobi(A, b, u, workspace, relative, nullptr, maxIterations) : 0;
+
+    if(iterations != SOLVE_FAILED) {
+      record(u);
+    }
+
+    return iterations;
+  }
+
+  /* Conjugate gradient solve with the Jacobi preconditioner, like jacobi() */
+  template<class MatrixImpl>
+  unsigned int pcg(const MatrixLike<T, MatrixImpl, n, n>& A, const Vector<T, n>& b, Vector<T, n>& u, double tolerance = 1.e-5,
+                   unsigned int maxIterations = SOLVE_MAX_ITERATIONS) {
+    const double relative = start(A, b, u, tolerance);
+    const unsigned int iterations = (relative > 0.0) ? ::pcg(A, b, u, workspace, relative, nullptr, maxIterations) : 0;
+
+    if(iterations != SOLVE_FAILED) {
+      record(u);
+    }
+
+    return iterations;
+  }
+
+  /* Direct solve with the cached LU factorization of A, returns false and
+     leaves u alone if A is singular */
+  bool solve(const Matrix<T, n, n>& A, const Vector<T, n>& b, Vector<T, n>& u) {
+    if(!factorized<DenseLU<T, n>>(A).solve(b, u)) {
+      return false;
+    }
+
+    record(u);
+    return true;
+  }
+
+  /* Direct solve with the cached banded LU factorization of A, returns false
+     and leaves u alone on a zero pivot */
+  template<std::size_t bandwidth>
+  bool solve(const BandedMatrix<T, n, n, bandwidth>& A, const Vector<T, n>& b, Vector<T, n>& u) {
+    if(!factorized<BandedLU<T, n, bandwidth>>(A).solve(b, u)) {
+      return false;
+    }
+
+    record(u);
+    return true;
+  }
+
+  /* Return the number of cached factorizations */
+  std::size_t cachedFactorizations() const {
+    return factorizations.size();
+  }
+
+  /* Return the number of solutions kept for the warm start */
+  std::size_t storedSolutions() const {
+    return stored;
+  }
+
+  /* Drop the cached operator data */
+  void invalidate() {
+    factorizations.clear();
+  }
+
+  /* Drop the cached data of A only */
+  void invalidate(const void *A) {
+    factorizations.erase(A);
+  }
+
+  /* Forget the previous solutions, e.g. when the run restarts */
+  void reset() {
+    stored = 0;
+  }
+};
@@ -0,0 +1,201 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "BandedMatrix.h"
+#include "SolverContext.h"
+#include "TestProblems.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// right-hand side of SolverTest at time step 0, changing slowly (and not
+// polynomially) in time
+template<size_t numPoints>
+Vector<double, numPoints> rhs(size_t step) {
+	const double t = 0.02 * step;
+	Vector<double, numPoints> b(0.0);
+	for (size_t x = 0; x < numPoints; ++x) {
+		const double s = x / (double)(numPoints - 1);
+		b(x) = sin(2. * PI * (1. + s)) * cos(t) + cos(PI * s) * (1. + sin(t));
+	}
+	return b;
+}
+
+// iterations of eight time steps, the first one from zero like the plain solver
+template<size_t numPoints>
+unsigned int timeSteps(WarmStart warmStart, bool cg, unsigned int firstIts) {
+	const auto A = poissonStencil<numPoints>();
+	SolverContext<double, numPoints> context(warmStart);
+	unsigned int total = 0;
+	for (size_t step = 0; step < 8; ++step) {
+		const auto b = rhs<numPoints>(step);
+		Vector<double, numPoints> u(0.0); // reset like testStencil does
+		unsigned int its = cg ? context.pcg(A, b, u) : context.jacobi(A, b, u);
+		checkConverged(A, b, u);
+		if (step == 0) {
+			assert("first solve like the plain solver" && its == firstIts);
+		}
+		total += its;
+	}
+	assert("solutions kept" && context.storedSolutions() == 3);
+	return total;
+}
+
+template<size_t numPoints>
+void checkWarmStart(unsigned int jacobiIts) {
+	const auto A = poissonStencil<numPoints>();
+	const auto b = rhs<numPoints>(0);
+	Workspace<double, numPoints> workspace;
+	Vector<double, numPoints> u(0.0);
+	const unsigned int cgIts = pcg(A, b, u, workspace);
+
+	for (bool cg : { false, true }) {
+		const unsigned int first = cg ? cgIts : jacobiIts;
+		const unsigned int none = timeSteps<numPoints>(WarmStart::None, cg, first);
+		const unsigned int previous = timeSteps<numPoints>(WarmStart::Previous, cg, first);
+		const unsigned int linear = timeSteps<numPoints>(WarmStart::Linear, cg, first);
+		const unsigned int quadratic = timeSteps<numPoints>(WarmStart::Quadratic, cg, first);
+		std::cout << "\t" << numPoints << " grid points, " << (cg ? "CG" : "Jacobi") << " iterations of 8 steps: none " << none
+		          << ", previous " << previous << ", linear " << linear << ", quadratic " << quadratic << std::endl;
+		assert("cold starts repeat the first solve" && none >= 7 * first);
+		// CG on these small grids ends after about half of the grid points from
+		// any start, so it only gains from the better extrapolations
+		assert("previous solution helps" && previous <= none && (cg || previous < none));
+		assert("extrapolation helps more" && linear <= previous && quadratic <= linear && quadratic < none);
+	}
+	// Jacobi gains most, as it is slow to remove the smooth error left by a cold start
+	assert("far fewer iterations" && 2 * timeSteps<numPoints>(WarmStart::Quadratic, false, jacobiIts) < 8 * jacobiIts);
+}
+
+void test_warm_start() {
+	TESTCASE("test_warm_start");
+	checkWarmStart<33>(743);
+	checkWarmStart<65>(2982);
+}
+
+// a guess that already meets the target takes no iterations
+void test_converged_guess() {
+	TESTCASE("test_converged_guess");
+	constexpr size_t n = 33;
+	const auto A = poissonStencil<n>();
+	const auto b = rhs<n>(0);
+	SolverContext<double, n> context(WarmStart::Previous);
+	Vector<double, n> u(0.0);
+	assert("first solve" && context.jacobi(A, b, u) == 743);
+	u = Vector<double, n>(0.0);
+	assert("same b again" && context.jacobi(A, b, u) == 0);
+	checkConverged(A, b, u);
+	context.reset();
+	u = Vector<double, n>(0.0);
+	assert("forgotten after reset" && context.jacobi(A, b, u) == 743);
+
+	// the solution for b = 0 is zero, not the previous one
+	const Vector<double, n> zero(0.0);
+	assert("zero right hand side" && context.pcg(A, zero, u) == 0 && u == zero);
+}
+
+// failed solves are not remembered, the next one still starts from a finite guess
+void test_failed_solve() {
+	TESTCASE("test_failed_solve");
+	constexpr size_t n = 33;
+	const auto A = poissonStencil<n>();
+	SolverContext<double, n> context(WarmStart::Quadratic);
+	Vector<double, n> u(0.0);
+	assert("first solve" && context.pcg(A, rhs<n>(0), u) != SOLVE_FAILED && context.storedSolutions() == 1);
+
+	Vector<double, n> nan = rhs<n>(1);
+	nan(n / 2) = std::nan("");
+	assert("broken down" && context.jacobi(A, nan, u) == SOLVE_FAILED && context.storedSolutions() == 1);
+	assert("limit reached" && context.jacobi(A, rhs<n>(1), u, 1.e-5, 5) == SOLVE_FAILED && context.storedSolutions() == 1);
+
+	const auto b = rhs<n>(1);
+	assert("solved from the previous solution" && context.jacobi(A, b, u) != SOLVE_FAILED && context.storedSolutions() == 2);
+	checkConverged(A, b, u);
+
+	// a zero pivot of a banded direct solve is reported and not remembered either
+	const BandedMatrix<double, n, n, 1> singular(1.0);
+	const Vector<double, n> before(u);
+	assert("zero pivot" && !context.solve(singular, b, u) && u == before && context.storedSolutions() == 2);
+
+	// a guess whose residual is not finite is replaced by zero
+	SolverContext<double, n> cold(WarmStart::None);
+	u(n / 2) = std::nan("");
+	assert("solved from zero" && cold.pcg(A, b, u) != SOLVE_FAILED);
+	checkConverged(A, b, u);
+}
+
+// factorizations are computed once per operator
+void test_factorizations() {
+	TESTCASE("test_factorizations");
+	constexpr size_t n = 40;
+	Matrix<double, n, n> A(0.0);
+	BandedMatrix<double, n, n, 1> banded(0.0);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			A(i, j) = (i == j) ? 4. + i : 1. / (1. + i + 2. * j);
+		}
+		banded(i, i) = 4.;
+		if (i > 0) banded(i, i - 1) = -1.;
+		if (i + 1 < n) banded(i, i + 1) = -1.5;
+	}
+
+	SolverContext<double, n> context;
+	for (size_t step = 0; step < 5; ++step) {
+		Vector<double, n> b([step] (size_t i) { return sin(0.3 * i + step); }), u(0.0), expected(0.0);
+		context.solve(A, b, u);
+		DenseLU<double, n>(A).solve(b, expected);
+		assert("dense solution" && u == expected);
+		context.solve(banded, b, u);
+		BandedLU<double, n, 1>(banded).solve(b, expected);
+		assert("banded solution" && u == expected);
+	}
+	assert("one factorization per operator" && context.cachedFactorizations() == 2);
+
+	// entries changed in place need the cache entry to be dropped
+	A(0, 0) = 100.;
+	context.invalidate(&A);
+	assert("dense factorization dropped" && context.cachedFactorizations() == 1);
+	Vector<double, n> b(1.0), u(0.0), expected(0.0);
+	context.solve(A, b, u);
+	DenseLU<double, n>(A).solve(b, expected);
+	assert("solution of the changed matrix" && u == expected);
+	context.invalidate();
+	assert("all factorizations dropped" && context.cachedFactorizations() == 0);
+
+	// operators rebuilt at the same address, or changed in place, are factorized again
+	for (double t : { 1., 2., 4. }) {
+		A = Matrix<double, n, n>([t] (size_t i, size_t j) { return (i == j) ? t : 0.; });
+		assert("solved" && context.solve(A, b, u));
+		assert("solution of the rebuilt matrix" && std::abs(u(0) - 1. / t) < 1e-15);
+	}
+	banded(3, 3) = 8.;
+	context.solve(banded, b, u);
+	BandedLU<double, n, 1>(banded).solve(b, expected);
+	assert("solution of the changed banded matrix" && u == expected);
+	assert("still one factorization per operator" && context.cachedFactorizations() == 2);
+}
+
+int main() {
+	test_warm_start();
+	test_converged_guess();
+	test_failed_solve();
+	test_factorizations();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
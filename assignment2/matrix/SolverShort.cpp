@@ -9,6 +9,7 @@
 #include "Matrix.h"
 #include "Vector.h"
 #include "Stencil.h"
+#include "Telemetry.h"
 
 #define PI 3.141592653589793
 
@@ -39,21 +40,24 @@ container_t shuffled(container_t container) {
 }
 
 // actual solver
-// return number of iterations required
+// return number of iterations required, recording the residuals in the telemetry if one is given
 
 template<typename T, typename MatrixImpl, size_t numPoints>
-int solve (const MatrixLike<T, MatrixImpl, numPoints, numPoints>& A, const Vector<T, numPoints>& b, Vector<T, numPoints>& u) {
+int solve (const MatrixLike<T, MatrixImpl, numPoints, numPoints>& A, const Vector<T, numPoints>& b, Vector<T, numPoints>& u, SolverTelemetry *telemetry = nullptr) {
 	double initRes = (b - A * u).l2Norm( ); // determine the initial residual
 	double curRes = initRes;
 
 	unsigned int curIt = 0; // store the current iteration index
+	TELEMETRY(telemetry, begin("iterate"));
 
 	while (curRes > 1.e-5 * initRes) { // solve until the residual is reduced by a certain amount
 		++curIt;
 		u += A.inverseDiagonal( ) * (b - A * u); // Jacobi step
 		curRes = (b - A * u).l2Norm( ); // update the residual
+		TELEMETRY(telemetry, residual(curIt, curRes));
 	}
 
+	TELEMETRY(telemetry, end("iterate", curIt, curRes));
 	return curIt;
 }
 
@@ -81,11 +85,11 @@ std::pair<int, double> testFullMatrix (const Vector<double, numPoints> b) {
 }
 
 
-// tests solver using the stencil class
+// tests solver using the stencil class, recording its residuals in the telemetry
 // returns number of iterations and runtime required
 
 template<size_t numPoints>
-std::pair<int, double> testStencil (const Vector<double, numPoints> b) {
+std::pair<int, double> testStencil (const Vector<double, numPoints> b, SolverTelemetry& telemetry) {
 	constexpr double hxSq = hxSqCalc<numPoints>( );
 
 	Vector<double, numPoints> u(0.);
@@ -93,7 +97,7 @@ std::pair<int, double> testStencil (const Vector<double, numPoints> b) {
 	Stencil<double, numPoints, numPoints> A ({ { 0, 1. } }, shuffled(innerStencil));
 
 	int numIts = 0;
-	double time = measureTime ([&] { numIts = solve(A, b, u); });
+	double time = measureTime ([&] { numIts = solve(A, b, u, &telemetry); });
 	return std::make_pair(numIts, time);
 }
 
@@ -108,12 +112,18 @@ void testImpl (int expectedNumIts) {
 		b(x) = sin(2. * PI * (1. + x / (double)(numPoints - 1))) + cos(PI * (x / (double)(numPoints - 1)));
 	}
 
+	SolverTelemetry telemetry(TELEMETRY_CAPACITY, 500);
 	auto resMatrix = testFullMatrix<numPoints>(b);
-	auto resStencil = testStencil<numPoints>(b);
+	auto resStencil = testStencil<numPoints>(b, telemetry);
 
 	std::cout << "\tThe matrix implementation required  " << resMatrix.first << " iterations and " << resMatrix.second << " seconds" << std::endl;
 	std::cout << "\tThe stencil implementation required " << resStencil.first << " iterations and " << resStencil.second << " seconds" << std::endl;
 	std::cout << "\tThis means a speedup factor of " << resMatrix.second / resStencil.second << std::endl;
+	std::cout << "\tResidual history of the stencil solve:";
+	for (const TelemetryRecord& record : telemetry.snapshot( ))
+		if (record.event == TelemetryEvent::Residual)
+			std::cout << " " << record.iteration << ": " << record.residual;
+	std::cout << std::endl;
 
 	assert(resMatrix.first == resStencil.first && "Number of iterations not equivalent for matrix-stencil comparison");
 	assert(resStencil.first == expectedNumIts && "Number of iterations required does not match expected result");
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+#include "Workspace.h"
+
+/* Default limit of Lanczos steps. The largest eigenvalue of the Poisson
+   operators converges within tens of steps, but the smallest one only
+   separates from its neighbours after about sqrt(condition number) steps,
+   as many as CG iterations take, which is the grid size for 1D Poisson */
+constexpr unsigned int LANCZOS_STEPS = 300;
+
+/* Default number of power iterations */
+constexpr unsigned int POWER_ITERATIONS = 500;
+
+/* Fraction of the interval width the Chebyshev interval is widened by at
+   the top, as the estimated largest eigenvalue is never above the exact one,
+   and Chebyshev iterations diverge for eigenvalues above their interval */
+constexpr double CHEBYSHEV_SAFETY = 0.05;
+
+/* Operator whose spectrum is estimated */
+enum class SpectrumOf {
+  /* A itself */
+  Operator,
+  /* D^-1 A, the operator a Jacobi step works with */
+  JacobiScaled
+};
+
+/* Estimated smallest and largest eigenvalue */
+struct SpectralBounds {
+  double min;
+  double max;
+};
+
+/* Parameters of the relaxation methods, derived from the bounds of the
+   spectrum of D^-1 A */
+struct RelaxationParameters {
+  /* Damping factor of the Jacobi step u += w D^-1 r */
+  double jacobiDamping;
+  /* Relaxation factor of SOR and SSOR */
+  double sorOmega;
+  /* Interval the Chebyshev iteration damps */
+  SpectralBounds chebyshev;
+};
+
+/* Fill scale with the scaling S of the Jacobi scaled operator, the square
+   roots of the magnitudes of the inverse diagonal with its sign */
+template<typename T, std::size_t n>
+void spectrumScaling(const Vector<T, n>& invDiag, Vector<T, n>& scale) {
+  for(std::size_t i = 0; i < n; ++i) {
+    scale(i) = std::copysign(std::sqrt(std::abs(invDiag(i))), invDiag(i));
+  }
+}
+
+/* Computes result = A * v, or S A |S| v for the Jacobi scaled operator with
+   the given scaling S (see spectrumScaling), using tmp. As D^-1 = S |S|,
+   S A |S| = |S|^-1 D^-1 A |S| is similar to D^-1 A, and it is symmetric
+   where A is and the diagonal has one sign, unlike D^-1 A itself unless
+   the diagonal is constant */
+template<typename T, class MatrixImpl, std::size_t n>
+void spectrumProduct(const MatrixLike<T, MatrixImpl, n, n>& A, const Vector<T, n> *scale, const Vector<T, n>& v, Vector<T, n>& result, Vector<T, n>& tmp) {
+  if(scale == nullptr) {
+    A.apply(v, result);
+    return;
+  }
+
+  for(std::size_t i = 0; i < n; ++i) {
+    tmp(i) = std::abs((*scale)(i)) * v(i);
+  }
+
+  A.apply(tmp, result);
+
+  for(std::size_t i = 0; i < n; ++i) {
+    result(i) *= (*scale)(i);
+  }
+}
+
+/* Fill v with the normalized start vector of the estimates. Its elements are
+   random, so that it has components along all eigenvectors. For the Jacobi
+   scaled operator, it is the error a Jacobi step leaves of a random error,
+   which drops the rows a Jacobi step solves exactly, like Dirichlet
+   boundary rows. Their eigenvalue is one, and the coupling of the other
+   rows to them is all that keeps the scaled operator from being symmetric.
+   The error is taken with D^-1 A, where these rows are exact, and carried
+   over to the scaled operator by |S|^-1. Returns false if v vanishes */
+template<typename T, class MatrixImpl, std::size_t n>
+bool spectrumStart(const MatrixLike<T, MatrixImpl, n, n>& A, const Vector<T, n> *invDiag, const Vector<T, n> *scale, Vector<T, n>& v, Vector<T, n>& tmp) {
+  std::minstd_rand random(42);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  v.generate([&] (std::size_t) { return uniform(random); });
+
+  if(invDiag != nullptr) {
+    A.apply(v, tmp);
+
+    for(std::size_t i = 0; i < n; ++i) {
+      v(i) = (v(i) - (*invDiag)(i) * tmp(i)) / std::abs((*scale)(i));
+    }
+  }
+
+  const double norm = v.l2Norm();
+
+  if(!(norm > 0.0)) {
+    return false;
+  }
+
+  for(std::size_t i = 0; i < n; ++i) {
+    v(i) /= norm;
+  }
+
+  return true;
+}
+
+/* Returns the number of eigenvalues below x of the symmetric tridiagonal
+   matrix with the given diagonal and off-diagonal entries (Sturm sequence) */
+inline std::size_t eigenvaluesBelow(const std::vector<double>& alpha, const std::vector<double>& beta, double x) {
+  std::size_t count = 0;
+  double d = 1.0;
+
+  for(std::size_t k = 0; k < alpha.size(); ++k) {
+    const double offDiagonal = (k > 0) ? beta[k - 1] * beta[k - 1] : 0.0;
+    d = alpha[k] - x - ((k > 0) ? offDiagonal / d : 0.0);
+
+    /* A zero pivot is moved aside instead of dividing by it */
+    if(d == 0.0) {
+      d = -1.e-300;
+    }
+
+    if(d < 0.0) {
+      ++count;
+    }
+  }
+
+  return count;
+}
+
+/* Returns the k-th smallest eigenvalue (counting from one) of the symmetric
+   tridiagonal matrix with the given entries, by bisection of the Gershgorin
+   interval */
+inline double tridiagonalEigenvalue(const std::vector<double>& alpha, const std::vector<double>& beta, std::size_t k) {
+  double lower = alpha[0], upper = alpha[0];
+
+  for(std::size_t i = 0; i < alpha.size(); ++i) {
+    const double radius = ((i > 0) ? std::abs(beta[i - 1]) : 0.0) + ((i + 1 < alpha.size()) ? std::abs(beta[i]) : 0.0);
+    lower = std::min(lower, alpha[i] - radius);
+    upper = std::max(upper, alpha[i] + radius);
+  }
+
+  /* Halve the interval until it can not get any smaller */
+  for(int step = 0; step < 200; ++step) {
+    const double middle = 0.5 * (lower + upper);
+
+    if(middle <= lower || middle >= upper) {
+      break;
+    }
+
+    if(eigenvaluesBelow(alpha, beta, middle) >= k) {
+      upper = middle;
+    } else {
+      lower = middle;
+    }
+  }
+
+  return 0.5 * (lower + upper);
+}
+
+/* Estimates the eigenvalue of largest magnitude of A or D^-1 A by power
+   iteration, as the Rayleigh quotient of the iterate. Stops when the
+   estimate changes by less than the given relative tolerance. Needs no
+   symmetry, but converges slowly when the two largest eigenvalues are close
+   together, as for the Poisson operators; the Rayleigh quotient then
+   approaches the largest eigenvalue from below. D^-1 A is iterated in its
+   symmetric scaling (see spectrumProduct). Uses four vectors of the
+   workspace */
+template<typename T, class MatrixImpl, std::size_t n>
+double powerIteration(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  Workspace<T, n>& workspace,
+  SpectrumOf of = SpectrumOf::JacobiScaled,
+  unsigned int iterations = POWER_ITERATIONS,
+  double tolerance = 1.e-6) {
+
+  const Vector<T, n> *invDiag = (of == SpectrumOf::JacobiScaled) ? &workspace.inverseDiagonal(A) : nullptr;
+  const Vector<T, n> *scale = (invDiag != nullptr) ? &workspace.vector(3) : nullptr;
+  Vector<T, n>& v = workspace.vector(0);
+  Vector<T, n>& w = workspace.vector(1);
+  Vector<T, n>& tmp = workspace.vector(2);
+
+  if(invDiag != nullptr) {
+    spectrumScaling(*invDiag, workspace.vector(3));
+  }
+
+  if(!spectrumStart(A, invDiag, scale, v, tmp)) {
+    return 1.0;
+  }
+
+  double estimate = 0.0;
+
+  for(unsigned int k = 0; k < iterations; ++k) {
+    spectrumProduct(A, scale, v, w, tmp);
+
+    /* v is normalized, so the Rayleigh quotient is v * w */
+    double quotient = 0.0;
+
+    for(std::size_t i = 0; i < n; ++i) {
+      quotient += v(i) * w(i);
+    }
+
+    const double norm = w.l2Norm();
+
+    if(!(norm > 0.0)) {
+      return 0.0;
+    }
+
+    for(std::size_t i = 0; i < n; ++i) {
+      v(i) = w(i) / norm;
+    }
+
+    const bool done = std::abs(quotient - estimate) <= tolerance * std::abs(quotient);
+    estimate = quotient;
+
+    if(done) {
+      break;
+    }
+  }
+
+  return estimate;
+}
+
+/* Estimates the smallest and largest eigenvalue of A or D^-1 A with the
+   given number of Lanczos steps (at most n), as the extreme eigenvalues of
+   the tridiagonal matrix the steps build. Both converge much faster than
+   the power iteration, and from inside the spectrum. A has to be symmetric.
+   For D^-1 A, the steps work on its symmetric scaling (see spectrumProduct).
+   Rows that only hold their diagonal entry are exempt (see spectrumStart),
+   and the diagonal of the other rows has to have one sign. Uses five
+   vectors of the workspace */
+template<typename T, class MatrixImpl, std::size_t n>
+SpectralBounds lanczos(
+  const MatrixLike<T, MatrixImpl, n, n>& A,
+  Workspace<T, n>& workspace,
+  SpectrumOf of = SpectrumOf::JacobiScaled,
+  unsigned int steps = LANCZOS_STEPS) {
+
+  const Vector<T, n> *invDiag = (of == SpectrumOf::JacobiScaled) ? &workspace.inverseDiagonal(A) : nullptr;
+  const Vector<T, n> *scale = (invDiag != nullptr) ? &workspace.vector(4) : nullptr;
+  Vector<T, n>& v = workspace.vector(0);
+  Vector<T, n>& w = workspace.vector(1);
+  Vector<T, n>& tmp = workspace.vector(2);
+  Vector<T, n>& previous = workspace.vector(3);
+
+  if(invDiag != nullptr) {
+    spectrumScaling(*invDiag, workspace.vector(4));
+  }
+
+  if(!spectrumStart(A, invDiag, scale, v, tmp)) {
+    return { 1.0, 1.0 };
+  }
+
+  /* Diagonal and off-diagonal entries of the tridiagonal matrix */
+  std::vector<double> alpha, beta;
+  previous = Vector<T, n>(0.0);
+
+  for(unsigned int k = 0; k < steps && k < n; ++k) {
+    spectrumProduct(A, scale, v, w, tmp);
+    const double lastBeta = beta.empty() ? 0.0 : beta.back();
+    double a = 0.0;
+
+    for(std::size_t i = 0; i < n; ++i) {
+      w(i) -= lastBeta * previous(i);
+      a += w(i) * v(i);
+    }
+
+    for(std::size_t i = 0; i < n; ++i) {
+      w(i) -= a * v(i);
+    }
+
+    alpha.push_back(a);
+    const double b = w.l2Norm();
+
+    /* The Krylov space is invariant, its eigenvalues are exact */
+    if(!(b > 1.e-12 * std::abs(a))) {
+      break;
+    }
+
+    beta.push_back(b);
+    previous = v;
+
+    for(std::size_t i = 0; i < n; ++i) {
+      v(i) = w(i) / b;
+    }
+  }
+
+  return { tridiagonalEigenvalue(alpha, beta, 1), tridiagonalEigenvalue(alpha, beta, alpha.size()) };
+}
+
+/* Returns the relaxation parameters for the bounds of the spectrum of
+   D^-1 A, assuming they have the same sign:
+   - the damping factor 2 / (min + max), which minimizes the spectral radius
+     of the damped Jacobi step,
+   - the SOR factor 2 / (1 + sqrt(1 - rho^2)) for the spectral radius rho of
+     the Jacobi step, optimal for consistently ordered operators like the
+     stencils,
+   - the bounds as the Chebyshev interval, widened at the top */
+inline RelaxationParameters relaxationParameters(const SpectralBounds& bounds, double safety = CHEBYSHEV_SAFETY) {
+  RelaxationParameters parameters;
+  const double rho = std::max(std::abs(1.0 - bounds.min), std::abs(1.0 - bounds.max));
+
+  parameters.jacobiDamping = 2.0 / (bounds.min + bounds.max);
+  parameters.sorOmega = (rho < 1.0) ? 2.0 / (1.0 + std::sqrt(1.0 - rho * rho)) : 1.0;
+  parameters.chebyshev = { bounds.min, bounds.max + safety * (bounds.max - bounds.min) };
+  return parameters;
+}
+
+/* Returns the relaxation parameters for A, estimating the spectrum of D^-1 A
+   with Lanczos steps */
+template<typename T, class MatrixImpl, std::size_t n>
+RelaxationParameters tuneRelaxation(const MatrixLike<T, MatrixImpl, n, n>& A, Workspace<T, n>& workspace, unsigned int steps = LANCZOS_STEPS) {
+  return relaxationParameters(lanczos(A, workspace, SpectrumOf::JacobiScaled, steps));
+}
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "Workspace.h"
+#include "CG.h"
+#include "Spectrum.h"
+#include "TestProblems.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+bool relativelyClose(double a, double b, double epsilon) {
+	return std::abs(a - b) <= epsilon * std::abs(b);
+}
+
+// D^-1 A of the Poisson stencil has the eigenvalues 1 -+ cos(k pi / (N - 1)) on
+// the inner points, so the optimal parameters are known
+template<size_t numPoints>
+void checkPoisson() {
+	const auto A = poissonStencil<numPoints>();
+	Workspace<double, numPoints> workspace;
+	const double c = cos(PI / (numPoints - 1));
+	const double exactMin = 1. - c, exactMax = 1. + c;
+
+	const SpectralBounds bounds = lanczos(A, workspace);
+	const double power = powerIteration(A, workspace);
+	std::cout << "\t" << numPoints << " grid points: Lanczos [" << bounds.min << ", " << bounds.max << "], power iteration "
+	          << power << ", exact [" << exactMin << ", " << exactMax << "]" << std::endl;
+	assert("estimates from inside the spectrum" && bounds.min >= exactMin * (1. - 1.e-9) && bounds.max <= exactMax * (1. + 1.e-12));
+	assert("smallest eigenvalue" && relativelyClose(bounds.min, exactMin, 0.1));
+	assert("largest eigenvalue" && relativelyClose(bounds.max, exactMax, 1.e-4));
+	assert("power iteration from below" && power <= exactMax * (1. + 1.e-12) && relativelyClose(power, exactMax, 1.e-2));
+
+	const RelaxationParameters parameters = relaxationParameters(bounds);
+	const double optimalOmega = 2. / (1. + sin(PI / (numPoints - 1)));
+	std::cout << "\t\tdamping " << parameters.jacobiDamping << ", SOR omega " << parameters.sorOmega << " (optimal "
+	          << optimalOmega << "), Chebyshev [" << parameters.chebyshev.min << ", " << parameters.chebyshev.max << "]" << std::endl;
+	assert("no damping for the Poisson operator" && relativelyClose(parameters.jacobiDamping, 1., 1.e-3));
+	assert("optimal SOR factor" && relativelyClose(parameters.sorOmega, optimalOmega, 1.e-2));
+	assert("Chebyshev interval covers the spectrum" && parameters.chebyshev.max > exactMax && parameters.chebyshev.min == bounds.min);
+
+	// the tuned factor makes a good SSOR preconditioner, unlike the Gauss-Seidel one
+	const auto b = rhs<numPoints>();
+	Vector<double, numPoints> u(0.0);
+	const unsigned int gaussSeidelIts = pcg(A, b, u, workspace, SSORPreconditioner<double, numPoints>(A, 1.));
+	u = Vector<double, numPoints>(0.0);
+	const RelaxationParameters tuned = tuneRelaxation(A, workspace);
+	const unsigned int tunedIts = pcg(A, b, u, workspace, SSORPreconditioner<double, numPoints>(A, tuned.sorOmega));
+	std::cout << "\t\tPCG (SSOR) iterations: omega 1 " << gaussSeidelIts << ", tuned " << tunedIts << std::endl;
+	assert("tuned SSOR takes fewer iterations" && tunedIts < gaussSeidelIts);
+}
+
+void test_poisson() {
+	TESTCASE("test_poisson");
+	checkPoisson<33>();
+	checkPoisson<65>();
+	checkPoisson<193>();
+}
+
+// the spectrum of A itself, for a dense matrix with eigenvalues 4 - 2 cos(k pi / (N + 1))
+void test_dense() {
+	TESTCASE("test_dense");
+	constexpr size_t n = 100;
+	std::unique_ptr<Matrix<double, n, n>> A(new Matrix<double, n, n>([] (size_t i, size_t j) {
+		return (i == j) ? 4. : (i == j + 1 || j == i + 1) ? -1. : 0.;
+	}));
+	Workspace<double, n> workspace;
+	const double exactMin = 4. - 2. * cos(PI / (n + 1)), exactMax = 4. + 2. * cos(PI / (n + 1));
+
+	const SpectralBounds bounds = lanczos(*A, workspace, SpectrumOf::Operator);
+	assert("smallest eigenvalue" && relativelyClose(bounds.min, exactMin, 1.e-3));
+	assert("largest eigenvalue" && relativelyClose(bounds.max, exactMax, 1.e-3));
+
+	// as many steps as rows give the exact eigenvalues
+	const SpectralBounds exact = lanczos(*A, workspace, SpectrumOf::Operator, n);
+	assert("exact smallest eigenvalue" && relativelyClose(exact.min, exactMin, 1.e-8));
+	assert("exact largest eigenvalue" && relativelyClose(exact.max, exactMax, 1.e-8));
+	assert("power iteration" && relativelyClose(powerIteration(*A, workspace, SpectrumOf::Operator, 20000, 1.e-10), exactMax, 1.e-3));
+
+	// D^-1 A is A / 4
+	const SpectralBounds scaled = lanczos(*A, workspace, SpectrumOf::JacobiScaled, n);
+	assert("scaled smallest eigenvalue" && relativelyClose(scaled.min, exactMin / 4., 1.e-8));
+	assert("scaled largest eigenvalue" && relativelyClose(scaled.max, exactMax / 4., 1.e-8));
+}
+
+// D^-1 A of an operator with a varying diagonal is not symmetric, its spectrum
+// is that of the symmetric D^-1/2 A D^-1/2
+void test_varying_diagonal() {
+	TESTCASE("test_varying_diagonal");
+	constexpr size_t n = 40;
+	auto diagonal = [] (size_t i) { return 4. + 300. * i / (n - 1); };
+	std::unique_ptr<Matrix<double, n, n>> A(new Matrix<double, n, n>([&] (size_t i, size_t j) {
+		return (i == j) ? diagonal(i) : (i == j + 1 || j == i + 1) ? -1. : 0.;
+	}));
+	std::unique_ptr<Matrix<double, n, n>> symmetric(new Matrix<double, n, n>([&] (size_t i, size_t j) {
+		return (*A)(i, j) / std::sqrt(diagonal(i) * diagonal(j));
+	}));
+	Workspace<double, n> workspace;
+	const SpectralBounds exact = lanczos(*symmetric, workspace, SpectrumOf::Operator, n);
+	const SpectralBounds bounds = lanczos(*A, workspace, SpectrumOf::JacobiScaled, n);
+	const double power = powerIteration(*A, workspace, SpectrumOf::JacobiScaled, 20000, 1.e-12);
+	std::cout << "\tLanczos [" << bounds.min << ", " << bounds.max << "], power iteration " << power
+	          << ", exact [" << exact.min << ", " << exact.max << "]" << std::endl;
+	assert("inside the Gershgorin discs" && exact.min > 0.5 && exact.max < 1.5);
+	assert("smallest eigenvalue" && relativelyClose(bounds.min, exact.min, 1.e-10));
+	assert("largest eigenvalue" && relativelyClose(bounds.max, exact.max, 1.e-10));
+	assert("power iteration" && relativelyClose(power, exact.max, 1.e-6));
+	assert("few steps suffice" && relativelyClose(lanczos(*A, workspace).max, exact.max, 1.e-6));
+}
+
+// a diagonal operator is solved by one Jacobi step, which leaves nothing to estimate
+void test_diagonal() {
+	TESTCASE("test_diagonal");
+	constexpr size_t n = 20;
+	Matrix<double, n, n> A([] (size_t i, size_t j) { return (i == j) ? 1. + i : 0.; });
+	Workspace<double, n> workspace;
+	const SpectralBounds bounds = lanczos(A, workspace);
+	assert("eigenvalue one" && bounds.min == 1. && bounds.max == 1.);
+	const RelaxationParameters parameters = relaxationParameters(bounds);
+	assert("undamped Jacobi" && parameters.jacobiDamping == 1. && parameters.sorOmega == 1.);
+}
+
+int main() {
+	test_poisson();
+	test_dense();
+	test_varying_diagonal();
+	test_diagonal();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "MatrixLike.h"
+#include "Kernels.h"
 
 template<typename T>
 using StencilEntry = std::pair<int, T>; // convenience type for stencil entries
@@ -28,11 +29,13 @@ public:
   Stencil& operator=(const Stencil & o) {
     boundaryStencil_ = o.boundaryStencil_;
     innerStencil_ = o.innerStencil_;
+    return *this;
   }
 
   Stencil& operator=(Stencil && o) {
     boundaryStencil_ = o.boundaryStencil_;
     innerStencil_ = o.innerStencil_;
+    return *this;
   }
 
 	// HINT: stencil entries are stored as offset/coefficient pair, that is the offset specifies which element of a
@@ -41,6 +44,14 @@ public:
   Vector<T, nrows> operator* (const Vector<T, nrows> & o) const {
     /* Result vector */
     Vector<T, nrows> result(0.0);
+    apply(o, result);
+    return result;
+  }
+
+  /* Stencil application written into an existing vector */
+  void apply(const Vector<T, nrows> & o, Vector<T, nrows> & result) const {
+    result(0) = 0.0;
+    result(nrows - 1) = 0.0;
 
     /* Go through each pair of the boundary entries */
     for(auto elem : boundaryStencil_) {
@@ -50,38 +61,47 @@ public:
       result(nrows - 1) += o(nrows - 1 + elem.first) * elem.second;
     }
 
-    /* Go through each element of the vector */
-    for(std::size_t i = 1; i < nrows - 1; ++i) {
-      /* Go through each pair of the inner entries */
-      for(auto elem : innerStencil_) {
-        /* Apply the stencil for current vector element */
-        result(i) += o(i + elem.first) * elem.second;
-      }
-    }
-
-    return result;
+    /* Apply the inner entries to the remaining elements, with the kernel for
+       the selected instruction set */
+    stencilKernel(o.values().data(), &result(0), 1, nrows - 1, innerStencil_.data(), innerStencil_.size());
   }
 
   Stencil<T, nrows, ncols> inverseDiagonal( ) const {
-    /* Find boundary pair where the first element (offset) is zero */
-    auto boundary_it = std::find_if(boundaryStencil_.begin(), boundaryStencil_.end(),
-      [] (StencilEntry<T> const &elem) {
-        return elem.first == 0;
-      }
-    );
+    /* Return stencil with inverse values of the zero offsets (diagonal) */
+    return Stencil({{0, 1.0 / diagonal(boundaryStencil_)}}, {{0, 1.0 / diagonal(innerStencil_)}});
+  };
+
+  /* Inverse diagonal entries written into an existing vector */
+  void inverseDiagonalEntries(Vector<T, nrows> & result) const {
+    const T boundary = 1.0 / diagonal(boundaryStencil_), inner = 1.0 / diagonal(innerStencil_);
+    result.fill(inner);
+    result(0) = boundary;
+    result(nrows - 1) = boundary;
+  }
+
+  /* Return the entries applied to the first and last element */
+  const std::vector<StencilEntry<T> >& boundaryEntries( ) const {
+    return boundaryStencil_;
+  }
+
+  /* Return the entries applied to the inner elements */
+  const std::vector<StencilEntry<T> >& innerEntries( ) const {
+    return innerStencil_;
+  }
 
-    /* Find inner pair where the first element (offset) is zero */
-    auto inner_it = std::find_if(innerStencil_.begin(), innerStencil_.end(),
+protected:
+  /* Return the coefficient of the zero offset (diagonal) of the given
+     entries, zero if there is none */
+  static T diagonal(const std::vector<StencilEntry<T> >& entries) {
+    auto it = std::find_if(entries.begin(), entries.end(),
       [] (StencilEntry<T> const &elem) {
         return elem.first == 0;
       }
     );
 
-    /* Return stencil with inverse values of the zero offsets (diagonal) */
-    return Stencil({{0, 1.0 / boundary_it->second}}, {{0, 1.0 / inner_it->second}});
-  };
+    return (it != entries.end()) ? it->second : T(0.0);
+  }
 
-protected:
 	// containers for the stencil entries -> boundary stencils represent the first and last rows of a corresponding
 	// matrix and are to be applied to the first and last element of a target vector; inner stencils correspond to
 	// the remaining rows of the matrix
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <limits>
+
+/* Number of iterations meaning "until converged" for Steppable::step */
+constexpr unsigned int STEP_ALL = std::numeric_limits<unsigned int>::max();
+
+/* Default limit on the iterations of the blocking solvers */
+constexpr unsigned int SOLVE_MAX_ITERATIONS = 1000000;
+
+/* Returned by the blocking solvers instead of the number of iterations when
+   the solve did not converge within the limit */
+constexpr unsigned int SOLVE_FAILED = std::numeric_limits<unsigned int>::max();
+
+/* Interface of the resumable solvers. Instead of iterating until convergence
+   in one call, a solver object keeps its state between calls and advances a
+   given number of iterations per call, so a scheduler can interleave many
+   solves on a few threads. The blocking solvers run their stepper up to
+   their iteration limit (see solveSteps), so both give the same iterations */
+class Steppable {
+public:
+  virtual ~Steppable() {}
+
+  /* Advance by at most count iterations, returns true once converged */
+  virtual bool step(unsigned int count) = 0;
+
+  /* Check if the solve has converged */
+  virtual bool converged() const = 0;
+
+  /* Return the number of iterations done so far */
+  virtual unsigned int iterations() const = 0;
+
+  /* Check if the solve broke down, e.g. the residual is no longer finite.
+     Further steps do not change a failed solve */
+  virtual bool failed() const {
+    return false;
+  }
+};
+
+/* Run a new stepper for at most maxIterations, returns the number of
+   iterations required or SOLVE_FAILED if it did not converge */
+inline unsigned int solveSteps(Steppable& stepper, unsigned int maxIterations) {
+  return stepper.step(maxIterations) ? stepper.iterations() : SOLVE_FAILED;
+}
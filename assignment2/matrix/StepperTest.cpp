@@ -0,0 +1,205 @@
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Vector.h"
+#include "Stencil.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "CG.h"
+#include "Scheduler.h"
+#include "TestProblems.h"
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// stepping in slices of any size gives the iterations and the solution of the blocking solvers
+template<size_t numPoints>
+void checkSlices(unsigned int jacobiIts) {
+	const auto A = poissonStencil<numPoints>();
+	const auto b = rhs<numPoints>();
+	Workspace<double, numPoints> workspace;
+
+	Vector<double, numPoints> jacobiU(0.0), cgU(0.0);
+	assert("blocking Jacobi iterations" && jacobi(A, b, jacobiU, workspace) == jacobiIts);
+	const unsigned int cgIts = pcg(A, b, cgU, workspace);
+
+	for (unsigned int slice : { 1u, 7u, 1000u, STEP_ALL }) {
+		Vector<double, numPoints> u(0.0);
+		JacobiStepper jacobiStepper(A, b, u, workspace);
+		assert("nothing done before the first step" && !jacobiStepper.converged() && jacobiStepper.iterations() == 0);
+		unsigned int steps = 0;
+		while (!jacobiStepper.step(slice)) {
+			++steps;
+			assert("a slice is done per step" && jacobiStepper.iterations() == steps * slice);
+		}
+		assert("same Jacobi iterations" && jacobiStepper.iterations() == jacobiIts);
+		assert("same Jacobi solution" && u == jacobiU);
+		assert("converged stepper stays" && jacobiStepper.step(slice) && jacobiStepper.iterations() == jacobiIts);
+
+		u = Vector<double, numPoints>(0.0);
+		CGStepper cgStepper(A, b, u, workspace);
+		while (!cgStepper.step(slice)) {}
+		assert("same CG iterations" && cgStepper.iterations() == cgIts);
+		assert("same CG solution" && u == cgU);
+	}
+}
+
+void test_slices() {
+	TESTCASE("test_slices");
+	checkSlices<33>(743);
+	checkSlices<65>(2982);
+}
+
+// one problem of a given size, with its own workspace and stepper
+class Solve {
+public:
+	virtual ~Solve() {}
+	virtual Steppable& stepper() = 0;
+	virtual unsigned int expected() const = 0;
+};
+
+template<size_t numPoints>
+class PoissonSolve : public Solve {
+public:
+	PoissonSolve(bool cg) :
+			A(poissonStencil<numPoints>()), b(rhs<numPoints>()), u(0.0) {
+		// iterations of the blocking solver
+		Vector<double, numPoints> blockingU(0.0);
+		expected_ = cg ? pcg(A, b, blockingU, workspace) : jacobi(A, b, blockingU, workspace);
+		if (cg) {
+			stepper_.reset(new CGStepper<double, Stencil<double, numPoints, numPoints>, numPoints>(A, b, u, workspace));
+		} else {
+			stepper_.reset(new JacobiStepper<double, Stencil<double, numPoints, numPoints>, numPoints>(A, b, u, workspace));
+		}
+	}
+	Steppable& stepper() override {
+		return *stepper_;
+	}
+	unsigned int expected() const override {
+		return expected_;
+	}
+private:
+	Stencil<double, numPoints, numPoints> A;
+	Vector<double, numPoints> b, u;
+	Workspace<double, numPoints> workspace;
+	std::unique_ptr<Steppable> stepper_;
+	unsigned int expected_;
+};
+
+// many solves of different sizes and lengths, on one and on several threads
+void test_scheduler() {
+	TESTCASE("test_scheduler");
+	for (unsigned int threads : { 1u, 2u, 4u }) {
+		std::vector<std::unique_ptr<Solve>> solves;
+		// a long solve first, then many short ones behind it
+		solves.emplace_back(new PoissonSolve<129>(false));
+		for (int k = 0; k < 12; ++k) {
+			solves.emplace_back(new PoissonSolve<33>(k % 2 == 1));
+			solves.emplace_back(new PoissonSolve<49>(false));
+			solves.emplace_back(new PoissonSolve<65>(true));
+		}
+
+		std::vector<int> finishedAt(solves.size(), -1);
+		std::atomic<int> finishedCount(0);
+		{
+			SolveScheduler scheduler(threads);
+			assert("requested threads" && scheduler.threads() == threads);
+			for (size_t s = 0; s < solves.size(); ++s) {
+				scheduler.submit(solves[s]->stepper(), [&finishedAt, &finishedCount, s] { finishedAt[s] = finishedCount++; });
+			}
+			scheduler.wait();
+			assert("all solves finished" && finishedCount == (int)solves.size());
+		}
+
+		for (auto& solve : solves) {
+			assert("converged" && solve->stepper().converged());
+			assert("same iterations as the blocking solvers" && solve->stepper().iterations() == solve->expected());
+		}
+		// the long solve takes turns with the short ones instead of blocking them, on
+		// several threads the order also depends on how the threads are scheduled
+		assert("long solve finished last" && (threads > 1 || finishedAt[0] == (int)solves.size() - 1));
+		std::cout << "\t" << threads << " threads: " << solves.size() << " solves" << std::endl;
+	}
+
+	// the scheduler can be reused, and its destructor finishes pending solves
+	PoissonSolve<33> first(false), second(true);
+	{
+		SolveScheduler scheduler(2, 5);
+		scheduler.submit(first.stepper());
+		scheduler.wait();
+		assert("first solve finished" && first.stepper().iterations() == first.expected());
+		scheduler.submit(second.stepper());
+	}
+	assert("second solve finished" && second.stepper().converged() && second.stepper().iterations() == second.expected());
+}
+
+// a solve that never converges
+class Endless : public Steppable {
+public:
+	bool step(unsigned int count) override {
+		its += std::min(count, 10u);
+		return false;
+	}
+	bool converged() const override {
+		return false;
+	}
+	unsigned int iterations() const override {
+		return its;
+	}
+private:
+	std::atomic<unsigned int> its{0};
+};
+
+// solves that do not converge end with their budget, or when cancelled
+void test_endless() {
+	TESTCASE("test_endless");
+	Endless limited, cancelled, pending;
+	std::atomic<int> finishedCount(0);
+	unsigned int its = 0;
+	{
+		SolveScheduler scheduler(2, 7);
+		scheduler.submit(limited, [&finishedCount] { ++finishedCount; }, 1000);
+		scheduler.submit(cancelled, [&finishedCount] { ++finishedCount; }, STEP_ALL);
+		while (cancelled.iterations() == 0) {
+			std::this_thread::yield();
+		}
+		scheduler.cancel();
+		scheduler.wait();
+		assert("both solves ended" && finishedCount == 2);
+		assert("budget used up" && limited.iterations() == 1000);
+		its = cancelled.iterations();
+		scheduler.submit(pending, nullptr, 500);
+		scheduler.wait();
+		assert("cancelled solve not resumed" && cancelled.iterations() == its);
+		assert("solves submitted after cancel run" && pending.iterations() == 500);
+		// the destructor ends at the budget
+		scheduler.submit(cancelled, nullptr, 100);
+	}
+	assert("resubmitted solve ended at the budget" && cancelled.iterations() == its + 100);
+}
+
+int main() {
+	test_slices();
+	test_scheduler();
+	test_endless();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/* Compile-time switch for the solver telemetry, build with
+   -DSOLVER_TELEMETRY=0 to remove the recording from the solvers. The
+   SolverTelemetry class stays available, but records nothing */
+#ifndef SOLVER_TELEMETRY
+#define SOLVER_TELEMETRY 1
+#endif
+
+/* Make the given call on a SolverTelemetry pointer unless it is null, used by
+   the solvers so that disabling the telemetry removes the checks as well */
+#if SOLVER_TELEMETRY
+#define TELEMETRY(telemetry, call) do { if((telemetry) != nullptr) { (telemetry)->call; } } while(0)
+#else
+#define TELEMETRY(telemetry, call) do {} while(0)
+#endif
+
+/* Default number of records kept per solve, a power of two */
+constexpr std::size_t TELEMETRY_CAPACITY = 1 << 12;
+
+/* Kinds of telemetry records */
+enum class TelemetryEvent : std::uint8_t {
+  /* Start and end of a solver phase */
+  Begin, End,
+  /* Residual after an iteration */
+  Residual
+};
+
+/* One telemetry record */
+struct TelemetryRecord {
+  /* Nanoseconds since the telemetry was created */
+  std::int64_t time;
+  /* Phase name for Begin and End (a string literal), nullptr otherwise */
+  const char *phase;
+  /* Iterations done and residual norm at the time of the record */
+  unsigned int iteration;
+  double residual;
+  TelemetryEvent event;
+};
+
+/* Write the value as a JSON number, or as null if it is not finite: JSON
+   has no NaN or infinity, and the residuals of failed solves are exactly
+   the ones worth looking at */
+inline void writeJSONNumber(std::ostream& out, double value) {
+  if(std::isfinite(value)) {
+    out << value;
+  } else {
+    out << "null";
+  }
+}
+
+/* Residual history and phase timestamps of a solve, kept in a ring buffer of
+   the given number of records, so that the oldest records are overwritten
+   instead of the solver allocating or writing output. Recording is meant
+   for the solver thread only and is wait-free: it claims the slot, stores
+   the fields and publishes the record by advancing the head, like the
+   writer of a sequence lock. Other threads can take a snapshot at any time,
+   records overwritten while copying are dropped from it. Exports go to Chrome trace JSON (chrome://tracing, Perfetto) and CSV */
+class SolverTelemetry {
+private:
+#if SOLVER_TELEMETRY
+  /* Fields of a record, atomic so that snapshots taken by other threads do
+     not race with the recording. Relaxed stores cost as much as plain ones */
+  struct Slot {
+    std::atomic<std::int64_t> time;
+    std::atomic<const char *> phase;
+    std::atomic<unsigned int> iteration;
+    std::atomic<double> residual;
+    std::atomic<TelemetryEvent> event;
+  };
+
+  /* Only every stride-th residual is recorded */
+  unsigned int stride;
+  /* Ring buffer, its size minus one, and the number of records started and
+     published so far */
+  std::vector<Slot> slots;
+  std::size_t mask;
+  std::atomic<std::uint64_t> claimed{0}, head{0};
+  /* Time the records count from */
+  std::chrono::steady_clock::time_point start;
+
+  /* Append a record, overwriting the oldest one if the buffer is full */
+  void record(TelemetryEvent event, const char *phase, unsigned int iteration, double residual) {
+    const std::uint64_t index = head.load(std::memory_order_relaxed);
+    Slot& slot = slots[index & mask];
+    const std::int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    /* A snapshot that reads any of the fields below also sees the claim, and
+       with it that the slot was overwritten */
+    claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.time.store(time, std::memory_order_relaxed);
+    slot.phase.store(phase, std::memory_order_relaxed);
+    slot.iteration.store(iteration, std::memory_order_relaxed);
+    slot.residual.store(residual, std::memory_order_relaxed);
+    slot.event.store(event, std::memory_order_relaxed);
+    head.store(index + 1, std::memory_order_release);
+  }
+#endif
+public:
+  /* SolverTelemetry constructor, the capacity is rounded up to a power of two.
+     Recording every residual costs a clock read per iteration, which shows
+     for small grids, a stride above one only records every stride-th one */
+  explicit SolverTelemetry(std::size_t capacity = TELEMETRY_CAPACITY, unsigned int stride = 1) {
+#if SOLVER_TELEMETRY
+    this->stride = std::max(1u, stride);
+    std::size_t size = 1;
+
+    while(size < capacity) {
+      size *= 2;
+    }
+
+    slots = std::vector<Slot>(size);
+    mask = size - 1;
+    start = std::chrono::steady_clock::now();
+#else
+    (void)capacity; (void)stride;
+#endif
+  }
+
+  /* The records are referenced by the solver, so they can not be copied */
+  SolverTelemetry(const SolverTelemetry&) = delete;
+  SolverTelemetry& operator=(const SolverTelemetry&) = delete;
+
+  /* Record the start of a phase, the name has to be a string literal */
+  void begin(const char *phase, unsigned int iteration = 0) {
+#if SOLVER_TELEMETRY
+    record(TelemetryEvent::Begin, phase, iteration, 0.0);
+#else
+    (void)phase; (void)iteration;
+#endif
+  }
+
+  /* Record the end of a phase */
+  void end(const char *phase, unsigned int iteration = 0, double residual = 0.0) {
+#if SOLVER_TELEMETRY
+    record(TelemetryEvent::End, phase, iteration, residual);
+#else
+    (void)phase; (void)iteration; (void)residual;
+#endif
+  }
+
+  /* Record the residual norm after the given iteration */
+  void residual(unsigned int iteration, double residual) {
+#if SOLVER_TELEMETRY
+    if(iteration % stride == 0) {
+      record(TelemetryEvent::Residual, nullptr, iteration, residual);
+    }
+#else
+    (void)iteration; (void)residual;
+#endif
+  }
+
+  /* Return the number of records made so far, including overwritten ones */
+  std::uint64_t recorded() const {
+#if SOLVER_TELEMETRY
+    return head.load(std::memory_order_acquire);
+#else
+    return 0;
+#endif
+  }
+
+  /* Return the records still in the buffer, oldest first */
+  std::vector<TelemetryRecord> snapshot() const {
+    std::vector<TelemetryRecord> records;
+#if SOLVER_TELEMETRY
+    const std::uint64_t last = head.load(std::memory_order_acquire);
+    const std::uint64_t first = (last > slots.size()) ? last - slots.size() : 0;
+    records.reserve(last - first);
+
+    for(std::uint64_t index = first; index < last; ++index) {
+      const Slot& slot = slots[index & mask];
+      records.push_back({ slot.time.load(std::memory_order_relaxed), slot.phase.load(std::memory_order_relaxed),
+                          slot.iteration.load(std::memory_order_relaxed), slot.residual.load(std::memory_order_relaxed),
+                          slot.event.load(std::memory_order_relaxed) });
+    }
+
+    /* Records the solver wrote over while they were copied are dropped,
+       including the one it may be writing right now. The fence makes the
+       claims of all writes seen by the copies visible */
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const std::uint64_t now = claimed.load(std::memory_order_relaxed);
+
+    if(now > first + slots.size()) {
+      const std::uint64_t overwritten = std::min<std::uint64_t>(now - first - slots.size(), records.size());
+      records.erase(records.begin(), records.begin() + overwritten);
+    }
+#endif
+    return records;
+  }
+
+  /* Write the records as Chrome trace JSON: phases as duration events and
+     the residuals as a counter track, with the given process and thread id */
+  void writeChromeTrace(std::ostream& out, int pid = 1, int tid = 1) const {
+    const std::vector<TelemetryRecord> records = snapshot();
+    const std::streamsize precision = out.precision(17);
+
+    out << "{\"traceEvents\":[";
+
+    for(std::size_t k = 0; k < records.size(); ++k) {
+      const TelemetryRecord& r = records[k];
+      out << (k == 0 ? "\n" : ",\n");
+      out << "{\"ts\":" << r.time / 1000.0 << ",\"pid\":" << pid << ",\"tid\":" << tid << ",";
+
+      switch(r.event) {
+        case TelemetryEvent::Begin:
+          out << "\"name\":\"" << r.phase << "\",\"ph\":\"B\",\"args\":{\"iteration\":" << r.iteration << "}}";
+          break;
+        case TelemetryEvent::End:
+          out << "\"name\":\"" << r.phase << "\",\"ph\":\"E\",\"args\":{\"iteration\":" << r.iteration << ",\"residual\":";
+          writeJSONNumber(out, r.residual);
+          out << "}}";
+          break;
+        default:
+          out << "\"name\":\"residual\",\"ph\":\"C\",\"args\":{\"residual\":";
+          writeJSONNumber(out, r.residual);
+          out << "}}";
+      }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    out.precision(precision);
+  }
+
+  /* Write the records as CSV, one line per record */
+  void writeCSV(std::ostream& out) const {
+    const std::vector<TelemetryRecord> records = snapshot();
+    const std::streamsize precision = out.precision(17);
+
+    out << "time_ns,event,phase,iteration,residual\n";
+
+    for(const TelemetryRecord& r : records) {
+      const char *event = (r.event == TelemetryEvent::Begin) ? "begin" : (r.event == TelemetryEvent::End) ? "end" : "residual";
+      out << r.time << "," << event << "," << (r.phase != nullptr ? r.phase : "") << "," << r.iteration << "," << r.residual << "\n";
+    }
+
+    out.precision(precision);
+  }
+};
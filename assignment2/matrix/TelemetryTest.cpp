@@ -0,0 +1,183 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include "Vector.h"
+#include "Stencil.h"
+#include "Workspace.h"
+#include "Jacobi.h"
+#include "CG.h"
+#include "Telemetry.h"
+#include "TestProblems.h"
+
+// built twice, as TelemetryTest and as TelemetryDisabledTest with -DSOLVER_TELEMETRY=0
+
+using std::size_t;
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+size_t count(const std::string& text, const std::string& pattern) {
+	size_t found = 0;
+	for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+		++found;
+	}
+	return found;
+}
+
+// the recorded history of a whole solve, and its exports
+void test_history() {
+	TESTCASE("test_history");
+	constexpr size_t n = 33;
+	const auto A = poissonStencil<n>();
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+
+	Vector<double, n> plainU(0.0), u(0.0);
+	assert("plain Jacobi iterations" && jacobi(A, b, plainU, workspace) == 743);
+	SolverTelemetry telemetry;
+	assert("same iterations with telemetry" && jacobi(A, b, u, workspace, 1.e-5, &telemetry) == 743);
+	assert("same solution with telemetry" && u == plainU);
+
+	std::ostringstream trace, csv;
+	telemetry.writeChromeTrace(trace);
+	telemetry.writeCSV(csv);
+	assert("trace is an object of events" && trace.str().find("{\"traceEvents\":[") == 0);
+
+#if SOLVER_TELEMETRY
+	// setup begin and end, iterate begin, the residuals and iterate end
+	assert("all records made" && telemetry.recorded() == 747);
+	const auto records = telemetry.snapshot();
+	assert("all records kept" && records.size() == 747);
+	assert("setup first" && records[0].event == TelemetryEvent::Begin && std::strcmp(records[0].phase, "setup") == 0);
+	assert("initial residual" && records[1].event == TelemetryEvent::End && records[1].residual > 0.);
+	const double initRes = records[1].residual;
+	for (size_t k = 0; k < 743; ++k) {
+		const TelemetryRecord& r = records[3 + k];
+		assert("residual per iteration" && r.event == TelemetryEvent::Residual && r.iteration == k + 1);
+		assert("time does not go back" && r.time >= records[2 + k].time);
+	}
+	assert("iterate last" && records[746].event == TelemetryEvent::End && records[746].iteration == 743);
+	assert("converged" && records[746].residual <= 1.e-5 * initRes && records[745].residual == records[746].residual);
+
+	assert("counter per iteration" && count(trace.str(), "\"ph\":\"C\"") == 743);
+	assert("two phases" && count(trace.str(), "\"ph\":\"B\"") == 2 && count(trace.str(), "\"ph\":\"E\"") == 2);
+	assert("header and one line per record" && count(csv.str(), "\n") == 748);
+	assert("CSV header" && csv.str().find("time_ns,event,phase,iteration,residual\n") == 0);
+
+	// every tenth residual only, the phases are always recorded
+	SolverTelemetry sampled(TELEMETRY_CAPACITY, 10);
+	u = Vector<double, n>(0.0);
+	jacobi(A, b, u, workspace, 1.e-5, &sampled);
+	assert("sampled residuals" && sampled.recorded() == 4 + 74);
+	assert("tenth iterations" && sampled.snapshot()[3].iteration == 10);
+#else
+	// all recording is compiled out
+	assert("nothing recorded" && telemetry.recorded() == 0 && telemetry.snapshot().empty());
+	assert("empty trace" && count(trace.str(), "\"ph\"") == 0);
+	assert("CSV header only" && csv.str() == "time_ns,event,phase,iteration,residual\n");
+#endif
+}
+
+// a small buffer keeps the latest records of a long solve
+void test_ring() {
+	TESTCASE("test_ring");
+	constexpr size_t n = 65;
+	const auto A = poissonStencil<n>();
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+	Vector<double, n> u(0.0);
+
+	SolverTelemetry telemetry(100); // rounded up to 128
+	const unsigned int its = pcg(A, b, u, workspace, 1.e-5, &telemetry);
+	u = Vector<double, n>(0.0);
+	assert("Jacobi iterations" && jacobi(A, b, u, workspace, 1.e-5, &telemetry) == 2982);
+
+#if SOLVER_TELEMETRY
+	assert("records of both solves" && telemetry.recorded() == (its + 4) + (2982 + 4));
+	const auto records = telemetry.snapshot();
+	// no record is being written, so the whole buffer is kept
+	assert("latest records only" && records.size() == 128);
+	assert("ends with the Jacobi solve" && records.back().event == TelemetryEvent::End && records.back().iteration == 2982);
+	for (size_t k = 0; k + 1 < records.size() - 1; ++k) {
+		assert("consecutive iterations" && records[k + 1].iteration == records[k].iteration + 1);
+	}
+#else
+	(void)its;
+	assert("nothing recorded" && telemetry.recorded() == 0);
+#endif
+}
+
+// snapshots taken while the solver records are consistent
+void test_concurrent_snapshots() {
+	TESTCASE("test_concurrent_snapshots");
+	constexpr size_t n = 129;
+	const auto A = poissonStencil<n>();
+	const auto b = rhs<n>();
+	Workspace<double, n> workspace;
+	Vector<double, n> u(0.0);
+
+	SolverTelemetry telemetry(256);
+	std::atomic<bool> done(false);
+	size_t snapshots = 0;
+	std::thread reader([&] () {
+		while (!done) {
+			const auto records = telemetry.snapshot();
+			for (size_t k = 1; k < records.size(); ++k) {
+				if (records[k].event == TelemetryEvent::Residual && records[k - 1].event == TelemetryEvent::Residual) {
+					assert("no torn or reordered records" && records[k].iteration == records[k - 1].iteration + 1);
+					assert("time does not go back" && records[k].time >= records[k - 1].time);
+				}
+			}
+			++snapshots;
+		}
+	});
+	const unsigned int its = jacobi(A, b, u, workspace, 1.e-5, &telemetry);
+	done = true;
+	reader.join();
+	assert("Jacobi iterations" && its == 11941);
+	std::cout << "\t" << snapshots << " snapshots during the solve" << std::endl;
+}
+
+// residuals that are not finite are written as null, JSON has no nan or inf
+void test_failed_trace() {
+	TESTCASE("test_failed_trace");
+	constexpr size_t n = 33;
+	const auto A = poissonStencil<n>();
+	Vector<double, n> b = rhs<n>();
+	b(n / 2) = std::nan("");
+	Workspace<double, n> workspace;
+	Vector<double, n> u(0.0);
+	SolverTelemetry telemetry;
+	assert("failed" && jacobi(A, b, u, workspace, 1.e-5, &telemetry) == SOLVE_FAILED);
+
+	std::ostringstream trace;
+	telemetry.writeChromeTrace(trace);
+	assert("no bare nan or inf" && count(trace.str(), "nan") == 0 && count(trace.str(), "inf") == 0);
+#if SOLVER_TELEMETRY
+	assert("written as null" && count(trace.str(), "\"residual\":null}") >= 1);
+#endif
+}
+
+int main() {
+	test_history();
+	test_ring();
+	test_concurrent_snapshots();
+	test_failed_trace();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include "Vector.h"
+#include "Stencil.h"
+#include "Jacobi.h"
+
+// test problems shared by the solver tests: the 1D Poisson problem of Solver.cpp
+
+#define PI 3.141592653589793
+
+// entry x of the right-hand side of the Poisson problem on numPoints grid points
+inline double rhs(std::size_t x, std::size_t numPoints) {
+	return sin(2. * PI * (1. + x / (double)(numPoints - 1))) + cos(PI * (x / (double)(numPoints - 1)));
+}
+
+template<std::size_t numPoints>
+Vector<double, numPoints> rhs() {
+	Vector<double, numPoints> b(0.0);
+	for (std::size_t x = 0; x < numPoints; ++x) {
+		b(x) = rhs(x, numPoints);
+	}
+	return b;
+}
+
+// -u'' with Dirichlet boundaries
+template<std::size_t numPoints>
+Stencil<double, numPoints, numPoints> poissonStencil() {
+	const double hxSq = 1. / ((numPoints - 1) * (numPoints - 1));
+	return Stencil<double, numPoints, numPoints>({ { 0, 1. } }, { { -1, 1. / hxSq },{ 0, -2. / hxSq },{ 1, 1. / hxSq } });
+}
+
+// checks that the true residual has been reduced by the given factor
+template<typename T, class MatrixImpl, std::size_t numPoints>
+void checkConverged(const MatrixLike<T, MatrixImpl, numPoints, numPoints>& A, const Vector<T, numPoints>& b, const Vector<T, numPoints>& u, double factor = 1.e-5) {
+	Vector<T, numPoints> r(0.0), zero(0.0);
+	assert("residual reduced" && residual(A, b, u, r) <= factor * residual(A, b, zero, r) * (1. + 1.e-12));
+}
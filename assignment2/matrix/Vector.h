@@ -1,10 +1,17 @@
+#include <array>
 #include <functional>
 #include <iostream>
 #include <math.h>
 #include <numeric>
+#include <type_traits>
+#include "Kernels.h"
+#include "Parallel.h"
 
 #pragma once
 
+/* Fills of fewer elements than this are not split among threads */
+constexpr std::size_t FILL_PARALLEL_MIN = 1 << 16;
+
 template<typename T, std::size_t size_>
 class Vector {
 private:
@@ -23,18 +30,18 @@ public:
     }
   }
 
-  /* Vector constructor */
-  Vector(std::function<T(std::size_t)> initFunc) {
-    /* Check for vector dimension */
-    static_assert(size_ >= 0, "Vector size must be higher or equal than zero");
-
-    /* Go through the data elements and fill all the positions with the
-       given initial value */
-    for(std::size_t i = 0; i < size_; ++i) {
-      data[i] = initFunc(i);
-    }
+  /* Vector constructor, setting element i to initFunc(i). The generator is
+     a template parameter, so it is inlined into the fill instead of being
+     called through a std::function, and the elements can be split among
+     the given number of threads */
+  template<class Generator, std::enable_if_t<std::is_invocable_r_v<T, Generator&, std::size_t>, int> = 0>
+  Vector(Generator initFunc, unsigned threads = 1) {
+    generate(initFunc, threads);
   }
 
+  /* Vector constructor, taking the elements */
+  explicit Vector(const std::array<T, size_>& values) : data(values) {}
+
   /* Vector destructor */
   ~Vector() {}
 
@@ -59,6 +66,27 @@ public:
     return *this;
   }
 
+  /* Set element i to f(i), on the given number of threads. f is called
+     concurrently for large vectors, so it must not modify shared state */
+  template<class Generator>
+  void generate(Generator f, unsigned threads = 1) {
+    parallelChunks(0, size_, 1, FILL_PARALLEL_MIN, threads, [this, &f] (std::size_t first, std::size_t last) {
+      for(std::size_t i = first; i < last; ++i) {
+        data[i] = f(i);
+      }
+    });
+  }
+
+  /* Set all elements to the given value */
+  void fill(T value, unsigned threads = 1) {
+    generate([value] (std::size_t) { return value; }, threads);
+  }
+
+  /* Set element i to start + i * step */
+  void iota(T start = 0.0, T step = 1.0, unsigned threads = 1) {
+    generate([start, step] (std::size_t i) { return start + static_cast<T>(i) * step; }, threads);
+  }
+
   /* Return reference from the specified index */
   T& operator()(std::size_t i) {
     return data[i];
@@ -73,7 +101,7 @@ public:
   bool operator ==(const Vector<T, size_>& v) const {
     /* Go through each element of the vector and in case one element differs
        from the other vector, returns false */
-    for(std::size_t i = 0; i < size; ++i) {
+    for(std::size_t i = 0; i < size_; ++i) {
       if(data[i] != v(i)) {
         return false;
       }
@@ -174,10 +202,12 @@ public:
   double l2Norm() const {
     /* The norm is calculated by performing the summation of the square of
        each element in the vector, and then the square root of the summation */
-    return sqrt(std::accumulate(
-      data.begin(), data.end(), 0.0,
-      [](T a, T b) { return a + (b * b); }
-    ));
+    return sqrt(dotKernel(data.data(), data.data(), size_));
+  }
+
+  /* Return the elements */
+  const std::array<T, size_>& values() const {
+    return data;
   }
 
   /* Return the number of rows */
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Vector.h"
+#include "MatrixLike.h"
+
+/* Scratch storage for the solvers. The vectors are created on first use and
+   kept for the lifetime of the workspace, so a solver that is handed the same
+   workspace on every call only allocates while setting it up; this includes
+   the storage of the inverse diagonal, which the solvers extract once per
+   solve instead of on every iteration */
+template<typename T, std::size_t size_>
+class Workspace {
+private:
+  /* Scratch vectors, kept on the heap so large grids do not live on the stack */
+  std::vector<std::unique_ptr<Vector<T, size_>>> vectors;
+  /* Inverse diagonal of the last operator, stored as a vector */
+  std::unique_ptr<Vector<T, size_>> inverse_diagonal;
+public:
+  Workspace() {}
+
+  /* The workspace owns its vectors, so it can not be copied */
+  Workspace(const Workspace&) = delete;
+  Workspace& operator=(const Workspace&) = delete;
+
+  /* Return the scratch vector in the given slot, creating it if needed */
+  Vector<T, size_>& vector(std::size_t slot) {
+    while(vectors.size() <= slot) {
+      vectors.emplace_back(new Vector<T, size_>(0.0));
+    }
+
+    return *vectors[slot];
+  }
+
+  /* Create the first count scratch vectors up front */
+  void reserve(std::size_t count) {
+    if(count > 0) {
+      vector(count - 1);
+    }
+  }
+
+  /* Return the inverse diagonal of A as a vector. It is extracted on every
+     call, operators rebuilt or changed in place at the same address would
+     otherwise get the diagonal of the old entries; the vector stays valid
+     until the next call */
+  template<class MatrixImpl>
+  const Vector<T, size_>& inverseDiagonal(const MatrixLike<T, MatrixImpl, size_, size_>& A) {
+    if(inverse_diagonal == nullptr) {
+      inverse_diagonal.reset(new Vector<T, size_>(1.0));
+    }
+
+    A.inverseDiagonalEntries(*inverse_diagonal);
+    return *inverse_diagonal;
+  }
+};
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Stencil.h"
+#include "Jacobi.h"
+#include "TestProblems.h"
+
+using std::size_t;
+
+// count every request to the global heap, so steady-state loops can be checked
+// for hidden allocations
+static size_t numHeapAllocations = 0;
+
+void* operator new(size_t size) {
+	++numHeapAllocations;
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+	std::free(p);
+}
+
+class TestCase {
+public:
+	TestCase(std::string name) :
+			name_(name) {
+		std::cout << "Test Case START:\t" << name_ << std::endl;
+	}
+	~TestCase() {
+		std::cout << "Test Case END:  \t" << name_ << std::endl;
+	}
+private:
+	std::string name_;
+};
+#define TESTCASE(name) TestCase _testcase(name)
+
+// solves twice with the same workspace, the second solve must not touch the heap
+template<typename T, class MatrixImpl, size_t numPoints>
+void checkSteadyState(const MatrixLike<T, MatrixImpl, numPoints, numPoints>& A, unsigned int expectedNumIts) {
+	Workspace<T, numPoints> workspace;
+	const Vector<T, numPoints> b = rhs<numPoints>();
+	Vector<T, numPoints> u(0.0);
+
+	unsigned int numIts = jacobi(A, b, u, workspace);
+	assert("iteration count matches the reference solver" && numIts == expectedNumIts);
+
+	u = Vector<T, numPoints>(0.0);
+	size_t heapBefore = numHeapAllocations;
+	numIts = jacobi(A, b, u, workspace);
+	assert("no heap allocations once the workspace is set up" && numHeapAllocations == heapBefore);
+	assert("iteration count is unaffected by reuse" && numIts == expectedNumIts);
+}
+
+template<size_t numPoints>
+void test_matrix(unsigned int expectedNumIts) {
+	TESTCASE("test_matrix");
+	const double hxSq = 1. / ((numPoints - 1) * (numPoints - 1));
+	Matrix<double, numPoints, numPoints> A(0.);
+	A(0, 0) = 1.;
+	for (size_t x = 1; x < numPoints - 1; ++x) {
+		A(x, x - 1) = 1. / hxSq;
+		A(x, x) = -2. / hxSq;
+		A(x, x + 1) = 1. / hxSq;
+	}
+	A(numPoints - 1, numPoints - 1) = 1.;
+	checkSteadyState(A, expectedNumIts);
+}
+
+template<size_t numPoints>
+void test_stencil(unsigned int expectedNumIts) {
+	TESTCASE("test_stencil");
+	const double hxSq = 1. / ((numPoints - 1) * (numPoints - 1));
+	Stencil<double, numPoints, numPoints> A({ { 0, 1. } }, { { -1, 1. / hxSq },{ 0, -2. / hxSq },{ 1, 1. / hxSq } });
+	checkSteadyState(A, expectedNumIts);
+}
+
+void test_cache() {
+	TESTCASE("test_cache");
+	Workspace<double, 4> workspace;
+	Matrix<double, 4, 4> A(0.);
+	for (size_t i = 0; i < 4; ++i) {
+		A(i, i) = i + 1.;
+	}
+	assert("inverse diagonal is extracted" && workspace.inverseDiagonal(A)(3) == 0.25);
+	const Vector<double, 4>* diagonal = &workspace.inverseDiagonal(A);
+	A(3, 3) = 2.;
+	assert("entries changed in place are seen" && workspace.inverseDiagonal(A)(3) == 0.5);
+	Matrix<double, 4, 4> B(0.);
+	for (size_t i = 0; i < 4; ++i) {
+		B(i, i) = 4.;
+	}
+	assert("storage is reused" && &workspace.inverseDiagonal(B) == diagonal && (*diagonal)(3) == 0.25);
+	assert("slots are stable" && &workspace.vector(0) == &workspace.vector(0));
+}
+
+int main() {
+	test_matrix<33>(743);
+	test_stencil<33>(743);
+	test_stencil<49>(1676);
+	test_cache();
+	std::cout << "all tests finished without assertion errors" << std::endl;
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/* Blocked dense factorizations of row-major n x n buffers, used by the
+   factorization classes of both assignments */
+
+/* Number of columns factorized together before the trailing matrix is
+   updated, so that the update works on cache sized panels */
+const std::size_t FACTORIZATION_BLOCK = 64;
+
+/* Columns of the trailing matrix updated together, see factorization_update */
+const std::size_t FACTORIZATION_BLOCK_COLS = 256;
+
+/* Trailing updates smaller than this number of entries are not split among
+   threads, as starting them would cost more than the update itself */
+const std::size_t FACTORIZATION_PARALLEL_MIN = 128 * 128;
+
+/* Run body(begin, end) on the rows [first, last), split into contiguous
+   chunks among the given number of threads */
+template<typename Body>
+void factorization_parallel_rows(std::size_t first, std::size_t last, std::size_t cols, unsigned threads, Body body) {
+  const std::size_t rows = last - first;
+
+  if(threads <= 1 || rows < 2 || rows * cols < FACTORIZATION_PARALLEL_MIN) {
+    body(first, last);
+    return;
+  }
+
+  const std::size_t count = std::min<std::size_t>(threads, rows);
+  std::vector<std::thread> workers;
+  workers.reserve(count - 1);
+
+  /* The calling thread takes the first chunk itself */
+  for(std::size_t t = 1; t < count; ++t) {
+    workers.emplace_back(body, first + rows * t / count, first + rows * (t + 1) / count);
+  }
+
+  body(first, first + rows / count);
+
+  for(std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+/* Trailing update of the n x n row-major buffer lu for the panel of the kb
+   columns starting at k: entry (i, j) of rows [first, last) and columns
+   [k + kb, n) is decreased by sum_p L(i, p) * U(p, j). The columns are
+   blocked, so that the touched part of the kb rows of U stays in cache */
+template<typename T>
+void factorization_update(T *lu, std::size_t n, std::size_t k, std::size_t kb, std::size_t first, std::size_t last) {
+  for(std::size_t jj = k + kb; jj < n; jj += FACTORIZATION_BLOCK_COLS) {
+    const std::size_t j_end = std::min(jj + FACTORIZATION_BLOCK_COLS, n);
+
+    for(std::size_t i = first; i < last; ++i) {
+      T *row = lu + i * n;
+
+      for(std::size_t p = k; p < k + kb; ++p) {
+        const T l = row[p];
+        const T *u_row = lu + p * n;
+
+        for(std::size_t j = jj; j < j_end; ++j) {
+          row[j] -= l * u_row[j];
+        }
+      }
+    }
+  }
+}
+
+/* LU factorization with partial pivoting, P * A = L * U, of the n x n buffer
+   data in place: L (unit diagonal) below and U on and above the diagonal.
+   The factorization is blocked (right-looking): a panel of columns is
+   factorized, the corresponding rows of U are computed, and the trailing
+   matrix is updated, optionally split among threads. Row i of the factors
+   is row pivots[i] of the matrix, and exchanges counts the row exchanges.
+   Returns false, leaving the factors incomplete, if the matrix is singular */
+template<typename T>
+bool factorize_lu(T *data, std::size_t n, std::size_t *pivots, std::size_t& exchanges, unsigned threads) {
+  for(std::size_t i = 0; i < n; ++i) {
+    pivots[i] = i;
+  }
+
+  exchanges = 0;
+
+  for(std::size_t k = 0; k < n; k += FACTORIZATION_BLOCK) {
+    const std::size_t kb = std::min(FACTORIZATION_BLOCK, n - k);
+
+    /* Factorize the panel of columns [k, k + kb), exchanging whole rows */
+    for(std::size_t p = k; p < k + kb; ++p) {
+      std::size_t pivot = p;
+
+      for(std::size_t i = p + 1; i < n; ++i) {
+        if(std::abs(data[i * n + p]) > std::abs(data[pivot * n + p])) {
+          pivot = i;
+        }
+      }
+
+      if(data[pivot * n + p] == 0.0 || !std::isfinite(data[pivot * n + p])) {
+        return false;
+      }
+
+      if(pivot != p) {
+        std::swap_ranges(data + p * n, data + (p + 1) * n, data + pivot * n);
+        std::swap(pivots[p], pivots[pivot]);
+        ++exchanges;
+      }
+
+      /* Eliminate below the pivot, within the panel only */
+      for(std::size_t i = p + 1; i < n; ++i) {
+        const T factor = (data[i * n + p] /= data[p * n + p]);
+
+        for(std::size_t j = p + 1; j < k + kb; ++j) {
+          data[i * n + j] -= factor * data[p * n + j];
+        }
+      }
+    }
+
+    /* Rows of U right of the panel, U12 = L11^-1 * A12 */
+    for(std::size_t p = k; p < k + kb; ++p) {
+      for(std::size_t q = k; q < p; ++q) {
+        const T factor = data[p * n + q];
+
+        for(std::size_t j = k + kb; j < n; ++j) {
+          data[p * n + j] -= factor * data[q * n + j];
+        }
+      }
+    }
+
+    /* A22 -= L21 * U12 */
+    factorization_parallel_rows(k + kb, n, n - k - kb, threads, [data, n, k, kb] (std::size_t first, std::size_t last) {
+      factorization_update(data, n, k, kb, first, last);
+    });
+  }
+
+  return true;
+}
+
+/* Cholesky factorization A = L * L^T of the symmetric positive definite
+   n x n buffer data in place, of which only the lower triangle is read and
+   overwritten with L. Blocked like factorize_lu, at half of its cost and
+   without pivoting. Returns false, leaving the factor incomplete, if the
+   matrix is not positive definite */
+template<typename T>
+bool factorize_cholesky(T *data, std::size_t n, unsigned threads) {
+  for(std::size_t k = 0; k < n; k += FACTORIZATION_BLOCK) {
+    const std::size_t kb = std::min(FACTORIZATION_BLOCK, n - k);
+
+    /* Factorize the diagonal block and the panel below it column by column */
+    for(std::size_t p = k; p < k + kb; ++p) {
+      T diagonal = data[p * n + p];
+
+      for(std::size_t q = k; q < p; ++q) {
+        diagonal -= data[p * n + q] * data[p * n + q];
+      }
+
+      if(!(diagonal > 0.0) || !std::isfinite(diagonal)) {
+        return false;
+      }
+
+      diagonal = std::sqrt(diagonal);
+      data[p * n + p] = diagonal;
+
+      for(std::size_t i = p + 1; i < n; ++i) {
+        T sum = data[i * n + p];
+
+        for(std::size_t q = k; q < p; ++q) {
+          sum -= data[i * n + q] * data[p * n + q];
+        }
+
+        data[i * n + p] = sum / diagonal;
+      }
+    }
+
+    /* A22 -= L21 * L21^T, on and below the diagonal */
+    factorization_parallel_rows(k + kb, n, (n - k - kb) / 2, threads, [data, n, k, kb] (std::size_t first, std::size_t last) {
+      for(std::size_t i = first; i < last; ++i) {
+        T *row = data + i * n;
+
+        for(std::size_t j = k + kb; j <= i; ++j) {
+          const T *other = data + j * n;
+          T sum = 0.0;
+
+          for(std::size_t p = k; p < k + kb; ++p) {
+            sum += row[p] * other[p];
+          }
+
+          row[j] -= sum;
+        }
+      }
+    });
+  }
+
+  return true;
+}
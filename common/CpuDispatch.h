@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+/* Runtime selection of the instruction set the hot kernels of both
+   assignments run with */
+
+/* Instruction set levels the hot kernels are built for. Every kernel is
+   compiled once per level from the same source, and the best level supported
+   by the CPU is picked on first use, so binaries built for the baseline ISA
+   still use wide vector units where they are available */
+enum class IsaLevel {
+  SSE2, AVX2, AVX512
+};
+
+/* Per-level builds only exist on x86, elsewhere everything runs at the
+   baseline level */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_DISPATCH_X86 1
+#define ISA_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define ISA_TARGET_AVX512 __attribute__((target("avx512f,avx512vl,avx2,fma,prefer-vector-width=512")))
+#else
+#define CPU_DISPATCH_X86 0
+#define ISA_TARGET_AVX2
+#define ISA_TARGET_AVX512
+#endif
+
+/* Kernel bodies are force inlined into the per-level wrappers, so they are
+   compiled with the instruction set of each wrapper */
+#if defined(__GNUC__)
+#define ISA_KERNEL __attribute__((always_inline)) inline
+#else
+#define ISA_KERNEL inline
+#endif
+
+/* Return the name of an instruction set level */
+inline const char *isa_name(IsaLevel level) {
+  switch(level) {
+    case IsaLevel::SSE2:
+      return "sse2";
+    case IsaLevel::AVX2:
+      return "avx2";
+    case IsaLevel::AVX512:
+      return "avx512";
+    default:
+      return "unknown";
+  }
+}
+
+/* Return the number of doubles in a vector register of the level */
+inline std::size_t isa_vector_doubles(IsaLevel level) {
+  switch(level) {
+    case IsaLevel::AVX512:
+      return 8;
+    case IsaLevel::AVX2:
+      return 4;
+    default:
+      return 2;
+  }
+}
+
+/* Return the best instruction set level supported by the CPU */
+inline IsaLevel detect_isa_level() {
+#if CPU_DISPATCH_X86
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")) {
+    return IsaLevel::AVX512;
+  }
+
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return IsaLevel::AVX2;
+  }
+#endif
+
+  return IsaLevel::SSE2;
+}
+
+/* Return the level selected by the name in ADVPT_ISA ("sse2", "avx2" or
+   "avx512"), or the detected level if it is not set or not recognized.
+   Levels above the detected one are lowered to it, as their instructions
+   would fault */
+inline IsaLevel select_isa_level(const char *name, IsaLevel detected) {
+  if(name == nullptr) {
+    return detected;
+  }
+
+  for(IsaLevel level : { IsaLevel::SSE2, IsaLevel::AVX2, IsaLevel::AVX512 }) {
+    if(std::strcmp(name, isa_name(level)) == 0) {
+      return (level < detected) ? level : detected;
+    }
+  }
+
+  return detected;
+}
+
+/* Return the level the kernels run at, determined once per process */
+inline IsaLevel isa_level() {
+  static const IsaLevel level = select_isa_level(std::getenv("ADVPT_ISA"), detect_isa_level());
+  return level;
+}
+
+/* Call the build of a kernel for the given level, which the CPU must
+   support, with the arguments and return its result. The builds are the
+   per-level wrappers of one kernel body, in the order of the levels */
+template<class Sse2, class Avx2, class Avx512, class... Args>
+auto isa_dispatch(IsaLevel level, Sse2 sse2, Avx2 avx2, Avx512 avx512, Args&&... args)
+  -> decltype(sse2(std::forward<Args>(args)...)) {
+
+  switch(level) {
+    case IsaLevel::AVX512:
+      return avx512(std::forward<Args>(args)...);
+    case IsaLevel::AVX2:
+      return avx2(std::forward<Args>(args)...);
+    default:
+      return sse2(std::forward<Args>(args)...);
+  }
+}